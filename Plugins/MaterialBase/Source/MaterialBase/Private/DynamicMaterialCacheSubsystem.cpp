@@ -0,0 +1,256 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DynamicMaterialCacheSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+DEFINE_STAT(STAT_LiveDynamicMaterials);
+DEFINE_STAT(STAT_PooledDynamicMaterials);
+
+DEFINE_LOG_CATEGORY_STATIC(LogDynamicMaterialCache, Log, All);
+
+static FAutoConsoleCommandWithWorld GDynamicMaterialCacheStatsCommand(
+	TEXT("MaterialBase.MIDCache.Stats"),
+	TEXT("Log how many dynamic material instances are live and pooled, and how often they're reused."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (!World) return;
+		const UDynamicMaterialCacheSubsystem* Cache = World->GetSubsystem<UDynamicMaterialCacheSubsystem>();
+		if (!Cache) return;
+
+		const FDynamicMaterialCacheStats Stats = Cache->GetStats();
+		UE_LOG(LogDynamicMaterialCache, Display, TEXT("Dynamic material instances: %d live, %d pooled"),
+		       Stats.NumLive, Stats.NumPooled);
+		UE_LOG(LogDynamicMaterialCache, Display,
+		       TEXT("  %d acquires: %d shared, %d from the pool, %d created (%.1f%% reused), %d parameter writes"),
+		       Stats.NumAcquires, Stats.NumShared, Stats.NumFromPool, Stats.NumCreated, Stats.GetReuseRate() * 100.f,
+		       Stats.NumWrites);
+	}));
+
+uint32 FDynamicMaterialParams::GetSignature() const
+{
+	// Summed, so the order of the maps doesn't matter.
+	uint32 Signature = 0;
+	for (const TPair<FName, float>& Scalar : Scalars)
+	{
+		Signature += HashCombine(GetTypeHash(Scalar.Key), GetTypeHash(Scalar.Value));
+	}
+	for (const TPair<FName, FLinearColor>& Vector : Vectors)
+	{
+		Signature += HashCombine(GetTypeHash(Vector.Key), GetTypeHash(Vector.Value)) * 31u;
+	}
+	return Signature;
+}
+
+UMaterialInstanceDynamic* UDynamicMaterialCacheSubsystem::Acquire(UMaterialInterface* Parent,
+                                                                  const FDynamicMaterialParams& Params)
+{
+	if (!Parent) return nullptr;
+
+	EAcquireSource Source;
+	const uint32   Key        = HashCombine(GetTypeHash(Parent), Params.GetSignature());
+	const int32    EntryIndex = AcquireEntry(Parent, Params, Key, Source);
+	if (EntryIndex == INDEX_NONE) return nullptr;
+
+	++Stats.NumAcquires;
+	switch (Source)
+	{
+	case EAcquireSource::Shared: ++Stats.NumShared;
+		break;
+	case EAcquireSource::Pool: ++Stats.NumFromPool;
+		break;
+	case EAcquireSource::Created: ++Stats.NumCreated;
+		break;
+	}
+	return Entries[EntryIndex].Instance;
+}
+
+UMaterialInstanceDynamic* UDynamicMaterialCacheSubsystem::Update(UMaterialInstanceDynamic* Instance,
+                                                                 const FDynamicMaterialParams& Params)
+{
+	const int32* FoundIndex = Instance ? EntryByInstance.Find(Instance) : nullptr;
+	if (!FoundIndex || Entries[*FoundIndex].RefCount <= 0) return nullptr;
+
+	// Acquire can add entries, so hang on to the index rather than the entry.
+	const int32         EntryIndex = *FoundIndex;
+	UMaterialInterface* Parent     = Entries[EntryIndex].Parent;
+	if (Entries[EntryIndex].Params == Params) return Instance;
+
+	// The only user, and nobody already has these parameters, so it can just be changed.
+	const uint32 Key = HashCombine(GetTypeHash(Parent), Params.GetSignature());
+	if (Entries[EntryIndex].RefCount == 1 && FindShared(Parent, Params, Key) == INDEX_NONE)
+	{
+		LiveByKey.RemoveSingle(Entries[EntryIndex].Key, EntryIndex);
+		SetEntryParams(EntryIndex, Params, Key, false);
+		return Instance;
+	}
+
+	// Acquire first, so the old instance can't go to the pool and straight back out again.
+	EAcquireSource Source;
+	const int32    NewEntryIndex = AcquireEntry(Parent, Params, Key, Source);
+	ReleaseEntry(EntryIndex);
+	return NewEntryIndex != INDEX_NONE ? Entries[NewEntryIndex].Instance.Get() : nullptr;
+}
+
+void UDynamicMaterialCacheSubsystem::Release(UMaterialInstanceDynamic* Instance)
+{
+	if (const int32* EntryIndex = Instance ? EntryByInstance.Find(Instance) : nullptr)
+		ReleaseEntry(*EntryIndex);
+}
+
+void UDynamicMaterialCacheSubsystem::FlushWrites()
+{
+	for (const int32 EntryIndex : PendingWrites)
+	{
+		FDynamicMaterialCacheEntry& Entry = Entries[EntryIndex];
+		if (Entry.bWritePending && Entry.Instance) WriteEntryParams(Entry);
+	}
+	PendingWrites.Reset();
+}
+
+FDynamicMaterialCacheStats UDynamicMaterialCacheSubsystem::GetStats() const
+{
+	return Stats;
+}
+
+void UDynamicMaterialCacheSubsystem::Tick(float DeltaTime)
+{
+	if (PendingWrites.Num() > 0) FlushWrites();
+}
+
+TStatId UDynamicMaterialCacheSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDynamicMaterialCacheSubsystem, STATGROUP_MaterialBase);
+}
+
+void UDynamicMaterialCacheSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_LiveDynamicMaterials, Stats.NumLive);
+	DEC_DWORD_STAT_BY(STAT_PooledDynamicMaterials, Stats.NumPooled);
+
+	Entries.Empty();
+	FreeEntries.Empty();
+	LiveByKey.Empty();
+	PooledByParent.Empty();
+	EntryByInstance.Empty();
+	PendingWrites.Empty();
+	Stats = FDynamicMaterialCacheStats();
+
+	Super::Deinitialize();
+}
+
+int32 UDynamicMaterialCacheSubsystem::AcquireEntry(UMaterialInterface* Parent, const FDynamicMaterialParams& Params,
+                                                   uint32 Key, EAcquireSource& OutSource)
+{
+	// Someone already has one just like it
+	const int32 SharedIndex = FindShared(Parent, Params, Key);
+	if (SharedIndex != INDEX_NONE)
+	{
+		++Entries[SharedIndex].RefCount;
+		OutSource = EAcquireSource::Shared;
+		return SharedIndex;
+	}
+
+	// Otherwise one of the same parent from the pool, with new parameters
+	int32 EntryIndex = INDEX_NONE;
+	if (TArray<int32>* Pooled = PooledByParent.Find(Parent); Pooled && Pooled->Num() > 0)
+	{
+		EntryIndex = Pooled->Pop(false);
+		OutSource  = EAcquireSource::Pool;
+		--Stats.NumPooled;
+		DEC_DWORD_STAT(STAT_PooledDynamicMaterials);
+	}
+	else
+	{
+		UMaterialInstanceDynamic* Instance = UMaterialInstanceDynamic::Create(Parent, this);
+		if (!Instance) return INDEX_NONE;
+
+		EntryIndex = FreeEntries.Num() > 0 ? FreeEntries.Pop(false) : Entries.AddDefaulted();
+		Entries[EntryIndex].Instance = Instance;
+		Entries[EntryIndex].Parent   = Parent;
+		EntryByInstance.Add(Instance, EntryIndex);
+		OutSource = EAcquireSource::Created;
+	}
+
+	Entries[EntryIndex].RefCount = 1;
+	++Stats.NumLive;
+	INC_DWORD_STAT(STAT_LiveDynamicMaterials);
+
+	// Written straight away, a pooled instance would otherwise show its last user's parameters until Tick.
+	SetEntryParams(EntryIndex, Params, Key, true);
+	return EntryIndex;
+}
+
+int32 UDynamicMaterialCacheSubsystem::FindShared(UMaterialInterface* Parent, const FDynamicMaterialParams& Params,
+                                                 uint32 Key) const
+{
+	// Signatures can collide, so check it really is the same.
+	for (auto It = LiveByKey.CreateConstKeyIterator(Key); It; ++It)
+	{
+		const FDynamicMaterialCacheEntry& Entry = Entries[It.Value()];
+		if (Entry.Parent == Parent && Entry.Params == Params) return It.Value();
+	}
+	return INDEX_NONE;
+}
+
+void UDynamicMaterialCacheSubsystem::SetEntryParams(int32 EntryIndex, const FDynamicMaterialParams& Params, uint32 Key,
+                                                    bool bWriteNow)
+{
+	FDynamicMaterialCacheEntry& Entry = Entries[EntryIndex];
+	Entry.Params = Params;
+	Entry.Key    = Key;
+	LiveByKey.Add(Key, EntryIndex);
+
+	if (bWriteNow)
+	{
+		// Any queued write is for older parameters, FlushWrites skips it once bWritePending is clear.
+		WriteEntryParams(Entry);
+	}
+	else if (!Entry.bWritePending)
+	{
+		Entry.bWritePending = true;
+		PendingWrites.Add(EntryIndex);
+	}
+}
+
+void UDynamicMaterialCacheSubsystem::WriteEntryParams(FDynamicMaterialCacheEntry& Entry)
+{
+	// A pooled instance still has whatever its last user set.
+	Entry.Instance->ClearParameterValues();
+	for (const TPair<FName, float>& Scalar : Entry.Params.Scalars)
+	{
+		Entry.Instance->SetScalarParameterValue(Scalar.Key, Scalar.Value);
+	}
+	for (const TPair<FName, FLinearColor>& Vector : Entry.Params.Vectors)
+	{
+		Entry.Instance->SetVectorParameterValue(Vector.Key, Vector.Value);
+	}
+
+	Entry.bWritePending = false;
+	++Stats.NumWrites;
+}
+
+void UDynamicMaterialCacheSubsystem::ReleaseEntry(int32 EntryIndex)
+{
+	FDynamicMaterialCacheEntry& Entry = Entries[EntryIndex];
+	if (Entry.RefCount <= 0 || --Entry.RefCount > 0) return;
+
+	LiveByKey.RemoveSingle(Entry.Key, EntryIndex);
+	--Stats.NumLive;
+	DEC_DWORD_STAT(STAT_LiveDynamicMaterials);
+
+	TArray<int32>& Pooled = PooledByParent.FindOrAdd(Entry.Parent.Get());
+	if (Pooled.Num() < MaxPooledPerParent)
+	{
+		Pooled.Add(EntryIndex);
+		++Stats.NumPooled;
+		INC_DWORD_STAT(STAT_PooledDynamicMaterials);
+		return;
+	}
+
+	// The pool's full, so let the instance go. Any pending write goes with it, FlushWrites skips empty entries.
+	EntryByInstance.Remove(Entry.Instance.Get());
+	Entry = FDynamicMaterialCacheEntry();
+	FreeEntries.Add(EntryIndex);
+}
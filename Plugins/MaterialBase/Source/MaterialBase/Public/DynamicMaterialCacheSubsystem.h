@@ -0,0 +1,190 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DynamicMaterialCacheSubsystem.generated.h"
+
+class UMaterialInstanceDynamic;
+class UMaterialInterface;
+
+DECLARE_STATS_GROUP(TEXT("MaterialBase"), STATGROUP_MaterialBase, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Live MIDs"), STAT_LiveDynamicMaterials, STATGROUP_MaterialBase,
+                                  MATERIALBASE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pooled MIDs"), STAT_PooledDynamicMaterials, STATGROUP_MaterialBase,
+                                  MATERIALBASE_API);
+
+/** The parameter values a dynamic material instance is created with. */
+USTRUCT(BlueprintType)
+struct MATERIALBASE_API FDynamicMaterialParams
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Material")
+	TMap<FName, float> Scalars;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Material")
+	TMap<FName, FLinearColor> Vectors;
+
+	/** The same for equal parameters, whatever order they were added in. */
+	uint32 GetSignature() const;
+
+	bool operator==(const FDynamicMaterialParams& Other) const
+	{
+		return Scalars.OrderIndependentCompareEqual(Other.Scalars) &&
+			Vectors.OrderIndependentCompareEqual(Other.Vectors);
+	}
+};
+
+/** How well the cache is doing, since the world started. */
+USTRUCT(BlueprintType)
+struct MATERIALBASE_API FDynamicMaterialCacheStats
+{
+	GENERATED_BODY()
+
+	/** Instances in use by someone. */
+	UPROPERTY(BlueprintReadOnly, Category="Material")
+	int32 NumLive = 0;
+
+	/** Instances waiting in the pool to be reused. */
+	UPROPERTY(BlueprintReadOnly, Category="Material")
+	int32 NumPooled = 0;
+
+	/** Calls to Acquire. Update moving someone to another instance doesn't count, nor do the stats below. */
+	UPROPERTY(BlueprintReadOnly, Category="Material")
+	int32 NumAcquires = 0;
+
+	/** Acquires given an instance someone else was already using, with the same parameters. */
+	UPROPERTY(BlueprintReadOnly, Category="Material")
+	int32 NumShared = 0;
+
+	/** Acquires given an instance from the pool. */
+	UPROPERTY(BlueprintReadOnly, Category="Material")
+	int32 NumFromPool = 0;
+
+	/** Acquires which had to create a new instance. */
+	UPROPERTY(BlueprintReadOnly, Category="Material")
+	int32 NumCreated = 0;
+
+	/** Parameter writes made, each being a whole set of parameters on one instance. */
+	UPROPERTY(BlueprintReadOnly, Category="Material")
+	int32 NumWrites = 0;
+
+	/** Fraction of acquires which didn't create a new instance. */
+	float GetReuseRate() const { return NumAcquires > 0 ? 1.f - static_cast<float>(NumCreated) / NumAcquires : 0.f; }
+};
+
+/** One cached instance, and who it belongs to. */
+USTRUCT()
+struct FDynamicMaterialCacheEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UMaterialInstanceDynamic> Instance = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UMaterialInterface> Parent = nullptr;
+
+	FDynamicMaterialParams Params;
+
+	/** HashCombine of the parent and the parameters' signature. */
+	uint32 Key = 0;
+
+	/** Everyone using the instance. 0 means it's in the pool. */
+	int32 RefCount = 0;
+
+	/** The parameters have changed since they were last written to the instance. */
+	bool bWritePending = false;
+};
+
+/**
+ * Hands out dynamic material instances for effects like tinting a character, so they don't each make their own.
+ *
+ * Instances are keyed by their parent material and parameters, and anyone asking for the same pair gets the same
+ * instance. Released instances go back into a pool per parent, and are reused the next time that parent is asked
+ * for, whatever the parameters. An instance handed out by Acquire already has its parameters. Parameter changes
+ * from Update are queued, and made once a frame in Tick (or FlushWrites), so changing an effect several times
+ * in a frame only writes the last values.
+ *
+ * A shared instance is never changed under anyone else, Update moves the caller to another instance instead,
+ * which is why it returns the instance to use from then on.
+ */
+UCLASS()
+class MATERIALBASE_API UDynamicMaterialCacheSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Released instances kept per parent. Any more are let go. */
+	static constexpr int32 MaxPooledPerParent = 32;
+
+	/** An instance of Parent with Params, shared with anyone else who asked for the same. Release it when done. */
+	UFUNCTION(BlueprintCallable, Category="Material")
+	UMaterialInstanceDynamic* Acquire(UMaterialInterface* Parent, const FDynamicMaterialParams& Params);
+
+	/** Change the parameters of an acquired instance. Returns the instance to use from now on. */
+	UFUNCTION(BlueprintCallable, Category="Material")
+	UMaterialInstanceDynamic* Update(UMaterialInstanceDynamic* Instance, const FDynamicMaterialParams& Params);
+
+	/** Give back an instance from Acquire or Update. */
+	UFUNCTION(BlueprintCallable, Category="Material")
+	void Release(UMaterialInstanceDynamic* Instance);
+
+	/** Make any queued parameter writes now, rather than waiting for Tick. */
+	void FlushWrites();
+
+	UFUNCTION(BlueprintPure, Category="Material")
+	FDynamicMaterialCacheStats GetStats() const;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual void Deinitialize() override;
+
+private:
+	/** Where AcquireEntry got its instance from. */
+	enum class EAcquireSource : uint8
+	{
+		Shared,
+		Pool,
+		Created
+	};
+
+	/** Acquire, without counting it in the stats, so Update can use it too. INDEX_NONE if it failed. */
+	int32 AcquireEntry(UMaterialInterface* Parent, const FDynamicMaterialParams& Params, uint32 Key,
+	                   EAcquireSource& OutSource);
+
+	/** The live entry of Parent with Params, or INDEX_NONE. */
+	int32 FindShared(UMaterialInterface* Parent, const FDynamicMaterialParams& Params, uint32 Key) const;
+
+	/** Point an entry at a new set of parameters, and write them now, or queue the write for FlushWrites. */
+	void SetEntryParams(int32 EntryIndex, const FDynamicMaterialParams& Params, uint32 Key, bool bWriteNow);
+
+	/** Replace whatever parameters the instance has with the entry's. */
+	void WriteEntryParams(FDynamicMaterialCacheEntry& Entry);
+
+	/** Drop a reference, pooling the instance if that was the last one. */
+	void ReleaseEntry(int32 EntryIndex);
+
+	UPROPERTY()
+	TArray<FDynamicMaterialCacheEntry> Entries;
+
+	/** Entries without an instance, to be reused. */
+	TArray<int32> FreeEntries;
+
+	/** Live entries, by Key. */
+	TMultiMap<uint32, int32> LiveByKey;
+
+	/** Pooled entries, by parent. */
+	TMap<TObjectKey<UMaterialInterface>, TArray<int32>> PooledByParent;
+
+	TMap<TObjectKey<UMaterialInstanceDynamic>, int32> EntryByInstance;
+
+	/** Entries with bWritePending set. */
+	TArray<int32> PendingWrites;
+
+	FDynamicMaterialCacheStats Stats;
+};
@@ -11,5 +11,6 @@ public class BuildingBlocksTarget : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V2;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_1;
 		ExtraModuleNames.Add("BuildingBlocks");
+		ExtraModuleNames.Add("BuildingBlocksUI");
 	}
 }
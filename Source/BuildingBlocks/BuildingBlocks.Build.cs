@@ -14,13 +14,14 @@ public class BuildingBlocks : ModuleRules
 			"CoreUObject",
 			"Engine",
 			"InputCore",
-			"EnhancedInput",
-			"UMG",
-			"Slate",
-			"SlateCore"
+			"EnhancedInput"
 		});
 
-		PrivateDependencyModuleNames.AddRange(new string[] { });
+		PrivateDependencyModuleNames.AddRange(new string[] { "ReplicationGraph" });
+
+		// The gameplay classes live in the module root rather than Public,
+		// make them visible to BuildingBlocksUI.
+		PublicIncludePaths.Add(ModuleDirectory);
 		
 		/*PrivateDefinitions.AddRange(new string[]
 		{
@@ -28,4 +29,4 @@ public class BuildingBlocks : ModuleRules
 		});*/
 		
 	}
-}
\ No newline at end of file
+}
@@ -2,8 +2,31 @@
 
 #include "BuildingBlocks.h"
 #include "CustomLogging.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/CoreDelegates.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, BuildingBlocks, "BuildingBlocks" );
+// The primary game module. The only thing it does beyond the default
+// is log how long startup took and how much memory it used, so client
+// and dedicated server builds can be compared.
+class FBuildingBlocksModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		FCoreDelegates::OnFEngineLoopInitComplete.AddLambda([]()
+		{
+			const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+			BBLOG(Display, "Startup complete in {0}s, resident memory {1} MB (peak {2} MB), UI module {3}",
+			      FPlatformTime::Seconds() - GStartTime,
+			      MemoryStats.UsedPhysical / (1024 * 1024),
+			      MemoryStats.PeakUsedPhysical / (1024 * 1024),
+			      FModuleManager::Get().IsModuleLoaded(TEXT("BuildingBlocksUI")) ? TEXT("loaded") : TEXT("not loaded"));
+		});
+	}
+};
 
-DEFINE_LOG_CATEGORY(BBLog);
\ No newline at end of file
+IMPLEMENT_PRIMARY_GAME_MODULE( FBuildingBlocksModule, BuildingBlocks, "BuildingBlocks" );
+
+DEFINE_LOG_CATEGORY(BBLog);
@@ -2,31 +2,98 @@
 
 
 #include "CharacterBB.h"
+#include "CharacterRegistrySubsystemBB.h"
+#include "KeyLockIndexSubsystemBB.h"
+#include "MemoryTagsBB.h"
+#include "ProfilingStatsBB.h"
+#include "StatLatencyBB.h"
+#include "StatRegenCurvesBB.h"
+#include "TimedEffectSubsystemBB.h"
 
 #include "GameFramework/CharacterMovementComponent.h"
+#include "Net/UnrealNetwork.h"
 
 // Sets default values
 ACharacterBB::ACharacterBB()
 {
 	PrimaryActorTick.bCanEverTick = true;
-	SetActorTickInterval(0.5f);
+	SetActorTickInterval(FStatRulesBB::UpdateInterval);
 	AActor::SetActorTickEnabled(true);
 }
 
 // Called when the game starts or when spawned
 void ACharacterBB::BeginPlay()
 {
+	LLM_SCOPE_BYTAG(BuildingBlocks_Character);
+
 	Super::BeginPlay();
 	if (GetMovementComponent()) GetMovementComponent()->GetNavAgentPropertiesRef().bCanCrouch = true;
 
+	if (RollbackFrames > 0) Snapshots.Init(RollbackFrames);
+
+	StatSnapshots = GetWorld()->GetSubsystem<UStatSnapshotSubsystemBB>();
+	SetPublishingStats(true);
+
+	if (UCharacterRegistrySubsystemBB* CharacterRegistry = GetWorld()->GetSubsystem<UCharacterRegistrySubsystemBB>())
+		CharacterRegistry->RegisterCharacter(this);
+
 	BroadcastCurrentStats();
 }
 
+void ACharacterBB::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	SetPublishingStats(false);
+	FStatLatencyTrackerBB::Get().RemoveOwner(this);
+
+	if (UCharacterRegistrySubsystemBB* CharacterRegistry = GetWorld()->GetSubsystem<UCharacterRegistrySubsystemBB>())
+		CharacterRegistry->UnregisterCharacter(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACharacterBB::SetPublishingStats(bool bPublish)
+{
+	UStatSnapshotSubsystemBB* Subsystem = StatSnapshots.Get();
+	if (!Subsystem || bPublish == StatSlot.IsValid()) return;
+
+	if (bPublish)
+	{
+		StatSlot = Subsystem->AddSlot();
+		PublishStats();
+	}
+	else
+	{
+		Subsystem->RemoveSlot(StatSlot);
+		StatSlot = FStatSlotBB();
+	}
+}
+
+void ACharacterBB::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// The owner gets the exact values, and their keys, which nobody else needs to know about.
+	DOREPLIFETIME_CONDITION(ACharacterBB, SimState, COND_OwnerOnly);
+	DOREPLIFETIME_CONDITION(ACharacterBB, ReplicatedKeys, COND_OwnerOnly);
+
+	// Everyone else gets the summary.
+	DOREPLIFETIME_CONDITION(ACharacterBB, StatSummary, COND_SkipOwner);
+}
+
+void ACharacterBB::OnJumped_Implementation()
+{
+	Super::OnJumped_Implementation();
+
+	// Jump() only runs on the machine which pressed the button,
+	// this is how the server finds out a remote player jumped.
+	SimState.bHasJumped = true;
+}
+
 void ACharacterBB::AddMovementInput(FVector WorldDirection, float ScaleValue, bool bForce)
 {
 	// If the player is running, check that they have stamina available,
 	// otherwise kick them out of running mode
-	if (bIsRunning && CurrentStamina <= 0)
+	if (SimState.bIsRunning && !FStatRulesBB::CanRun(SimState))
 	{
 		SetRunning(false);
 	}
@@ -34,17 +101,18 @@ void ACharacterBB::AddMovementInput(FVector WorldDirection, float ScaleValue, bo
 	Super::AddMovementInput(WorldDirection, ScaleValue, bForce);
 
 	// set the flag to indicate if the character ran.
-	if (bIsRunning) bHasRan = true;
+	if (SimState.bIsRunning) SimState.bHasRan = true;
 }
 
 void ACharacterBB::Jump()
 {
 	// Jump requires stamina
-	if (CurrentStamina - JumpStaminaCost >= 0.f)
+	if (FStatRulesBB::CanJump(SimState, StatTuning))
 	{
 		UnCrouch();
 		Super::Jump();
-		bHasJumped = true;
+		SimState.bHasJumped = true;
+		FStatLatencyTrackerBB::Get().TagStat(this, EStatTypeBB::Stamina);
 	}
 }
 
@@ -52,6 +120,7 @@ void ACharacterBB::Crouch(bool bClientSimulation)
 {
 	SetRunning(false);
 	Super::Crouch(bClientSimulation);
+	FStatLatencyTrackerBB::Get().TagStat(this, EStatTypeBB::Stamina);
 }
 
 void ACharacterBB::Tick(float DeltaTime)
@@ -59,76 +128,84 @@ void ACharacterBB::Tick(float DeltaTime)
 	// Call the super... it probably needs to do stuff!
 	Super::Tick(DeltaTime);
 
-	// There are 2 things which can restore over time, these are:
-	// - Stamina
-	// - Psi Power
-
-#pragma region Update Stamina
-	// How has stamina been affected?
-	// We move from the worst-case scenario to the best.
-	// if they jumped, otherwise if they ran, otherwise if they rested.
-	// and if they did none of those they get the default recharge rate.
-
-	float ActualStaminaRecuperationFactor = StaminaRecuperationFactor;
-
-	if (bHasJumped) ActualStaminaRecuperationFactor = -JumpStaminaCost;
-		// If the sprinted then they get a deduction
-	else if (bHasRan) ActualStaminaRecuperationFactor = -RunStaminaCost;
-		// Player gets double stamina regain when crouched.
-	else if (bIsCrouched) ActualStaminaRecuperationFactor = RestStaminaRebate;
-
-	// Keep track of the value before it is changed.
-	const float PreviousStamina = CurrentStamina;
-
-	// Update the current value, capping it to the min and max allowable
-	CurrentStamina = FMath::Clamp(CurrentStamina + ActualStaminaRecuperationFactor, 0.f, MaxStamina);
-
-	// If the value has actually changed, we need to notify any listeners
-	if (CurrentStamina != PreviousStamina)
+	// Stats belong to the server, clients hear about changes through the OnReps.
+	if (!HasAuthority())
 	{
-		OnStaminaChanged.Broadcast(PreviousStamina, CurrentStamina, MaxStamina);
+		PublishStats();
+		return;
 	}
 
-	// Reset the flags indicating physical exertion
-	bHasRan    = false;
-	bHasJumped = false;
+	SCOPE_CYCLE_COUNTER(STAT_CharacterStatsBB);
+	const FStatCostScopeBB CostScope;
 
-#pragma endregion
+	// The server never sees AddMovementInput for remote players, so guess from how fast they are going.
+	if (SimState.bIsRunning && !IsLocallyControlled() && GetVelocity().SizeSquared2D() > FMath::Square(NormalMaxWalkSpeed))
+		SimState.bHasRan = true;
 
-#pragma region Update Psi Power
-	// This is a bit simpler than stamina, because nothing here needs to deduct from the current value,
-	// only restore it, and at a constant rate.
+	SimState.bIsCrouched = bIsCrouched;
+	SimulateStats(DeltaTime);
 
-	if (CurrentPsiPower != MaxPsiPower)
-	{
-		// Keep track of the value before it is changed.
-		const float PreviousPsiPower = CurrentPsiPower;
-
-		CurrentPsiPower = FMath::Clamp(CurrentPsiPower + PsiRechargeRate, 0, MaxPsiPower);
-		OnPsiPowerChanged.Broadcast(PreviousPsiPower, CurrentPsiPower, MaxPsiPower);
-	}
-
-#pragma endregion
+	// At most a tick late, which nobody looking at someone else's stats will notice.
+	UpdateStatSummary();
+	PublishStats();
 
 	// Temporarily display debug information
 	/*
 		GEngine->AddOnScreenDebugMessage(-1, 0.49f, FColor::Silver,
 		                                 *(FString::Printf(
-			                                 TEXT("Movement - IsCrouched:%d | IsSprinting:%d"), bIsCrouched, bIsRunning)));
+			                                 TEXT("Movement - IsCrouched:%d | IsSprinting:%d"), bIsCrouched, SimState.bIsRunning)));
 		GEngine->AddOnScreenDebugMessage(-1, 0.49f, FColor::Red,
 		                                 *(FString::Printf(
-			                                 TEXT("Health - Current:%d | Maximum:%d"), CurrentHealth, MaxHealth)));
+			                                 TEXT("Health - Current:%d | Maximum:%d"), SimState.CurrentHealth, SimState.MaxHealth)));
 		GEngine->AddOnScreenDebugMessage(-1, 0.49f, FColor::Green,
 		                                 *(FString::Printf(
-			                                 TEXT("Stamina - Current:%f | Maximum:%f"), CurrentStamina, MaxStamina)));
+			                                 TEXT("Stamina - Current:%f | Maximum:%f"), SimState.CurrentStamina, StatTuning.MaxStamina)));
 		GEngine->AddOnScreenDebugMessage(-1, 0.49f, FColor::Cyan,
 		                                 *(FString::Printf(
-			                                 TEXT("PsiPower - Current:%f | Maximum:%f"), CurrentPsiPower, MaxPsiPower)));
+			                                 TEXT("PsiPower - Current:%f | Maximum:%f"), SimState.CurrentPsiPower, StatTuning.MaxPsiPower)));
 		GEngine->AddOnScreenDebugMessage(-1, 0.49f, FColor::Orange,
-		                                 *(FString::Printf(TEXT("Keys - %d Keys Currently held"), KeyWallet.Num())));
+		                                 *(FString::Printf(TEXT("Keys - %d Keys Currently held"), SimState.Keys.Num())));
 	*/
 }
 
+void ACharacterBB::SimulateStats(float DeltaTime)
+{
+	// Stamina and psi power restore over time, health only goes down with damage over time.
+	// The rules are shared with the balance commandlet, see FStatRulesBB.
+
+	// Baked when the curves were loaded, so this is just a lookup per stat.
+	FStatModifiersBB Modifiers;
+	Modifiers.StaminaRegenBonus = StaminaRegenBonus;
+	Modifiers.DamagePerSecond   = DamagePerSecond;
+	Modifiers.PsiDrainPerSecond = PsiDrainPerSecond;
+	Modifiers.StaminaRegenTable = RegenCurves ? &RegenCurves->GetStaminaTable() : nullptr;
+	Modifiers.PsiRegenTable     = RegenCurves ? &RegenCurves->GetPsiTable() : nullptr;
+
+	// Keep track of the values before they are changed.
+	const float PreviousStamina  = SimState.CurrentStamina;
+	const float PreviousPsiPower = SimState.CurrentPsiPower;
+
+	const int32 DamageDue = FStatRulesBB::Step(SimState, StatTuning, Modifiers, DeltaTime);
+
+	// If the values have actually changed, we need to notify any listeners
+	if (SimState.CurrentStamina != PreviousStamina && !bIsResimulating)
+	{
+		const FStatBroadcastScopeBB BroadcastScope(this, EStatTypeBB::Stamina);
+		OnStaminaChanged.Broadcast(PreviousStamina, SimState.CurrentStamina, StatTuning.MaxStamina);
+	}
+
+	if (SimState.CurrentPsiPower != PreviousPsiPower && !bIsResimulating)
+	{
+		const FStatBroadcastScopeBB BroadcastScope(this, EStatTypeBB::PsiPower);
+		OnPsiPowerChanged.Broadcast(PreviousPsiPower, SimState.CurrentPsiPower, StatTuning.MaxPsiPower);
+	}
+
+	if (DamageDue > 0) UpdateHealth(-DamageDue);
+
+	// Any input which didn't change a stat this update isn't going to, so don't let a later change claim it.
+	if (!bIsResimulating) FStatLatencyTrackerBB::Get().EndStatUpdate(this);
+}
+
 void ACharacterBB::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
@@ -137,38 +214,61 @@ void ACharacterBB::SetupPlayerInputComponent(UInputComponent* PlayerInputCompone
 void ACharacterBB::SetRunning(bool IsRunning)
 {
 	// Set the value
-	bIsRunning = IsRunning;
+	SimState.bIsRunning = IsRunning;
+
+	// The server needs to know too, both for the speed and the stamina cost.
+	if (!CanChangeStats()) ServerSetRunning(IsRunning);
 
 	// Set the speed at which the player moves, based on if they are walking or running
-	GetCharacterMovement()->MaxWalkSpeed = bIsRunning ? RunningMaxWalkSpeed : NormalMaxWalkSpeed;
+	GetCharacterMovement()->MaxWalkSpeed = SimState.bIsRunning ? RunningMaxWalkSpeed : NormalMaxWalkSpeed;
+}
+
+void ACharacterBB::ServerSetRunning_Implementation(bool IsRunning)
+{
+	SetRunning(IsRunning);
 }
 
 void ACharacterBB::ToggleRunning()
 {
-	SetRunning(!bIsRunning);
+	SetRunning(!SimState.bIsRunning);
+	FStatLatencyTrackerBB::Get().TagStat(this, EStatTypeBB::Stamina);
 }
 
 void ACharacterBB::SetHasJumped()
 {
-	bHasJumped = true;
+	SimState.bHasJumped = true;
 }
 
 void ACharacterBB::SetHasRan()
 {
-	bHasRan = true;
+	SimState.bHasRan = true;
 }
 
 void ACharacterBB::BroadcastCurrentStats()
 {
-	OnHealthChanged.Broadcast(CurrentHealth, CurrentHealth, MaxHealth);
-	OnStaminaChanged.Broadcast(CurrentStamina, CurrentStamina, MaxStamina);
-	OnPsiPowerChanged.Broadcast(CurrentPsiPower, CurrentPsiPower, MaxPsiPower);
+	FStatLatencyTrackerBB& LatencyTracker = FStatLatencyTrackerBB::Get();
+	LatencyTracker.TagStat(this, EStatTypeBB::Health);
+	LatencyTracker.TagStat(this, EStatTypeBB::Stamina);
+	LatencyTracker.TagStat(this, EStatTypeBB::PsiPower);
+
+	{
+		const FStatBroadcastScopeBB BroadcastScope(this, EStatTypeBB::Health);
+		OnHealthChanged.Broadcast(SimState.CurrentHealth, SimState.CurrentHealth, SimState.MaxHealth);
+	}
+	{
+		const FStatBroadcastScopeBB BroadcastScope(this, EStatTypeBB::Stamina);
+		OnStaminaChanged.Broadcast(SimState.CurrentStamina, SimState.CurrentStamina, StatTuning.MaxStamina);
+	}
+	{
+		const FStatBroadcastScopeBB BroadcastScope(this, EStatTypeBB::PsiPower);
+		OnPsiPowerChanged.Broadcast(SimState.CurrentPsiPower, SimState.CurrentPsiPower, StatTuning.MaxPsiPower);
+	}
 
 	// Make a string of all the keys
 	// If there are ANY members, the string will end with a trailing comma ','
 	// We dont care to remove that here, it doesnt matter.
 	FString AllKeys = FString();
-	for (FString Key : KeyWallet)
+	for (FString Key : GetKeyWallet())
 	{
 		AllKeys.Appendf(TEXT("%s,"),&Key);
 	}
@@ -176,44 +276,101 @@ void ACharacterBB::BroadcastCurrentStats()
 	OnKeyWalletAction.Broadcast(AllKeys, EPlayerKeyAction::CountKeys, true);
 }
 
+void ACharacterBB::ResetStats()
+{
+	if (UWorld* World = GetWorld())
+	{
+		if (UTimedEffectSubsystemBB* TimedEffects = World->GetSubsystem<UTimedEffectSubsystemBB>())
+			TimedEffects->CancelEffectsOn(this);
+	}
+	StaminaRegenBonus = 0.f;
+	DamagePerSecond   = 0.f;
+	PsiDrainPerSecond = 0.f;
+
+	SimState.Keys.ForEach([this](int32 KeyId)
+	{
+		const FString& Key = FKeyRegistryBB::GetName(KeyId);
+		OnKeyWalletAction.Broadcast(Key, EPlayerKeyAction::RemoveKey, true);
+		NotifyKeyLocks(Key, false);
+	});
+	ReplicatedKeys.Reset();
+
+	// The class defaults, so blueprint characters get their own starting values. Nothing to allocate for a fresh key set.
+	SimState = GetClass()->GetDefaultObject<ACharacterBB>()->SimState;
+	Snapshots.Invalidate();
+
+	if (bIsCrouched) UnCrouch();
+	GetCharacterMovement()->MaxWalkSpeed = NormalMaxWalkSpeed;
+
+	UpdateStatSummary();
+	PublishStats();
+	BroadcastCurrentStats();
+}
+
+void ACharacterBB::ClearStatListeners()
+{
+	OnHealthChanged.Clear();
+	OnPlayerDied.Clear();
+	OnStaminaChanged.Clear();
+	OnPsiPowerChanged.Clear();
+	OnKeyWalletAction.Clear();
+}
+
+void ACharacterBB::AddTimedEffectModifier(ETimedEffectTypeBB Type, float Modifier)
+{
+	switch (Type)
+	{
+	case ETimedEffectTypeBB::StaminaRegenMultiplier:
+		StaminaRegenBonus += Modifier;
+		break;
+	case ETimedEffectTypeBB::DamageOverTime:
+		DamagePerSecond += Modifier;
+		// Once the last one wears off, forget any part point left over.
+		if (DamagePerSecond <= KINDA_SMALL_NUMBER) SimState.PendingDamage = 0.f;
+		break;
+	case ETimedEffectTypeBB::PsiDrain:
+		PsiDrainPerSecond += Modifier;
+		break;
+	default: ;
+	}
+}
+
 int ACharacterBB::GetHealth()
 {
-	return CurrentHealth;
+	return SimState.CurrentHealth;
 }
 
 int ACharacterBB::GetMaxHealth()
 {
-	return MaxHealth;
+	return SimState.MaxHealth;
 }
 
 void ACharacterBB::UpdateHealth(int DeltaHealth)
 {
+	// Health is only changed on the server, and replicated from there.
+	if (!CanChangeStats()) return;
+
 	// If the player is already dead, their health cannot be modified again.
 	// This prevents multiple effects 'stacking' and a player becoming dead 
 	// and instantly reviving. DEAD IS DEAD.
-	if (CurrentHealth <= 0.f) return;
+	// (FStatRulesBB::ApplyHealthDelta sees to that)
+	if (SimState.CurrentHealth <= 0.f) return;
 
 	// What is the value, before we change it?
-	int OldValue = CurrentHealth;
-
-	CurrentHealth += DeltaHealth;
+	int OldValue = SimState.CurrentHealth;
 
-	// Make sure that the new CurrentHealth value is inside an acceptable range
-	// In this case it will never be less than -1, or more than the MaxHealth
-	CurrentHealth = FMath::Clamp(CurrentHealth, -1.f, MaxHealth);
-
-	// Compare the value before we changed it with the new value.
-	// We only want to notify listeners if this is different.
-	// Why wouldn't it be? 
+	// The new CurrentHealth will never be less than -1, or more than the MaxHealth.
+	// We only want to notify listeners if it actually changed.
+	// Why wouldn't it? 
 	// Because, the player might drink a healing potion, 
 	// when they are already at full health, etc.
-	if (CurrentHealth != OldValue)
+	if (FStatRulesBB::ApplyHealthDelta(SimState, DeltaHealth) && !bIsResimulating)
 	{
-		OnHealthChanged.Broadcast(OldValue, CurrentHealth, MaxHealth);
+		OnHealthChanged.Broadcast(OldValue, SimState.CurrentHealth, SimState.MaxHealth);
 	}
 
 	// Did the player just die?
-	if (CurrentHealth <= 0.f)
+	if (SimState.CurrentHealth <= 0.f && !bIsResimulating)
 	{
 		// The player is dead! Do something!
 		OnPlayerDied.Broadcast();
@@ -222,108 +379,337 @@ void ACharacterBB::UpdateHealth(int DeltaHealth)
 
 void ACharacterBB::RestoreToFullHealth()
 {
+	if (!CanChangeStats()) return;
+
 	// Only do something if we are not already at max health.
-	if (CurrentHealth < MaxHealth)
+	if (SimState.CurrentHealth < SimState.MaxHealth)
 	{
-		int OldValue  = CurrentHealth;
-		CurrentHealth = MaxHealth;
-		OnHealthChanged.Broadcast(OldValue, CurrentHealth, MaxHealth);
+		int OldValue  = SimState.CurrentHealth;
+		SimState.CurrentHealth = SimState.MaxHealth;
+		if (!bIsResimulating) OnHealthChanged.Broadcast(OldValue, SimState.CurrentHealth, SimState.MaxHealth);
 	}
 }
 
 void ACharacterBB::SetMaxHealth(int NewMaxHealth)
 {
-	int OldValue = MaxHealth;
+	if (!CanChangeStats()) return;
+
+	int OldValue = SimState.MaxHealth;
 
 	// We just assume that the new value is within an acceptable range.
 	// Might be better if we had some range checking?
-	MaxHealth = NewMaxHealth;
+	SimState.MaxHealth = NewMaxHealth;
 
 	// Changing the MaxHealth 'might' also change the CurrentHealth,
 	// if it is now less than the current health.
 	// Regardless of that, we should fire the notification,
 	// just in case there are any widgets listening which need to calculate a new %
 
-	if (MaxHealth != OldValue) // We need to fire a notification
+	if (SimState.MaxHealth != OldValue) // We need to fire a notification
 	{
-		if (MaxHealth < OldValue)
+		if (SimState.MaxHealth < OldValue)
 		{
 			// MaxHealth decreased, 
 			// so we need to also cap the CurrentHealth to the new Max.
-			if (CurrentHealth > MaxHealth) CurrentHealth = MaxHealth;
+			if (SimState.CurrentHealth > SimState.MaxHealth) SimState.CurrentHealth = SimState.MaxHealth;
 		}
 
 		// There was a change, so notify any listeners
-		OnHealthChanged.Broadcast(OldValue, CurrentHealth, MaxHealth);
+		if (!bIsResimulating) OnHealthChanged.Broadcast(OldValue, SimState.CurrentHealth, SimState.MaxHealth);
 	}
 }
 
 float ACharacterBB::GetStamina()
 {
-	return CurrentStamina;
+	return SimState.CurrentStamina;
+}
+
+float ACharacterBB::GetMaxStamina()
+{
+	return StatTuning.MaxStamina;
 }
 
 float ACharacterBB::GetStaminaRecuperationFactor()
 {
-	return StaminaRecuperationFactor;
+	return SimState.StaminaRecuperationFactor;
 }
 
 void ACharacterBB::SetStaminaRecuperationFactor(float NewStaminaRecuperationFactor)
 {
 	// Might be sensible to check that this is a +ve value, within some
 	// sensible range.
-	StaminaRecuperationFactor = NewStaminaRecuperationFactor;
+	SimState.StaminaRecuperationFactor = NewStaminaRecuperationFactor;
 }
 
 float ACharacterBB::GetPsiPower()
 {
-	return CurrentPsiPower;
+	return SimState.CurrentPsiPower;
+}
+
+float ACharacterBB::GetMaxPsiPower()
+{
+	return StatTuning.MaxPsiPower;
 }
 
 void ACharacterBB::PsiBlast()
 {
+	// The server does the blast, the new psi power comes back in OnRep_SimState.
+	if (!CanChangeStats())
+	{
+		FStatLatencyTrackerBB::Get().TagStat(this, EStatTypeBB::PsiPower);
+		ServerPsiBlast();
+		return;
+	}
+
 	// The cost of the psi blast is 150.0f
 	// Check we have atleast that before allowing the function to work
-	if (CurrentPsiPower >= PsiBlastCost)
+	// (Deducting the power used while it's at it)
+	if (FStatRulesBB::TryPsiBlast(SimState, StatTuning))
 	{
 		// Do the Psi Blast
-
-		// Deduct the power used
-		CurrentPsiPower -= PsiBlastCost;
+		FStatLatencyTrackerBB::Get().TagStat(this, EStatTypeBB::PsiPower);
 	}
 }
 
+void ACharacterBB::ServerPsiBlast_Implementation()
+{
+	PsiBlast();
+}
+
 void ACharacterBB::AddKey(FString KeyToAdd)
 {
-	if (KeyWallet.Contains(KeyToAdd))
+	// The wallet is only changed on the server, the owner gets it through OnRep_ReplicatedKeys.
+	if (!CanChangeStats()) return;
+
+	LLM_SCOPE_BYTAG(BuildingBlocks_Character);
+	const int32 KeyId = FKeyRegistryBB::FindOrAdd(KeyToAdd);
+	if (SimState.Keys.Contains(KeyId))
 	{
 		// Key already in there, play a noise
-		OnKeyWalletAction.Broadcast(KeyToAdd, EPlayerKeyAction::AddKey, false);
+		if (!bIsResimulating) OnKeyWalletAction.Broadcast(KeyToAdd, EPlayerKeyAction::AddKey, false);
 	}
 	else
 	{
-		KeyWallet.Add(KeyToAdd);
+		SimState.Keys.Add(KeyId);
+		if (bIsResimulating) return;
+
+		ReplicatedKeys.Add(KeyToAdd);
 		// And maybe play a sound effect?
 		OnKeyWalletAction.Broadcast(KeyToAdd, EPlayerKeyAction::AddKey, true);
+		NotifyKeyLocks(KeyToAdd, true);
 	}
 }
 
 void ACharacterBB::RemoveKey(FString KeyToRemove)
 {
-	if (KeyWallet.Contains(KeyToRemove))
+	if (!CanChangeStats()) return;
+
+	const int32 KeyId = FKeyRegistryBB::Find(KeyToRemove);
+	if (SimState.Keys.Contains(KeyId))
 	{
-		KeyWallet.Remove(KeyToRemove);
+		SimState.Keys.Remove(KeyId);
+		if (bIsResimulating) return;
+
+		ReplicatedKeys.RemoveSingleSwap(KeyToRemove);
 		OnKeyWalletAction.Broadcast(KeyToRemove, EPlayerKeyAction::RemoveKey, true);
+		NotifyKeyLocks(KeyToRemove, false);
 	}
-	else
+	else if (!bIsResimulating)
 	{
-		OnKeyWalletAction.Broadcast(KeyToRemove, EPlayerKeyAction::RemoveKey, true);
+		OnKeyWalletAction.Broadcast(KeyToRemove, EPlayerKeyAction::RemoveKey, false);
 	}
 }
 
 bool ACharacterBB::IsPlayerCarryingKey(FString DesiredKey)
 {
-	bool Result = KeyWallet.Contains(DesiredKey);
-	OnKeyWalletAction.Broadcast(DesiredKey, EPlayerKeyAction::TestKey, Result);
+	bool Result = HasKey(DesiredKey);
+	if (!bIsResimulating) OnKeyWalletAction.Broadcast(DesiredKey, EPlayerKeyAction::TestKey, Result);
 	return Result;
 }
+
+bool ACharacterBB::HasKey(const FString& DesiredKey) const
+{
+	return SimState.Keys.Contains(FKeyRegistryBB::Find(DesiredKey));
+}
+
+TArray<FString> ACharacterBB::GetKeyWallet() const
+{
+	LLM_SCOPE_BYTAG(BuildingBlocks_Character);
+	TArray<FString> Keys;
+	Keys.Reserve(SimState.Keys.Num());
+	SimState.Keys.ForEach([&Keys](int32 KeyId) { Keys.Add(FKeyRegistryBB::GetName(KeyId)); });
+	return Keys;
+}
+
+void ACharacterBB::NotifyKeyLocks(const FString& Key, bool bAdded)
+{
+	if (UWorld* World = GetWorld())
+	{
+		if (UKeyLockIndexSubsystemBB* KeyLockIndex = World->GetSubsystem<UKeyLockIndexSubsystemBB>())
+			KeyLockIndex->NotifyKeyChanged(this, Key, bAdded);
+	}
+}
+
+#pragma region Replication
+
+void ACharacterBB::OnRep_SimState(const FCharacterSimStateBB& OldState)
+{
+	BroadcastStateChanges(OldState);
+}
+
+void ACharacterBB::OnRep_ReplicatedKeys()
+{
+	// Turn the names back into this machine's ids, and broadcast whatever changed,
+	// so listeners get the same AddKey/RemoveKey actions they would on the server.
+	LLM_SCOPE_BYTAG(BuildingBlocks_Character);
+	const FCharacterSimStateBB OldState = SimState;
+
+	SimState.Keys = FKeyBitsBB();
+	for (const FString& Key : ReplicatedKeys)
+	{
+		SimState.Keys.Add(FKeyRegistryBB::FindOrAdd(Key));
+	}
+
+	BroadcastStateChanges(OldState);
+}
+
+void ACharacterBB::OnRep_StatSummary(FStatSummaryBB OldSummary)
+{
+	// Turn the summary back into (roughly) the real values, so the getters work on other players too.
+	SimState.MaxHealth = StatSummary.MaxHealth;
+
+	if (StatSummary.Health != OldSummary.Health)
+	{
+		const int OldValue = SimState.CurrentHealth;
+		SimState.CurrentHealth      = FMath::RoundToInt(StatSummary.Health / 255.f * SimState.MaxHealth);
+		OnHealthChanged.Broadcast(OldValue, SimState.CurrentHealth, SimState.MaxHealth);
+	}
+
+	if (StatSummary.Stamina != OldSummary.Stamina)
+	{
+		const float OldValue = SimState.CurrentStamina;
+		SimState.CurrentStamina       = StatSummary.Stamina / 255.f * StatTuning.MaxStamina;
+		OnStaminaChanged.Broadcast(OldValue, SimState.CurrentStamina, StatTuning.MaxStamina);
+	}
+
+	if (StatSummary.PsiPower != OldSummary.PsiPower)
+	{
+		const float OldValue = SimState.CurrentPsiPower;
+		SimState.CurrentPsiPower      = StatSummary.PsiPower / 255.f * StatTuning.MaxPsiPower;
+		OnPsiPowerChanged.Broadcast(OldValue, SimState.CurrentPsiPower, StatTuning.MaxPsiPower);
+	}
+}
+
+void ACharacterBB::UpdateStatSummary()
+{
+	auto Quantize = [](float Value, float Max)
+	{
+		return static_cast<uint8>(Max > 0.f ? FMath::RoundToInt(FMath::Clamp(Value / Max, 0.f, 1.f) * 255.f) : 0);
+	};
+
+	// Small changes round to the same byte, so most ticks there is nothing to send.
+	StatSummary.MaxHealth = SimState.MaxHealth;
+	StatSummary.Health    = Quantize(SimState.CurrentHealth, SimState.MaxHealth);
+	StatSummary.Stamina   = Quantize(SimState.CurrentStamina, StatTuning.MaxStamina);
+	StatSummary.PsiPower  = Quantize(SimState.CurrentPsiPower, StatTuning.MaxPsiPower);
+}
+
+void ACharacterBB::PublishStats()
+{
+	UStatSnapshotSubsystemBB* Subsystem = StatSnapshots.Get();
+	if (!Subsystem || !StatSlot.IsValid()) return;
+
+	FStatSnapshotBB Snapshot;
+	Snapshot.Health      = SimState.CurrentHealth;
+	Snapshot.MaxHealth   = SimState.MaxHealth;
+	Snapshot.Stamina     = SimState.CurrentStamina;
+	Snapshot.PsiPower    = SimState.CurrentPsiPower;
+	Snapshot.NumKeys     = SimState.Keys.Num();
+	Snapshot.Time        = GetWorld()->GetTimeSeconds();
+	Snapshot.bIsRunning  = SimState.bIsRunning;
+	Snapshot.bIsCrouched = bIsCrouched;
+	Subsystem->Publish(StatSlot, Snapshot);
+}
+
+#pragma endregion
+
+#pragma region Rollback
+
+void ACharacterBB::SaveSnapshot(int32 Frame)
+{
+	if (Snapshots.IsInitialized()) Snapshots.Save(Frame, SimState);
+}
+
+bool ACharacterBB::RestoreSnapshot(int32 Frame)
+{
+	return Snapshots.Restore(Frame, SimState);
+}
+
+bool ACharacterBB::Resimulate(int32 Frame, int32 NumFrames, float DeltaTime, TFunctionRef<void(int32 Frame)> ApplyInputs)
+{
+	const FCharacterSimStateBB StateBeforeRollback = SimState;
+	if (!RestoreSnapshot(Frame)) return false;
+
+	bIsResimulating = true;
+	for (int32 FrameIndex = Frame; FrameIndex < Frame + NumFrames; ++FrameIndex)
+	{
+		ApplyInputs(FrameIndex);
+		SimulateStats(DeltaTime);
+		SaveSnapshot(FrameIndex + 1);
+	}
+	bIsResimulating = false;
+
+	// Only now does anyone hear about it, and only about the end result.
+	BroadcastStateChanges(StateBeforeRollback);
+	return true;
+}
+
+void ACharacterBB::BroadcastStateChanges(const FCharacterSimStateBB& OldState)
+{
+	if (SimState.CurrentHealth != OldState.CurrentHealth || SimState.MaxHealth != OldState.MaxHealth)
+	{
+		{
+			const FStatBroadcastScopeBB BroadcastScope(this, EStatTypeBB::Health);
+			OnHealthChanged.Broadcast(OldState.CurrentHealth, SimState.CurrentHealth, SimState.MaxHealth);
+		}
+
+		if (SimState.CurrentHealth <= 0 && OldState.CurrentHealth > 0) OnPlayerDied.Broadcast();
+	}
+
+	if (SimState.CurrentStamina != OldState.CurrentStamina)
+	{
+		const FStatBroadcastScopeBB BroadcastScope(this, EStatTypeBB::Stamina);
+		OnStaminaChanged.Broadcast(OldState.CurrentStamina, SimState.CurrentStamina, StatTuning.MaxStamina);
+	}
+
+	if (SimState.CurrentPsiPower != OldState.CurrentPsiPower)
+	{
+		const FStatBroadcastScopeBB BroadcastScope(this, EStatTypeBB::PsiPower);
+		OnPsiPowerChanged.Broadcast(OldState.CurrentPsiPower, SimState.CurrentPsiPower, StatTuning.MaxPsiPower);
+	}
+
+	if (SimState.bIsRunning != OldState.bIsRunning)
+		GetCharacterMovement()->MaxWalkSpeed = SimState.bIsRunning ? RunningMaxWalkSpeed : NormalMaxWalkSpeed;
+
+	const FKeyBitsBB AddedKeys   = SimState.Keys.Difference(OldState.Keys);
+	const FKeyBitsBB RemovedKeys = OldState.Keys.Difference(SimState.Keys);
+	if (AddedKeys.Num() == 0 && RemovedKeys.Num() == 0) return;
+
+	// A resimulation on the server can change the wallet, so keep the owner's copy up to date.
+	if (HasAuthority()) ReplicatedKeys = GetKeyWallet();
+
+	AddedKeys.ForEach([this](int32 KeyId)
+	{
+		const FString& Key = FKeyRegistryBB::GetName(KeyId);
+		OnKeyWalletAction.Broadcast(Key, EPlayerKeyAction::AddKey, true);
+		NotifyKeyLocks(Key, true);
+	});
+	RemovedKeys.ForEach([this](int32 KeyId)
+	{
+		const FString& Key = FKeyRegistryBB::GetName(KeyId);
+		OnKeyWalletAction.Broadcast(Key, EPlayerKeyAction::RemoveKey, true);
+		NotifyKeyLocks(Key, false);
+	});
+}
+
+#pragma endregion
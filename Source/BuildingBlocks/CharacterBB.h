@@ -3,9 +3,15 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "CharacterSimStateBB.h"
+#include "StatRulesBB.h"
+#include "StatSnapshotsBB.h"
 #include "GameFramework/Character.h"
 #include "CharacterBB.generated.h"
 
+enum class ETimedEffectTypeBB : uint8;
+class UStatRegenCurvesBB;
+
 
 // Delegate for when stats based on integers are changed.
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FIntStatUpdated,
@@ -22,6 +28,28 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FFloatStatUpdated,
                                                float, NewValue,
                                                float, MaxValue);
 
+// What everyone except the owner sees of a character's stats.
+// Each stat is a fraction of its max, squashed into a byte, which is plenty for a nameplate
+// and a quarter of the size of the full values the owner gets.
+// MaxHealth hardly ever changes, so is hardly ever sent, and lets them turn the summary back into points.
+USTRUCT(BlueprintType)
+struct FStatSummaryBB
+{
+	UPROPERTY()
+	int32 MaxHealth = 100;
+
+	UPROPERTY()
+	uint8 Health = 255;
+
+	UPROPERTY()
+	uint8 Stamina = 255;
+
+	UPROPERTY()
+	uint8 PsiPower = 255;
+
+	GENERATED_BODY()
+};
+
 // Different actions involving the key wallet.
 UENUM(BlueprintType)
 enum class EPlayerKeyAction: uint8
@@ -57,6 +85,8 @@ public:
 
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	// The normal walking speed of the character
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Player|Movement", meta = (AllowPrivateAccess = "true"))
 	float NormalMaxWalkSpeed = 400.0f;
@@ -85,6 +115,34 @@ public:
 	UFUNCTION(BlueprintCallable,Category="Player|Stats")
 	void BroadcastCurrentStats();
 
+	// How stamina and psi recovery speed up or slow down with how full they are.
+	// Without any, they recover at the same rate all the way up.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Player|Stats")
+	TObjectPtr<UStatRegenCurvesBB> RegenCurves = nullptr;
+
+	// Every stat as a fraction of its max, which is all anyone but the owner gets told.
+	// Kept up to date on the server too, so it works in any net mode.
+	const FStatSummaryBB& GetStatSummary() const { return StatSummary; }
+
+	// Where the stats are published at the end of each update, for reading on other threads.
+	// See UStatSnapshotSubsystemBB. Invalid before BeginPlay, after EndPlay, while pooled, or if the slots ran out.
+	const FStatSlotBB& GetStatSlot() const { return StatSlot; }
+
+	// Take (or give back) a stat slot. Done in BeginPlay and EndPlay, and by UCharacterPoolSubsystemBB
+	// as the character goes in and out of the pool, so pooled characters don't look alive to readers.
+	void SetPublishingStats(bool bPublish);
+
+	// Put every stat, flag, the key wallet and any timed effects back to how a new character starts.
+	// Nothing is reallocated. Any keys are removed (so locks hear about it), then the new stats are broadcast.
+	void ResetStats();
+
+	// Unbind everything listening to the stat and key wallet delegates, e.g. before going back into a pool.
+	void ClearStatListeners();
+
+	// Add (or with a -ve Modifier, remove) the ongoing effect of a timed effect.
+	// Called by UTimedEffectSubsystemBB when effects start and end, the totals are applied in Tick.
+	void AddTimedEffectModifier(ETimedEffectTypeBB Type, float Modifier);
+
 #pragma region Health
 
 	// Return the player's current health.
@@ -124,6 +182,10 @@ public:
 	UFUNCTION(BlueprintPure, Category="Player|Stamina")
 	float GetStamina();
 
+	// Return the player's max stamina.
+	UFUNCTION(BlueprintPure, Category="Player|Stamina")
+	float GetMaxStamina();
+
 	// Return the player's current recuperation factor.
 	UFUNCTION(BlueprintPure, Category="Player|Stamina")
 	float GetStaminaRecuperationFactor();
@@ -143,6 +205,10 @@ public:
 	UFUNCTION(BlueprintPure, Category="Player|PsiPower")
 	float GetPsiPower();
 
+	// Return the player's max psi power.
+	UFUNCTION(BlueprintPure, Category="Player|PsiPower")
+	float GetMaxPsiPower();
+
 	// Player unleashes a devastating blast of mind power!
 	UFUNCTION(BlueprintCallable, Category="Player|PsiPower")
 	void PsiBlast();
@@ -167,49 +233,124 @@ public:
 
 	// Does the player have a given key?
 	// Returns true if they do, and false if they dont.
+	// This counts as the player TRYING the key (e.g. walking up to a lock),
+	// so it fires OnKeyWalletAction with TestKey. To just look, use HasKey.
 	UFUNCTION(BlueprintPure, Category="Player|KeyWallet")
 	bool IsPlayerCarryingKey(FString DesiredKey);
 
+	// Does the player have a given key?
+	// Unlike IsPlayerCarryingKey, this has no side effects, and can be called as often as you like.
+	UFUNCTION(BlueprintPure, Category="Player|KeyWallet")
+	bool HasKey(const FString& DesiredKey) const;
+
+	// Every key the player is carrying.
+	// Used by UI which needs the whole wallet at once, without going through the CountKeys string.
+	// Built from the key bits each time, so don't call it every frame.
+	TArray<FString> GetKeyWallet() const;
+
 	// Triggered when something happens with the player's key wallet.
 	UPROPERTY(BlueprintAssignable, Category = "Player|KeyWallet")
 	FKeyWalletAction OnKeyWalletAction;
 
 #pragma endregion
 
+#pragma region Rollback
+
+	// How many frames of snapshots to keep for rollback.
+	// 0 keeps none, so characters which never roll back don't pay for the buffer.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Player|Rollback", meta = (ClampMin = 0))
+	int32 RollbackFrames = 0;
+
+	const FCharacterSimStateBB& GetSimState() const { return SimState; }
+
+	// Save the current state as the state at the start of Frame.
+	void SaveSnapshot(int32 Frame);
+
+	// Go back to the state at the start of Frame, without telling anyone.
+	// Returns false if Frame isn't in the buffer any more.
+	bool RestoreSnapshot(int32 Frame);
+
+	// Roll back to Frame and simulate NumFrames from there, saving a snapshot after each one.
+	// ApplyInputs is called before each frame is simulated, to redo whatever the player did in it.
+	// Nothing is broadcast while resimulating, once it is done, whatever ended up different
+	// from before the rollback is broadcast once.
+	bool Resimulate(int32 Frame, int32 NumFrames, float DeltaTime, TFunctionRef<void(int32 Frame)> ApplyInputs);
+
+	bool IsResimulating() const { return bIsResimulating; }
+
+#pragma endregion
+
 protected:
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void OnJumped_Implementation() override;
+
 private:
-	// is the character currently set to sprint?
-	bool bIsRunning = false;
-
-	// did the character sprint since the last update?
-	bool bHasRan = false;
-
-	// did the character jump since the last update?
-	bool bHasJumped = false;
-
-	// Health
-	static constexpr int BaseStatValue = 100;
-	int                  MaxHealth     = BaseStatValue;
-	int                  CurrentHealth = BaseStatValue;
-
-	// Stamina
-	static constexpr float MaxStamina                = 100.0f;
-	static constexpr float JumpStaminaCost           = 25.0f;
-	static constexpr float RunStaminaCost            = 5.0f;
-	static constexpr float RestStaminaRebate         = 4.0f;
-	float                  CurrentStamina            = MaxStamina;
-	float                  StaminaRecuperationFactor = 1.0f;
-
-	// Psi Power
-	static constexpr float MaxPsiPower     = 1000.0f;
-	static constexpr float PsiRechargeRate = 1.0f;
-	static constexpr float PsiBlastCost    = 150.0f;
-	float                  CurrentPsiPower = MaxPsiPower;
-
-	// Player Keys
-	TArray<FString> KeyWallet;
+	// Stats are only ever changed on the server, these let the owning client ask for the changes it makes.
+	UFUNCTION(Server, Reliable)
+	void ServerSetRunning(bool IsRunning);
+
+	UFUNCTION(Server, Reliable)
+	void ServerPsiBlast();
+
+	// Owner only, full precision.
+	UFUNCTION()
+	void OnRep_SimState(const FCharacterSimStateBB& OldState);
+
+	UFUNCTION()
+	void OnRep_ReplicatedKeys();
+
+	// Everyone else, see FStatSummaryBB.
+	UFUNCTION()
+	void OnRep_StatSummary(FStatSummaryBB OldSummary);
+
+	// Refresh StatSummary from the full values, on the server.
+	void UpdateStatSummary();
+
+	// Copy the stats to StatSlot, for anyone reading them off the game thread.
+	void PublishStats();
+
+	// Move the stat simulation on by one update. Called by Tick, and once per frame when resimulating.
+	void SimulateStats(float DeltaTime);
+
+	// Broadcast everything which differs between OldState and SimState, as if it had just changed.
+	void BroadcastStateChanges(const FCharacterSimStateBB& OldState);
+
+	// The server owns the stats, except while resimulating, which is a local prediction.
+	bool CanChangeStats() const { return HasAuthority() || bIsResimulating; }
+
+	// Max stamina, the cost of jumping, etc. The rules themselves are in FStatRulesBB.
+	static constexpr FStatTuningBB StatTuning = {};
+
+	// Health, stamina, psi power, keys and movement flags, see FCharacterSimStateBB.
+	UPROPERTY(ReplicatedUsing=OnRep_SimState)
+	FCharacterSimStateBB SimState;
+
+	// Key ids are local to each machine, so the server sends the owner the names as well.
+	UPROPERTY(ReplicatedUsing=OnRep_ReplicatedKeys)
+	TArray<FString> ReplicatedKeys;
+
+	UPROPERTY(ReplicatedUsing=OnRep_StatSummary)
+	FStatSummaryBB StatSummary;
+
+	// Tell the locks which care about this key that it was added or removed.
+	void NotifyKeyLocks(const FString& Key, bool bAdded);
+
+	// Running totals of every timed effect currently on the character.
+	// Not part of the snapshot, the effects themselves are what would need rolling back.
+	float StaminaRegenBonus = 0.f; // Added to x1
+	float DamagePerSecond   = 0.f;
+	float PsiDrainPerSecond = 0.f;
+
+	TSnapshotRingBB<FCharacterSimStateBB> Snapshots;
+
+	TWeakObjectPtr<UStatSnapshotSubsystemBB> StatSnapshots;
+	FStatSlotBB                              StatSlot;
+
+	// Broadcasts are held back while this is set.
+	bool bIsResimulating = false;
 
 	GENERATED_BODY()
 };
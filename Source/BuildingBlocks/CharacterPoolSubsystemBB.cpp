@@ -0,0 +1,232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CharacterPoolSubsystemBB.h"
+#include "CharacterBB.h"
+#include "CustomLogging.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectGlobals.h"
+
+// Well away from anything, in case a pooled character is ever seen or bumped into.
+static const FVector PoolLocation(0.f, 0.f, -100000.f);
+
+static void SetPooled(ACharacterBB& Character, bool bPooled)
+{
+	Character.SetActorHiddenInGame(bPooled);
+	Character.SetActorEnableCollision(!bPooled);
+	Character.SetActorTickEnabled(!bPooled);
+
+	if (UCharacterMovementComponent* Movement = Character.GetCharacterMovement())
+	{
+		Movement->StopMovementImmediately();
+		Movement->SetComponentTickEnabled(!bPooled);
+	}
+	if (USkeletalMeshComponent* Mesh = Character.GetMesh()) Mesh->SetComponentTickEnabled(!bPooled);
+
+	// Nothing to send while it's in the pool.
+	Character.SetNetDormancy(bPooled ? DORM_DormantAll : DORM_Awake);
+
+	// Nor to publish, and the slot is better off with a character that's in play.
+	Character.SetPublishingStats(!bPooled);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GPoolBenchmarkCommand(
+	TEXT("bb.Pool.Benchmark"),
+	TEXT("Compare spawning and destroying characters against a character pool. Arguments: [Count=500] [Rounds=5]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UCharacterPoolSubsystemBB* CharacterPool = World ? World->GetSubsystem<UCharacterPoolSubsystemBB>() : nullptr;
+		if (!CharacterPool) return;
+
+		const int32 Count  = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 500;
+		const int32 Rounds = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 5;
+
+		// The same character as the player, as that's what a wave would be made of.
+		const APlayerController* PlayerController = World->GetFirstPlayerController();
+		const APawn*             PlayerPawn       = PlayerController ? PlayerController->GetPawn() : nullptr;
+		UClass*                  CharacterClass   = PlayerPawn && PlayerPawn->IsA<ACharacterBB>()
+			                                            ? PlayerPawn->GetClass()
+			                                            : ACharacterBB::StaticClass();
+
+		// A grid, a long way from anything the player will walk into.
+		const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count)));
+		auto GetTransform = [GridSize](int32 Index)
+		{
+			return FTransform(FVector(100000.f + (Index % GridSize) * 200.f, (Index / GridSize) * 200.f, 0.f));
+		};
+
+		TArray<ACharacterBB*> Characters;
+		Characters.Reserve(Count);
+
+		double SpawnSeconds   = 0.0;
+		double DestroySeconds = 0.0;
+		double PlainGCSeconds = 0.0;
+		for (int32 Round = 0; Round < Rounds; ++Round)
+		{
+			const double SpawnStart = FPlatformTime::Seconds();
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				FActorSpawnParameters SpawnParameters;
+				SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+				Characters.Add(World->SpawnActor<ACharacterBB>(CharacterClass, GetTransform(Index), SpawnParameters));
+			}
+			const double DestroyStart = FPlatformTime::Seconds();
+			for (ACharacterBB* Character : Characters)
+			{
+				if (Character) Character->Destroy();
+			}
+			const double GCStart = FPlatformTime::Seconds();
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+			const double GCEnd = FPlatformTime::Seconds();
+
+			SpawnSeconds   += DestroyStart - SpawnStart;
+			DestroySeconds += GCStart - DestroyStart;
+			PlainGCSeconds += GCEnd - GCStart;
+			Characters.Reset();
+		}
+
+		// Filling the pool is a one-off, e.g. while loading, so it's timed on its own.
+		const double PrewarmStart = FPlatformTime::Seconds();
+		CharacterPool->Prewarm(CharacterClass, Count);
+		const double PrewarmSeconds = FPlatformTime::Seconds() - PrewarmStart;
+
+		double AcquireSeconds = 0.0;
+		double ReleaseSeconds = 0.0;
+		double PoolGCSeconds  = 0.0;
+		for (int32 Round = 0; Round < Rounds; ++Round)
+		{
+			const double AcquireStart = FPlatformTime::Seconds();
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				Characters.Add(CharacterPool->Acquire(CharacterClass, GetTransform(Index)));
+			}
+			const double ReleaseStart = FPlatformTime::Seconds();
+			for (ACharacterBB* Character : Characters)
+			{
+				CharacterPool->Release(Character);
+			}
+			const double GCStart = FPlatformTime::Seconds();
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+			const double GCEnd = FPlatformTime::Seconds();
+
+			AcquireSeconds += ReleaseStart - AcquireStart;
+			ReleaseSeconds += GCStart - ReleaseStart;
+			PoolGCSeconds  += GCEnd - GCStart;
+			Characters.Reset();
+		}
+		CharacterPool->EmptyPool();
+
+		const int32 NumOperations = Count * Rounds;
+		BBLOG(Log, "Character pool, {0} characters for {1} rounds:", Count, Rounds);
+		BBLOG(Log, "  SpawnActor/Destroy: spawn {0} us, destroy {1} us each, GC {2} ms per round",
+		      SpawnSeconds * 1e6 / NumOperations, DestroySeconds * 1e6 / NumOperations,
+		      PlainGCSeconds * 1000.0 / Rounds);
+		BBLOG(Log, "  Pool: acquire {0} us, release {1} us each, GC {2} ms per round (filling the pool took {3} ms)",
+		      AcquireSeconds * 1e6 / NumOperations, ReleaseSeconds * 1e6 / NumOperations,
+		      PoolGCSeconds * 1000.0 / Rounds, PrewarmSeconds * 1000.0);
+		BBLOG(Log, "  Throughput: {0} spawn+destroy/s, against {1} acquire+release/s",
+		      NumOperations / FMath::Max(SpawnSeconds + DestroySeconds, 1e-9),
+		      NumOperations / FMath::Max(AcquireSeconds + ReleaseSeconds, 1e-9));
+	}));
+
+ACharacterBB* UCharacterPoolSubsystemBB::Acquire(TSubclassOf<ACharacterBB> Class, const FTransform& Transform)
+{
+	UClass* CharacterClass = Class ? Class.Get() : ACharacterBB::StaticClass();
+
+	ACharacterBB* Character = nullptr;
+	if (FCharacterPoolBucketBB* Bucket = Pool.Find(CharacterClass))
+	{
+		// Skip any which were destroyed while they were in the pool.
+		while (!Character && Bucket->Characters.Num() > 0)
+		{
+			ACharacterBB* Candidate = Bucket->Characters.Pop(false);
+			if (IsValid(Candidate)) Character = Candidate;
+		}
+	}
+
+	if (!Character)
+	{
+		Character = SpawnCharacter(CharacterClass, Transform);
+	}
+	else
+	{
+		Character->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+		SetPooled(*Character, false);
+	}
+
+	if (Character) OnCharacterAcquired.Broadcast(Character);
+	return Character;
+}
+
+void UCharacterPoolSubsystemBB::Release(ACharacterBB* Character)
+{
+	if (!IsValid(Character)) return;
+
+	FCharacterPoolBucketBB& Bucket = Pool.FindOrAdd(Character->GetClass());
+	checkSlow(!Bucket.Characters.Contains(Character));
+
+	if (AController* Controller = Character->GetController()) Controller->UnPossess();
+
+	// Reset first, so anyone still listening hears the keys go, then let them all go.
+	Character->ResetStats();
+	Character->ClearStatListeners();
+
+	SetPooled(*Character, true);
+	Character->SetActorLocation(PoolLocation, false, nullptr, ETeleportType::ResetPhysics);
+	Bucket.Characters.Add(Character);
+}
+
+void UCharacterPoolSubsystemBB::Prewarm(TSubclassOf<ACharacterBB> Class, int32 Count)
+{
+	UClass*                 CharacterClass = Class ? Class.Get() : ACharacterBB::StaticClass();
+	FCharacterPoolBucketBB& Bucket         = Pool.FindOrAdd(CharacterClass);
+	Bucket.Characters.Reserve(Bucket.Characters.Num() + Count);
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		if (ACharacterBB* Character = SpawnCharacter(CharacterClass, FTransform(PoolLocation)))
+		{
+			SetPooled(*Character, true);
+			Bucket.Characters.Add(Character);
+		}
+	}
+}
+
+void UCharacterPoolSubsystemBB::EmptyPool()
+{
+	for (TPair<TObjectPtr<UClass>, FCharacterPoolBucketBB>& Pair : Pool)
+	{
+		for (ACharacterBB* Character : Pair.Value.Characters)
+		{
+			if (IsValid(Character)) Character->Destroy();
+		}
+	}
+	Pool.Empty();
+}
+
+int32 UCharacterPoolSubsystemBB::GetNumPooled() const
+{
+	int32 NumPooled = 0;
+	for (const TPair<TObjectPtr<UClass>, FCharacterPoolBucketBB>& Pair : Pool)
+	{
+		NumPooled += Pair.Value.Characters.Num();
+	}
+	return NumPooled;
+}
+
+void UCharacterPoolSubsystemBB::Deinitialize()
+{
+	// The world is going anyway, and its actors with it.
+	Pool.Empty();
+	Super::Deinitialize();
+}
+
+ACharacterBB* UCharacterPoolSubsystemBB::SpawnCharacter(UClass* Class, const FTransform& Transform) const
+{
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return GetWorld()->SpawnActor<ACharacterBB>(Class, Transform, SpawnParameters);
+}
@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CharacterRegistrySubsystemBB.h"
+#include "CharacterBB.h"
+
+void UCharacterRegistrySubsystemBB::RegisterCharacter(ACharacterBB* Character)
+{
+	if (Character) Characters.AddUnique(Character);
+}
+
+void UCharacterRegistrySubsystemBB::UnregisterCharacter(ACharacterBB* Character)
+{
+	Characters.RemoveSingleSwap(Character, false);
+}
+
+void UCharacterRegistrySubsystemBB::Deinitialize()
+{
+	Characters.Empty();
+
+	Super::Deinitialize();
+}
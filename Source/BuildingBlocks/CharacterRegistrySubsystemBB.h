@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CharacterRegistrySubsystemBB.generated.h"
+
+class ACharacterBB;
+
+/* Every ACharacterBB which is currently in play in the world.
+ * Characters add themselves in BeginPlay and remove themselves in EndPlay,
+ * so anything which needs them all (e.g. the HUD's nameplates) walks a short array
+ * rather than iterating every actor in the world. */
+UCLASS()
+class BUILDINGBLOCKS_API UCharacterRegistrySubsystemBB : public UWorldSubsystem
+{
+public:
+	void RegisterCharacter(ACharacterBB* Character);
+	void UnregisterCharacter(ACharacterBB* Character);
+
+	// In no particular order, removing a character moves the last one into its place.
+	const TArray<TObjectPtr<ACharacterBB>>& GetCharacters() const { return Characters; }
+
+protected:
+	virtual void Deinitialize() override;
+
+private:
+	UPROPERTY()
+	TArray<TObjectPtr<ACharacterBB>> Characters;
+
+	GENERATED_BODY()
+};
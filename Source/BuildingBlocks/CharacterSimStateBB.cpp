@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CharacterSimStateBB.h"
+#include "Containers/IndirectArray.h"
+#include "Misc/ScopeRWLock.h"
+
+// Names are each allocated on their own, so a reference from GetName stays good as more are added.
+struct FKeyRegistryDataBB
+{
+	FRWLock                 Lock;
+	TMap<FString, int32>    KeyIds;
+	TIndirectArray<FString> KeyNames;
+};
+
+static FKeyRegistryDataBB& GetKeyRegistry()
+{
+	static FKeyRegistryDataBB Registry;
+	return Registry;
+}
+
+int32 FKeyRegistryBB::FindOrAdd(const FString& KeyName)
+{
+	const int32 ExistingId = Find(KeyName);
+	if (ExistingId != INDEX_NONE) return ExistingId;
+
+	FKeyRegistryDataBB& Registry = GetKeyRegistry();
+	FWriteScopeLock     WriteLock(Registry.Lock);
+
+	// Someone else may have added it since Find.
+	if (const int32* KeyId = Registry.KeyIds.Find(KeyName)) return *KeyId;
+
+	const int32 KeyId = Registry.KeyNames.Add(new FString(KeyName));
+	Registry.KeyIds.Add(KeyName, KeyId);
+	return KeyId;
+}
+
+int32 FKeyRegistryBB::Find(const FString& KeyName)
+{
+	FKeyRegistryDataBB& Registry = GetKeyRegistry();
+	FReadScopeLock      ReadLock(Registry.Lock);
+
+	const int32* KeyId = Registry.KeyIds.Find(KeyName);
+	return KeyId ? *KeyId : INDEX_NONE;
+}
+
+const FString& FKeyRegistryBB::GetName(int32 KeyId)
+{
+	static const FString NoName;
+
+	FKeyRegistryDataBB& Registry = GetKeyRegistry();
+	FReadScopeLock      ReadLock(Registry.Lock);
+	return Registry.KeyNames.IsValidIndex(KeyId) ? Registry.KeyNames[KeyId] : NoName;
+}
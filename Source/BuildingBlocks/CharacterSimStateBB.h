@@ -0,0 +1,161 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CharacterSimStateBB.generated.h"
+
+// Gives every key name a small integer id, so a set of keys can be a handful of bits.
+// Ids are handed out in the order keys are first seen, so they are only meaningful inside one process,
+// anything crossing the network has to use the names.
+// Ids are never given back, there's one per key name ever seen by the process. Safe from any thread.
+class BUILDINGBLOCKS_API FKeyRegistryBB
+{
+public:
+	// The id for a key, registering it if it is new.
+	static int32 FindOrAdd(const FString& KeyName);
+
+	// The id for a key, or INDEX_NONE if it has never been seen.
+	static int32 Find(const FString& KeyName);
+
+	// Empty for an id which was never handed out.
+	static const FString& GetName(int32 KeyId);
+};
+
+// A set of keys, by id. The first InlineKeys ids fit inside the struct itself, so copying a set of those
+// (e.g. a rollback snapshot) never allocates. Sets with higher ids grow onto the heap.
+struct FKeyBitsBB
+{
+	static constexpr int32 InlineKeys = 128;
+
+	bool Contains(int32 KeyId) const { return KeyId >= 0 && KeyId < Bits.Num() && Bits[KeyId]; }
+
+	void Add(int32 KeyId)
+	{
+		if (KeyId < 0) return;
+		if (KeyId >= Bits.Num()) Bits.Add(false, KeyId + 1 - Bits.Num());
+		Bits[KeyId] = true;
+	}
+
+	void Remove(int32 KeyId)
+	{
+		if (Contains(KeyId)) Bits[KeyId] = false;
+	}
+
+	int32 Num() const { return Bits.CountSetBits(); }
+
+	// Call Function with the id of every key in the set.
+	template <typename FunctionType>
+	void ForEach(FunctionType&& Function) const
+	{
+		for (TConstSetBitIterator<FAllocator> It(Bits); It; ++It) Function(It.GetIndex());
+	}
+
+	// The keys in this set which aren't in Other.
+	FKeyBitsBB Difference(const FKeyBitsBB& Other) const
+	{
+		FKeyBitsBB Result;
+		ForEach([&Result, &Other](int32 KeyId)
+		{
+			if (!Other.Contains(KeyId)) Result.Add(KeyId);
+		});
+		return Result;
+	}
+
+private:
+	using FAllocator = TInlineAllocator<InlineKeys / NumBitsPerDWORD>;
+
+	TBitArray<FAllocator> Bits;
+};
+
+/* Everything ACharacterBB's stat simulation reads and writes, in one lump,
+ * so saving and restoring it for rollback is a single copy. Nothing in it allocates,
+ * except a key set with more than FKeyBitsBB::InlineKeys different keys ever seen.
+ *
+ * Starts out full, the same as ACharacterBB's maximums.
+ * The UPROPERTYs are what gets replicated to the owner. The rest either can't cross the network
+ * as it is (key ids), or the owner doesn't need it. */
+USTRUCT()
+struct FCharacterSimStateBB
+{
+	// Health
+	UPROPERTY()
+	int32 CurrentHealth = 100;
+
+	UPROPERTY()
+	int32 MaxHealth = 100;
+
+	// Damage over time which doesn't yet add up to a whole point of health.
+	float PendingDamage = 0.f;
+
+	// Stamina
+	UPROPERTY()
+	float CurrentStamina = 100.f;
+
+	float StaminaRecuperationFactor = 1.f;
+
+	// Psi Power
+	UPROPERTY()
+	float CurrentPsiPower = 1000.f;
+
+	// Player Keys
+	FKeyBitsBB Keys;
+
+	// is the character currently set to sprint?
+	bool bIsRunning = false;
+
+	// did the character sprint since the last update?
+	bool bHasRan = false;
+
+	// did the character jump since the last update?
+	bool bHasJumped = false;
+
+	// A copy of ACharacter::bIsCrouched, taken each update, so a resimulation can set it per frame
+	// without going through the movement component.
+	bool bIsCrouched = false;
+
+	GENERATED_BODY()
+};
+
+// A fixed number of the most recent snapshots, by frame number.
+// All the memory is allocated up front by Init, saving and restoring don't allocate unless the state itself does.
+template <typename StateType>
+class TSnapshotRingBB
+{
+public:
+	void Init(int32 NumFrames)
+	{
+		States.SetNum(NumFrames);
+		Frames.Init(INDEX_NONE, NumFrames);
+	}
+
+	bool IsInitialized() const { return States.Num() > 0; }
+
+	// Forget every saved frame, keeping the memory.
+	void Invalidate()
+	{
+		for (int32& Frame : Frames) Frame = INDEX_NONE;
+	}
+
+	void Save(int32 Frame, const StateType& State)
+	{
+		check(Frame >= 0);
+		const int32 Slot = Frame % States.Num();
+		States[Slot] = State;
+		Frames[Slot] = Frame;
+	}
+
+	// False if Frame was never saved, or has since been overwritten.
+	bool Restore(int32 Frame, StateType& OutState) const
+	{
+		if (Frame < 0 || !IsInitialized()) return false;
+		const int32 Slot = Frame % States.Num();
+		if (Frames[Slot] != Frame) return false;
+		OutState = States[Slot];
+		return true;
+	}
+
+private:
+	TArray<StateType> States;
+	TArray<int32>     Frames;
+};
@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "InputRecordingBB.h"
+#include "CustomLogging.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+bool FInputRecordingBB::SaveToFile(const FString& FileName)
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	Serialize(Writer);
+
+	return FFileHelper::SaveArrayToFile(Bytes, *FileName);
+}
+
+bool FInputRecordingBB::LoadFromFile(const FString& FileName)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *FileName)) return false;
+
+	FMemoryReader Reader(Bytes);
+	Serialize(Reader);
+
+	// Don't leave half a recording lying around to be replayed.
+	if (Reader.IsError()) Events.Reset();
+	return !Reader.IsError();
+}
+
+void FInputRecordingBB::Serialize(FArchive& Ar)
+{
+	uint32 FileMagic   = Magic;
+	uint32 FileVersion = Version;
+	Ar << FileMagic;
+	Ar << FileVersion;
+
+	if (Ar.IsLoading() && (FileMagic != Magic || FileVersion != Version))
+	{
+		BBLOG(Error, "Not an input recording, or an unsupported version");
+		Ar.SetError();
+		return;
+	}
+
+	Ar << FixedDeltaTime;
+
+	uint32 NumEvents = Events.Num();
+	Ar.SerializeIntPacked(NumEvents);
+	if (Ar.IsLoading())
+	{
+		// A corrupt or cut off file can claim any number of events, so make sure they could fit first.
+		if (Ar.IsError() || static_cast<int64>(NumEvents) * MinEventBytes > Ar.TotalSize() - Ar.Tell())
+		{
+			BBLOG(Error, "Input recording claims {0} events, more than the file has room for", NumEvents);
+			Ar.SetError();
+			return;
+		}
+		Events.SetNum(NumEvents);
+	}
+
+	uint32 PreviousFrame = 0;
+	for (FRecordedInputBB& Event : Events)
+	{
+		// Frames only go up, and most events are on the same or next frame,
+		// so the delta almost always packs into a single byte.
+		uint32 FrameDelta = Event.Frame - PreviousFrame;
+		Ar.SerializeIntPacked(FrameDelta);
+		Event.Frame   = PreviousFrame + FrameDelta;
+		PreviousFrame = Event.Frame;
+
+		uint8 Action    = static_cast<uint8>(Event.Action);
+		uint8 ValueType = static_cast<uint8>(Event.Value.GetValueType());
+		Ar << Action;
+		Ar << ValueType;
+
+		if (Ar.IsLoading() &&
+			(Action >= static_cast<uint8>(EInputActionBB::Count) ||
+				ValueType > static_cast<uint8>(EInputActionValueType::Axis3D)))
+		{
+			Ar.SetError();
+			return;
+		}
+
+		// Only store the components the value type actually uses.
+		FVector3f Axis = FVector3f(Event.Value.Get<FVector>());
+		switch (static_cast<EInputActionValueType>(ValueType))
+		{
+		case EInputActionValueType::Boolean:
+			{
+				// FArchive writes bools as 4 bytes, so use a byte instead.
+				uint8 bValue = Axis.X != 0.f ? 1 : 0;
+				Ar << bValue;
+				Axis.X = bValue ? 1.f : 0.f;
+			}
+			break;
+		case EInputActionValueType::Axis1D:
+			Ar << Axis.X;
+			break;
+		case EInputActionValueType::Axis2D:
+			Ar << Axis.X << Axis.Y;
+			break;
+		case EInputActionValueType::Axis3D:
+			Ar << Axis.X << Axis.Y << Axis.Z;
+			break;
+		}
+
+		if (Ar.IsLoading())
+		{
+			Event.Action = static_cast<EInputActionBB>(Action);
+			Event.Value  = FInputActionValue(static_cast<EInputActionValueType>(ValueType), FVector(Axis));
+		}
+	}
+}
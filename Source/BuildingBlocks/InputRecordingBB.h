@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InputActionValue.h"
+
+// Every input action the player controller handles.
+// The values are written to recordings, so only ever add to the end.
+enum class EInputActionBB : uint8
+{
+	Move,
+	Look,
+	Jump,
+	PsiBlast,
+	ToggleSprint,
+	ToggleCrouch,
+	CycleUIMode,
+
+	Count
+};
+
+// A single input action, and the frame it happened on.
+struct FRecordedInputBB
+{
+	uint32            Frame  = 0;
+	EInputActionBB    Action = EInputActionBB::Move;
+	FInputActionValue Value;
+};
+
+/* A recording of every input action the player made, used to replay
+ * exactly the same session on a build machine, so builds can be compared.
+ *
+ * On disk it is a small header followed by the events, where each event is
+ * the frame delta (packed), the action, the value type, and only as many floats
+ * as that value type needs. A digital action like Jump is 4 bytes. */
+class BUILDINGBLOCKS_API FInputRecordingBB
+{
+public:
+	// The fixed timestep the recording was made at (and must be replayed at).
+	float FixedDeltaTime = 1.f / 60.f;
+
+	// Events, in frame order.
+	TArray<FRecordedInputBB> Events;
+
+	// Not const, as the same Serialize reads and writes.
+	bool SaveToFile(const FString& FileName);
+	bool LoadFromFile(const FString& FileName);
+
+	void Serialize(FArchive& Ar);
+
+private:
+	static constexpr uint32 Magic   = 0x52494242; // 'BBIR'
+	static constexpr uint32 Version = 1;
+
+	// The smallest an event can be on disk (a digital action), used to check the event count before loading.
+	static constexpr int64 MinEventBytes = 4;
+};
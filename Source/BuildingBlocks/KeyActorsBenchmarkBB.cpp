@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Console commands for comparing the cost of the native key actors (AKeyGiverBB, ALockedPlatformBB)
+// against the KeyGiver and LockedPlatform blueprints.
+// Spawn a few thousand of either kind well away from the player, then compare 'stat game' / 'stat unit'.
+
+#include "CustomLogging.h"
+#include "KeyGiverBB.h"
+#include "LockedPlatformBB.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static const FName KeyActorsBenchmarkTag(TEXT("BBKeyActorsBenchmark"));
+
+// How many tick functions the actor (and its components) currently have enabled.
+static int32 CountEnabledTickFunctions(const AActor* Actor)
+{
+	int32 Count = Actor->IsActorTickEnabled() ? 1 : 0;
+	for (const UActorComponent* Component : Actor->GetComponents())
+	{
+		if (Component && Component->IsComponentTickEnabled()) ++Count;
+	}
+	return Count;
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GKeyActorsSpawnCommand(
+	TEXT("bb.KeyActors.Spawn"),
+	TEXT("Spawn key givers and locked platforms away from the player. Arguments: [Native|Blueprint] [Count=1000]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (!World) return;
+
+		const bool  bBlueprint = Args.Num() > 0 && Args[0].Equals(TEXT("Blueprint"), ESearchCase::IgnoreCase);
+		const int32 Count      = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 1000;
+
+		UClass* KeyGiverClass = bBlueprint
+			                        ? LoadClass<AActor>(nullptr, TEXT("/Game/Core/KeyGiver.KeyGiver_C"))
+			                        : AKeyGiverBB::StaticClass();
+		UClass* LockedPlatformClass = bBlueprint
+			                              ? LoadClass<AActor>(nullptr, TEXT("/Game/Core/LockedPlatform.LockedPlatform_C"))
+			                              : ALockedPlatformBB::StaticClass();
+		if (!KeyGiverClass || !LockedPlatformClass)
+		{
+			BBLOG(Error, "Unable to load the key actor classes");
+			return;
+		}
+
+		// A grid, a long way from anything the player will walk into.
+		const int32          GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count)));
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		int32 EnabledTickFunctions = 0;
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const FVector Location(100000.f + (Index % GridSize) * 600.f, (Index / GridSize) * 600.f, 0.f);
+
+			// Half of each
+			UClass* Class = Index % 2 == 0 ? KeyGiverClass : LockedPlatformClass;
+			if (AActor* Actor = World->SpawnActor<AActor>(Class, Location, FRotator::ZeroRotator, SpawnParameters))
+			{
+				Actor->Tags.Add(KeyActorsBenchmarkTag);
+				EnabledTickFunctions += CountEnabledTickFunctions(Actor);
+			}
+		}
+
+		BBLOG(Log, "Spawned {0} {1} key actors, {2} tick functions enabled between them",
+		      Count, bBlueprint ? TEXT("blueprint") : TEXT("native"), EnabledTickFunctions);
+	}));
+
+static FAutoConsoleCommandWithWorld GKeyActorsClearCommand(
+	TEXT("bb.KeyActors.Clear"),
+	TEXT("Destroy everything spawned by bb.KeyActors.Spawn."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (!World) return;
+
+		int32 Count = 0;
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			if (It->ActorHasTag(KeyActorsBenchmarkTag))
+			{
+				It->Destroy();
+				++Count;
+			}
+		}
+		BBLOG(Log, "Destroyed {0} key actors", Count);
+	}));
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "KeyGiverBB.h"
+#include "CharacterBB.h"
+#include "Components/SphereComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "GameFramework/RotatingMovementComponent.h"
+
+AKeyGiverBB::AKeyGiverBB()
+{
+	// Everything is driven by overlaps, nothing needs to tick.
+	PrimaryActorTick.bCanEverTick = false;
+
+	KeyGrantingCube = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("KeyGrantingCube"));
+	KeyGrantingCube->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	KeyGrantingCube->SetCollisionResponseToAllChannels(ECR_Ignore);
+	KeyGrantingCube->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
+	KeyGrantingCube->SetGenerateOverlapEvents(true);
+	RootComponent = KeyGrantingCube;
+
+	ProximitySphere = CreateDefaultSubobject<USphereComponent>(TEXT("ProximitySphere"));
+	ProximitySphere->SetupAttachment(KeyGrantingCube);
+	ProximitySphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	ProximitySphere->SetCollisionResponseToAllChannels(ECR_Ignore);
+	ProximitySphere->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
+	ProximitySphere->SetGenerateOverlapEvents(true);
+
+	// Only spins (and so only ticks) while someone is close enough to see it.
+	RotatingMovement = CreateDefaultSubobject<URotatingMovementComponent>(TEXT("RotatingMovement"));
+	RotatingMovement->bAutoActivate = false;
+	RotatingMovement->SetUpdatedComponent(KeyGrantingCube);
+}
+
+void AKeyGiverBB::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ProximitySphere->SetSphereRadius(SpinRadius);
+
+	KeyGrantingCube->OnComponentBeginOverlap.AddDynamic(this, &AKeyGiverBB::OnKeyOverlap);
+	ProximitySphere->OnComponentBeginOverlap.AddDynamic(this, &AKeyGiverBB::OnProximityBeginOverlap);
+	ProximitySphere->OnComponentEndOverlap.AddDynamic(this, &AKeyGiverBB::OnProximityEndOverlap);
+}
+
+void AKeyGiverBB::OnKeyOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
+                               UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep,
+                               const FHitResult& SweepResult)
+{
+	ACharacterBB* Character = Cast<ACharacterBB>(OtherActor);
+	if (!Character || KeyToAdd.IsEmpty()) return;
+
+	Character->AddKey(KeyToAdd);
+
+	if (bDestroyOnPickup) Destroy();
+}
+
+void AKeyGiverBB::OnProximityBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
+                                          UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep,
+                                          const FHitResult& SweepResult)
+{
+	if (Cast<ACharacterBB>(OtherActor)) RotatingMovement->Activate();
+}
+
+void AKeyGiverBB::OnProximityEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
+                                        UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+{
+	if (!Cast<ACharacterBB>(OtherActor)) return;
+
+	// Someone else might still be in range.
+	TArray<AActor*> StillInRange;
+	ProximitySphere->GetOverlappingActors(StillInRange, ACharacterBB::StaticClass());
+	StillInRange.Remove(OtherActor);
+	if (StillInRange.Num() == 0) RotatingMovement->Deactivate();
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "KeyGiverBB.generated.h"
+
+class UStaticMeshComponent;
+class USphereComponent;
+class URotatingMovementComponent;
+
+/* Gives the player a key when they touch it.
+ * Native version of the KeyGiver blueprint.
+ *
+ * Nothing here ticks while the player is away. The spinning only runs while
+ * the player is inside the (overlap driven) proximity sphere, and picking the
+ * key up is handled by an overlap event, so a level can hold thousands of these
+ * for no per-frame cost. */
+UCLASS()
+class BUILDINGBLOCKS_API AKeyGiverBB : public AActor
+{
+public:
+	AKeyGiverBB();
+
+	// The key added to the player's wallet when they touch this.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Player Key")
+	FString KeyToAdd;
+
+	// Remove the key giver once the key has been taken.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Player Key")
+	bool bDestroyOnPickup = false;
+
+	// How close the player has to be before the key starts spinning.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Player Key", meta=(ClampMin=0, Units="Centimeters"))
+	float SpinRadius = 2000.f;
+
+protected:
+	virtual void BeginPlay() override;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components")
+	TObjectPtr<UStaticMeshComponent> KeyGrantingCube = nullptr;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components")
+	TObjectPtr<USphereComponent> ProximitySphere = nullptr;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components")
+	TObjectPtr<URotatingMovementComponent> RotatingMovement = nullptr;
+
+private:
+	UFUNCTION()
+	void OnKeyOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
+	                  int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+
+	UFUNCTION()
+	void OnProximityBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
+	                             UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep,
+	                             const FHitResult& SweepResult);
+
+	UFUNCTION()
+	void OnProximityEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
+	                           UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
+
+	GENERATED_BODY()
+};
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "KeyLockBB.generated.h"
+
+class ACharacterBB;
+
+UINTERFACE(MinimalAPI)
+class UKeyLockBB : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/* Anything which is opened by a key (doors, platforms, chests...).
+ * Locks register the key they need with UKeyLockIndexSubsystemBB,
+ * and are then told when a character gains or loses that key,
+ * instead of having to keep asking. */
+class BUILDINGBLOCKS_API IKeyLockBB
+{
+public:
+	// A character has just gained (bAdded) or lost the key this lock is registered for.
+	virtual void OnKeyHolderChanged(ACharacterBB* Character, const FString& Key, bool bAdded) = 0;
+
+	GENERATED_BODY()
+};
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "KeyLockIndexSubsystemBB.h"
+
+void UKeyLockIndexSubsystemBB::RegisterLock(const FString& Key, IKeyLockBB* Lock)
+{
+	if (Key.IsEmpty() || !Lock) return;
+
+	LocksByKey.FindOrAdd(Key).AddUnique(TWeakInterfacePtr<IKeyLockBB>(Lock));
+}
+
+void UKeyLockIndexSubsystemBB::UnregisterLock(const FString& Key, IKeyLockBB* Lock)
+{
+	TArray<TWeakInterfacePtr<IKeyLockBB>>* Locks = LocksByKey.Find(Key);
+	if (!Locks) return;
+
+	Locks->RemoveSwap(TWeakInterfacePtr<IKeyLockBB>(Lock));
+	if (Locks->Num() == 0) LocksByKey.Remove(Key);
+}
+
+void UKeyLockIndexSubsystemBB::NotifyKeyChanged(ACharacterBB* Character, const FString& Key, bool bAdded)
+{
+	TArray<TWeakInterfacePtr<IKeyLockBB>>* Locks = LocksByKey.Find(Key);
+	if (!Locks) return;
+
+	// Copy, in case a lock registers or unregisters something while being told.
+	const TArray<TWeakInterfacePtr<IKeyLockBB>> LocksToNotify = *Locks;
+	for (const TWeakInterfacePtr<IKeyLockBB>& Lock : LocksToNotify)
+	{
+		if (IKeyLockBB* LockInterface = Lock.Get())
+			LockInterface->OnKeyHolderChanged(Character, Key, bAdded);
+	}
+}
+
+int32 UKeyLockIndexSubsystemBB::GetNumLocksForKey(const FString& Key) const
+{
+	const TArray<TWeakInterfacePtr<IKeyLockBB>>* Locks = LocksByKey.Find(Key);
+	return Locks ? Locks->Num() : 0;
+}
+
+void UKeyLockIndexSubsystemBB::Deinitialize()
+{
+	LocksByKey.Empty();
+	Super::Deinitialize();
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "KeyLockBB.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/WeakInterfacePtr.h"
+#include "KeyLockIndexSubsystemBB.generated.h"
+
+class ACharacterBB;
+
+/* An index from each key to the locks which need it.
+ * When a character's key wallet changes, only the locks for that key are told about it,
+ * so locks never need to poll the player, and a key change costs nothing
+ * for all the locks which don't care about that key. */
+UCLASS()
+class BUILDINGBLOCKS_API UKeyLockIndexSubsystemBB : public UWorldSubsystem
+{
+public:
+	// Start telling Lock about changes to Key.
+	void RegisterLock(const FString& Key, IKeyLockBB* Lock);
+
+	// Stop telling Lock about changes to Key.
+	void UnregisterLock(const FString& Key, IKeyLockBB* Lock);
+
+	// Called by ACharacterBB when a key is actually added to, or removed from, its wallet.
+	void NotifyKeyChanged(ACharacterBB* Character, const FString& Key, bool bAdded);
+
+	// How many locks are waiting on a given key.
+	UFUNCTION(BlueprintPure, Category="Player|KeyWallet")
+	int32 GetNumLocksForKey(const FString& Key) const;
+
+protected:
+	virtual void Deinitialize() override;
+
+private:
+	TMap<FString, TArray<TWeakInterfacePtr<IKeyLockBB>>> LocksByKey;
+
+	GENERATED_BODY()
+};
@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LockedPlatformBB.h"
+#include "CharacterBB.h"
+#include "KeyLockIndexSubsystemBB.h"
+#include "Components/BoxComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Net/UnrealNetwork.h"
+
+ALockedPlatformBB::ALockedPlatformBB()
+{
+	// Only ticks while the platform is rising.
+	PrimaryActorTick.bCanEverTick          = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	// The platform moves once unlocked.
+	GetStaticMeshComponent()->SetMobility(EComponentMobility::Movable);
+
+	// Only bIsUnlocked replicates, and only once, so it stays dormant until then.
+	bReplicates = true;
+	SetReplicatingMovement(false);
+	NetDormancy = DORM_Initial;
+
+	TestKey = CreateDefaultSubobject<UBoxComponent>(TEXT("TestKey"));
+	TestKey->SetupAttachment(GetStaticMeshComponent());
+	TestKey->SetBoxExtent(FVector(100.f, 100.f, 100.f));
+	TestKey->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	TestKey->SetCollisionResponseToAllChannels(ECR_Ignore);
+	TestKey->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
+	TestKey->SetGenerateOverlapEvents(true);
+}
+
+void ALockedPlatformBB::BeginPlay()
+{
+	Super::BeginPlay();
+
+	StartLocation = GetActorLocation();
+	TestKey->OnComponentBeginOverlap.AddDynamic(this, &ALockedPlatformBB::OnTestKeyOverlap);
+
+	if (UKeyLockIndexSubsystemBB* KeyLockIndex = GetWorld()->GetSubsystem<UKeyLockIndexSubsystemBB>())
+	{
+		RegisteredKey = UnlockKey;
+		KeyLockIndex->RegisterLock(RegisteredKey, this);
+	}
+
+	// Joined after it was unlocked, and heard about it before BeginPlay.
+	if (bIsUnlocked) StartRaising();
+}
+
+void ALockedPlatformBB::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UKeyLockIndexSubsystemBB* KeyLockIndex = GetWorld()->GetSubsystem<UKeyLockIndexSubsystemBB>())
+		KeyLockIndex->UnregisterLock(RegisteredKey, this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ALockedPlatformBB::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ALockedPlatformBB, bIsUnlocked);
+}
+
+void ALockedPlatformBB::OnKeyHolderChanged(ACharacterBB* Character, const FString& Key, bool bAdded)
+{
+	// Only picking the key up matters, and only if they're already in the trigger.
+	// HasKey rather than IsPlayerCarryingKey, this is us looking, not the player trying the key.
+	// Clients only have their own keys, so they wait to hear from the server.
+	if (bIsUnlocked || !bAdded || !Character || !HasAuthority()) return;
+
+	if (TestKey->IsOverlappingActor(Character) && Character->HasKey(UnlockKey)) Unlock();
+}
+
+void ALockedPlatformBB::OnTestKeyOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
+                                         UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep,
+                                         const FHitResult& SweepResult)
+{
+	if (bIsUnlocked || !HasAuthority()) return;
+
+	// The player walking into the trigger IS an attempt to use the key,
+	// so this is one of the few places where the TestKey notification is wanted.
+	if (ACharacterBB* Character = Cast<ACharacterBB>(OtherActor))
+	{
+		if (Character->IsPlayerCarryingKey(UnlockKey)) Unlock();
+	}
+}
+
+void ALockedPlatformBB::Unlock()
+{
+	if (bIsUnlocked || !HasAuthority()) return;
+
+	bIsUnlocked = true;
+	FlushNetDormancy();
+	StartRaising();
+}
+
+void ALockedPlatformBB::OnRep_IsUnlocked()
+{
+	// Before BeginPlay, StartLocation isn't known yet, BeginPlay starts it instead.
+	if (bIsUnlocked && HasActorBegunPlay()) StartRaising();
+}
+
+void ALockedPlatformBB::StartRaising()
+{
+	RaiseElapsed = 0.f;
+	SetActorTickEnabled(true);
+}
+
+void ALockedPlatformBB::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	RaiseElapsed += DeltaTime;
+	const float Alpha = RaiseDuration > 0.f ? FMath::Clamp(RaiseElapsed / RaiseDuration, 0.f, 1.f) : 1.f;
+
+	SetActorLocation(StartLocation + FVector(0.f, 0.f, FMath::InterpEaseInOut(0.f, PlatformHeight, Alpha, 2.f)));
+
+	// Finished rising, go back to costing nothing.
+	if (Alpha >= 1.f) SetActorTickEnabled(false);
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StaticMeshActor.h"
+#include "KeyLockBB.h"
+#include "LockedPlatformBB.generated.h"
+
+class UBoxComponent;
+
+/* A platform which rises when a player carrying the right key walks into its trigger.
+ * Native version of the LockedPlatform blueprint.
+ *
+ * The key check is an overlap event, and the actor only ticks while the platform
+ * is actually moving, so an idle platform costs nothing per frame.
+ * It also registers with UKeyLockIndexSubsystemBB, so a player who picks the key up
+ * while already standing in the trigger still gets the platform, without any polling.
+ *
+ * Only the server has everyone's keys, so only the server decides to unlock. bIsUnlocked replicates,
+ * and every machine raises its own copy of the platform from OnRep_IsUnlocked, so the collision
+ * is the same for everyone without replicating the movement itself. */
+UCLASS()
+class BUILDINGBLOCKS_API ALockedPlatformBB : public AStaticMeshActor, public IKeyLockBB
+{
+public:
+	ALockedPlatformBB();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// The key the player needs to be carrying to raise the platform.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Locked Platform")
+	FString UnlockKey = TEXT("GoldKey");
+
+	// How far the platform rises once unlocked.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Locked Platform", meta=(Units="Centimeters"))
+	float PlatformHeight = 200.f;
+
+	// How long the platform takes to rise.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Locked Platform", meta=(ClampMin=0, Units="Seconds"))
+	float RaiseDuration = 2.f;
+
+	// Has the platform been unlocked yet?
+	UFUNCTION(BlueprintPure, Category="Locked Platform")
+	bool IsUnlocked() const { return bIsUnlocked; }
+
+	// Unlock and raise the platform, regardless of keys. Only does anything on the server.
+	UFUNCTION(BlueprintCallable, Category="Locked Platform")
+	void Unlock();
+
+	// IKeyLockBB
+	virtual void OnKeyHolderChanged(ACharacterBB* Character, const FString& Key, bool bAdded) override;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// The area the player has to walk into with the key.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components")
+	TObjectPtr<UBoxComponent> TestKey = nullptr;
+
+private:
+	UFUNCTION()
+	void OnTestKeyOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
+	                      UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep,
+	                      const FHitResult& SweepResult);
+
+	UFUNCTION()
+	void OnRep_IsUnlocked();
+
+	// Start the platform rising, on whichever machine this is.
+	void StartRaising();
+
+	// The key we registered with the lock index, in case UnlockKey is changed at runtime.
+	FString RegisteredKey;
+
+	UPROPERTY(ReplicatedUsing=OnRep_IsUnlocked)
+	bool bIsUnlocked = false;
+
+	FVector StartLocation;
+	float   RaiseElapsed = 0.f;
+
+	GENERATED_BODY()
+};
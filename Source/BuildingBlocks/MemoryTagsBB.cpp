@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MemoryTagsBB.h"
+#include "CustomLogging.h"
+#include "HAL/IConsoleManager.h"
+
+// Everything else is a child of BuildingBlocks, so LLM reports and Insights group them under it.
+LLM_DEFINE_TAG(BuildingBlocks);
+LLM_DEFINE_TAG(BuildingBlocks_Character, NAME_None, TEXT("BuildingBlocks"));
+LLM_DEFINE_TAG(BuildingBlocks_HudLayouts, NAME_None, TEXT("BuildingBlocks"));
+LLM_DEFINE_TAG(BuildingBlocks_StatBars, NAME_None, TEXT("BuildingBlocks"));
+LLM_DEFINE_TAG(BuildingBlocks_Screenshots, NAME_None, TEXT("BuildingBlocks"));
+
+static FAutoConsoleCommand GMemoryTagsCommand(
+	TEXT("bb.Memory.Tags"),
+	TEXT("Log how much memory is held under each BuildingBlocks LLM tag. Needs -llm on the command line."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+		if (!FLowLevelMemTracker::IsEnabled())
+		{
+			BBLOG(Warning, "LLM is off, run with -llm to get memory tag totals");
+			return;
+		}
+
+		// The totals are only gathered from the other threads once a frame, so bring them up to date first.
+		FLowLevelMemTracker& Tracker = FLowLevelMemTracker::Get();
+		Tracker.UpdateStatsPerFrame();
+
+		const FName Tags[] = {
+			LLM_TAG_NAME(BuildingBlocks_Character),
+			LLM_TAG_NAME(BuildingBlocks_HudLayouts),
+			LLM_TAG_NAME(BuildingBlocks_StatBars),
+			LLM_TAG_NAME(BuildingBlocks_Screenshots)
+		};
+
+		// Display rather than Log, so it makes it into the output of headless runs.
+		int64 TotalBytes = 0;
+		BBLOG(Display, "BuildingBlocks memory by LLM tag (KB):");
+		for (const FName Tag : Tags)
+		{
+			const int64 Bytes = Tracker.GetTagAmountForTracker(ELLMTracker::Default, Tag, ELLMTagSet::None);
+			TotalBytes += Bytes;
+			BBLOG(Display, "  {0}: {1}", Tag, Bytes / 1024);
+		}
+		BBLOG(Display, "  All: {0}, of {1} tracked", TotalBytes / 1024,
+		      Tracker.GetTagAmountForTracker(ELLMTracker::Default, ELLMTag::Total) / 1024);
+#else
+		BBLOG(Warning, "LLM isn't compiled into this build");
+#endif
+	}));
@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+/* Low-Level Memory tracker tags, so what this project allocates can be told apart from the engine in memory reports.
+ * Scope an allocation site with LLM_SCOPE_BYTAG(BuildingBlocks_Character) and so on.
+ * Run with -llm, then look at stat LLMFULL, or log the totals with bb.Memory.Tags. */
+// The parent of all the others. Only scope with it directly for things which don't fit any of them.
+LLM_DECLARE_TAG_API(BuildingBlocks, BUILDINGBLOCKS_API);
+
+// Character stats, key wallets and the key registry, rollback snapshots.
+LLM_DECLARE_TAG_API(BuildingBlocks_Character, BUILDINGBLOCKS_API);
+
+// The HUD layout widgets, and everything created along with them.
+LLM_DECLARE_TAG_API(BuildingBlocks_HudLayouts, BUILDINGBLOCKS_API);
+
+// Stat bar brushes and value text.
+LLM_DECLARE_TAG_API(BuildingBlocks_StatBars, BUILDINGBLOCKS_API);
+
+// Screenshot pixel buffers, and what they're encoded into.
+LLM_DECLARE_TAG_API(BuildingBlocks_Screenshots, BUILDINGBLOCKS_API);
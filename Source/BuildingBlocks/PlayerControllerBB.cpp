@@ -1,29 +1,27 @@
 ﻿// Fill out your copyright notice in the Description page of Project Settings.
 #include "PlayerControllerBB.h"
 #include "CharacterBB.h"
+#include "CustomLogging.h"
+#include "StatLatencyBB.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
-#include "HudBB.h"
-#include "IImageWrapper.h"
-#include "IImageWrapperModule.h"
 #include "GameFramework/GameModeBase.h"
 #include "Kismet/GameplayStatics.h"
+#include "Kismet/KismetSystemLibrary.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CsvProfiler.h"
 
-class IImageWrapper;
+CSV_DEFINE_CATEGORY(BuildingBlocksReplay, true);
 
-void APlayerControllerBBBase::OnPossess(APawn* aPawn)
+void APlayerControllerBBBase::SetupInputComponent()
 {
-	// Call the parent method, to let it do anything it needs to
-	Super::OnPossess(aPawn);
-
-	// Store a reference to the HUD
-	PlayerHud = Cast<AHudBB>(GetHUD());
-	checkf(PlayerHud, TEXT("Unable to get reference to the HUD"));
+	// Call the parent method, which creates the InputComponent
+	Super::SetupInputComponent();
 
-	// Store a reference to the Player's Pawn
-	PlayerCharacter = Cast<ACharacterBB>(aPawn);
-	checkf(PlayerCharacter,
-	       TEXT("APlayerControllerBBBase derived classes should only posess ACharacterBBBase derived pawns"));
+	// Only called for local players, on whichever machine the player is actually sat at,
+	// so unlike OnPossess this also runs on remote clients. (A dedicated server never gets here)
 
 	// Get a reference to the EnhancedInputComponent
 	EnhancedInputComponent = Cast<UEnhancedInputComponent>(InputComponent);
@@ -44,6 +42,7 @@ void APlayerControllerBBBase::OnPossess(APawn* aPawn)
 
 	// Bind the input actions.
 	// Only attempt to bind if valid values were provided.
+	// The handlers all check PlayerCharacter, as input can arrive before the pawn has replicated.
 	if (ActionMove)
 		EnhancedInputComponent->BindAction(ActionMove, ETriggerEvent::Triggered, this,
 		                                   &APlayerControllerBBBase::HandleMove);
@@ -72,24 +71,52 @@ void APlayerControllerBBBase::OnPossess(APawn* aPawn)
 		EnhancedInputComponent->BindAction(ActionCycleUIMode, ETriggerEvent::Triggered, this,
 		                                   &APlayerControllerBBBase::HandleCycleUIMode);
 
-
-	GEngine->GameViewport->OnScreenshotCaptured().AddUObject(this, &APlayerControllerBBBase::AcceptScreenshot);
+	// Screenshots are saved by UScreenshotSubsystemBB, which binds to the viewport once for the whole game.
 }
 
-void APlayerControllerBBBase::OnUnPossess()
+void APlayerControllerBBBase::SetPawn(APawn* InPawn)
 {
-	// Unbind things here...
-	EnhancedInputComponent->ClearActionBindings();
+	// Call the parent method, to let it do anything it needs to
+	Super::SetPawn(InPawn);
+
+	// Called from Possess on the server, and from OnRep_Pawn on clients, so both keep track of the pawn.
+	ACharacterBB* NewCharacter = Cast<ACharacterBB>(InPawn);
+	if (InPawn && !NewCharacter)
+	{
+		BBLOG(Warning, "APlayerControllerBBBase derived classes should only possess ACharacterBB derived pawns, "
+		      "not {0}", InPawn->GetName());
+	}
+
+	if (NewCharacter == PlayerCharacter) return;
 
-	// Call the parent method, in case it needs to do anything.
-	Super::OnUnPossess();
+	// Anything left over was meant for the old pawn.
+	PlayerCharacter = NewCharacter;
+	CoalescedInput.Reset();
+	OnPlayerCharacterChanged.Broadcast(PlayerCharacter);
+
+	// Build machines start a replay as soon as there is a character to drive.
+	FString ReplayFileName;
+	if (PlayerCharacter && IsLocalController() && !bIsReplayingInput &&
+		FParse::Value(FCommandLine::Get(), TEXT("BBReplay="), ReplayFileName))
+	{
+		StartInputReplay(ReplayFileName);
+	}
 }
 
 void APlayerControllerBBBase::HandleLook(const FInputActionValue& InputActionValue)
 {
+	RecordInput(EInputActionBB::Look, InputActionValue);
+
 	// Input is a Vector2D
 	const FVector2D LookAxisVector = InputActionValue.Get<FVector2D>();
 
+	if (bCoalesceLookAndMove)
+	{
+		CoalescedInput.LookDelta += LookAxisVector;
+		CoalescedInput.bHasLook   = true;
+		return;
+	}
+
 	// Add yaw and pitch input to controller
 	AddYawInput(LookAxisVector.X);
 	AddPitchInput(LookAxisVector.Y);
@@ -97,9 +124,17 @@ void APlayerControllerBBBase::HandleLook(const FInputActionValue& InputActionVal
 
 void APlayerControllerBBBase::HandleMove(const FInputActionValue& InputActionValue)
 {
+	RecordInput(EInputActionBB::Move, InputActionValue);
+
 	// Value is a Vector2D
 	const FVector2D MovementVector = InputActionValue.Get<FVector2D>();
 
+	if (bCoalesceLookAndMove)
+	{
+		CoalescedInput.AddMove(MovementVector);
+		return;
+	}
+
 	// Add movement to the Player's Character Pawn
 	if (PlayerCharacter)
 	{
@@ -110,6 +145,9 @@ void APlayerControllerBBBase::HandleMove(const FInputActionValue& InputActionVal
 
 void APlayerControllerBBBase::HandleJump()
 {
+	RecordInput(EInputActionBB::Jump, FInputActionValue(true));
+	const FInputLatencyScopeBB LatencyScope(EInputActionBB::Jump);
+
 	// Input is 'Digital' (value not used here)
 	// Make the Player's Character Pawn jump, disabling crouch if it was active
 	if (PlayerCharacter)
@@ -121,17 +159,28 @@ void APlayerControllerBBBase::HandleJump()
 
 void APlayerControllerBBBase::HandlePsiBlast()
 {
+	RecordInput(EInputActionBB::PsiBlast, FInputActionValue(true));
+	const FInputLatencyScopeBB LatencyScope(EInputActionBB::PsiBlast);
+
 	if (PlayerCharacter) PlayerCharacter->PsiBlast();
 }
 
 void APlayerControllerBBBase::HandleToggleSprint()
 {
+	RecordInput(EInputActionBB::ToggleSprint, FInputActionValue(true));
+	const FInputLatencyScopeBB LatencyScope(EInputActionBB::ToggleSprint);
+
 	if (PlayerCharacter) PlayerCharacter->ToggleRunning();
 }
 
 void APlayerControllerBBBase::HandleToggleCrouch()
 {
-	if (PlayerCharacter && PlayerCharacter->bIsCrouched)
+	RecordInput(EInputActionBB::ToggleCrouch, FInputActionValue(true));
+	const FInputLatencyScopeBB LatencyScope(EInputActionBB::ToggleCrouch);
+
+	if (!PlayerCharacter) return;
+
+	if (PlayerCharacter->bIsCrouched)
 		PlayerCharacter->UnCrouch();
 	else
 		PlayerCharacter->Crouch();
@@ -139,28 +188,199 @@ void APlayerControllerBBBase::HandleToggleCrouch()
 
 void APlayerControllerBBBase::HandleCycleUIMode()
 {
-	if (PlayerHud)
-		PlayerHud->CycleToNextViewMode();
+	RecordInput(EInputActionBB::CycleUIMode, FInputActionValue(true));
+	const FInputLatencyScopeBB LatencyScope(EInputActionBB::CycleUIMode);
+
+	OnCycleUIModeRequested.Broadcast();
 }
 
-void APlayerControllerBBBase::AcceptScreenshot(int Width, int Height, const TArray<FColor>& Colors)
+void APlayerControllerBBBase::PostProcessInput(const float DeltaTime, const bool bGamePaused)
 {
-	static int32 Index = 0;
+	// Live input has just been handled, and the view rotation hasn't been updated from it yet,
+	// so anything added here still counts for this frame.
+	Super::PostProcessInput(DeltaTime, bGamePaused);
 
-	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(
-		FName("ImageWrapper"));
-	TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+	// Replayed input goes in at the same point live input did when it was recorded
+	if (bIsReplayingInput)
+	{
+		// Game time is fixed during the replay, so measure real time for the stats.
+		const double Now        = FPlatformTime::Seconds();
+		ReplayWorstFrameSeconds = FMath::Max(ReplayWorstFrameSeconds, static_cast<float>(Now - ReplayLastFrameSeconds));
+		ReplayLastFrameSeconds  = Now;
+		TraceReplayFrame();
+		ReplayInput();
+	}
 
-	// Provide image wrapper with raw pixels (TArray<FColor>)
-	ImageWrapper->SetRaw(&Colors[0], Colors.Num() * sizeof(FColor), Width, Height, ERGBFormat::BGRA, 8);
+	// After the replay, which goes through the same handlers.
+	ApplyCoalescedInput();
 
-	FString SaveLoc = FString::Printf(TEXT("F:\\Work\\Projects\\YetiGame\\SS_%d.png"), Index);
-	Index++;
+	if (bIsRecordingInput || bIsReplayingInput) ++InputFrame;
+}
 
-	AsyncTask(ENamedThreads::AnyHiPriThreadNormalTask, [ImageWrapper,SaveLoc]()
+void APlayerControllerBBBase::ApplyCoalescedInput()
+{
+	if (CoalescedInput.bHasLook)
 	{
-		// Get the image using 90% JPEG compression
-		const TArray64<uint8> CompressedImage = ImageWrapper->GetCompressed(90);
-		FFileHelper::SaveArrayToFile(CompressedImage, *SaveLoc);
-	});
+		AddYawInput(CoalescedInput.LookDelta.X);
+		AddPitchInput(CoalescedInput.LookDelta.Y);
+	}
+
+	// One movement input in the combined direction, so the character only checks stamina and running once.
+	if (CoalescedInput.HasMove() && PlayerCharacter)
+	{
+		const FVector2D MovementVector = CoalescedInput.GetMove();
+		PlayerCharacter->AddMovementInput(PlayerCharacter->GetActorForwardVector() * MovementVector.Y +
+		                                  PlayerCharacter->GetActorRightVector() * MovementVector.X);
+	}
+
+	CoalescedInput.Reset();
+}
+
+void APlayerControllerBBBase::StartInputRecording(const FString& FileName)
+{
+	if (bIsReplayingInput) return;
+
+	InputRecording.Events.Reset();
+	InputRecordingFileName = FPaths::Combine(FPaths::ProjectSavedDir(), FileName);
+	InputFrame             = 0;
+	bIsRecordingInput      = true;
+
+	// The replay steps through the recording a frame at a time,
+	// so the recording has to be made with the same fixed step for the two to line up.
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(InputRecording.FixedDeltaTime);
+
+	BBLOG(Log, "Recording input to {0}", InputRecordingFileName);
+}
+
+void APlayerControllerBBBase::StopInputRecording()
+{
+	if (!bIsRecordingInput) return;
+
+	bIsRecordingInput = false;
+	FApp::SetUseFixedTimeStep(false);
+
+	if (InputRecording.SaveToFile(InputRecordingFileName))
+		BBLOG(Log, "Saved {0} input events over {1} frames to {2}",
+		      InputRecording.Events.Num(), InputFrame, InputRecordingFileName);
+	else
+		BBLOG(Error, "Failed to save input recording to {0}", InputRecordingFileName);
+}
+
+void APlayerControllerBBBase::StartInputReplay(const FString& FileName)
+{
+	StopInputRecording();
+
+	const FString FullFileName = FPaths::IsRelative(FileName)
+		                             ? FPaths::Combine(FPaths::ProjectSavedDir(), FileName)
+		                             : FileName;
+	if (!InputRecording.LoadFromFile(FullFileName))
+	{
+		BBLOG(Error, "Unable to load input recording {0}", FullFileName);
+		return;
+	}
+
+	// Stop live input getting mixed in with the replay
+	if (UEnhancedInputLocalPlayerSubsystem* InputSubsystem =
+		ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(GetLocalPlayer()))
+		InputSubsystem->ClearAllMappings();
+
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(InputRecording.FixedDeltaTime);
+
+	InputFrame               = 0;
+	ReplayCursor             = 0;
+	ReplayStartSeconds       = FPlatformTime::Seconds();
+	ReplayLastFrameSeconds   = ReplayStartSeconds;
+	ReplayWorstFrameSeconds  = 0.f;
+	ReplayStartWidgetUpdates = FStatLatencyTrackerBB::Get().GetNumWidgetUpdates();
+	ReplayLastWidgetUpdates  = ReplayStartWidgetUpdates;
+	bIsReplayingInput        = true;
+
+#if CSV_PROFILER
+	// Everything the CSV profiler tracks, for every frame of the replay, so two builds can be diffed.
+	FCsvProfiler::Get()->BeginCapture(-1, FString(), FPaths::GetBaseFilename(FullFileName) + TEXT(".csv"));
+#endif
+
+	BBLOG(Log, "Replaying {0} input events from {1}", InputRecording.Events.Num(), FullFileName);
+}
+
+void APlayerControllerBBBase::RecordInput(EInputActionBB Action, const FInputActionValue& Value)
+{
+	if (bIsRecordingInput)
+		InputRecording.Events.Add({InputFrame, Action, Value});
+}
+
+void APlayerControllerBBBase::ReplayInput()
+{
+	const TArray<FRecordedInputBB>& Events = InputRecording.Events;
+
+	while (Events.IsValidIndex(ReplayCursor) && Events[ReplayCursor].Frame == InputFrame)
+	{
+		const FRecordedInputBB& Event = Events[ReplayCursor++];
+		switch (Event.Action)
+		{
+		case EInputActionBB::Move: HandleMove(Event.Value);
+			break;
+		case EInputActionBB::Look: HandleLook(Event.Value);
+			break;
+		case EInputActionBB::Jump: HandleJump();
+			break;
+		case EInputActionBB::PsiBlast: HandlePsiBlast();
+			break;
+		case EInputActionBB::ToggleSprint: HandleToggleSprint();
+			break;
+		case EInputActionBB::ToggleCrouch: HandleToggleCrouch();
+			break;
+		case EInputActionBB::CycleUIMode: HandleCycleUIMode();
+			break;
+		default: ;
+		}
+	}
+
+	if (!Events.IsValidIndex(ReplayCursor)) FinishInputReplay();
+}
+
+void APlayerControllerBBBase::TraceReplayFrame()
+{
+	// Updates since the last frame, i.e. the ones the last frame's input caused.
+	const uint64 NumWidgetUpdates = FStatLatencyTrackerBB::Get().GetNumWidgetUpdates();
+	CSV_CUSTOM_STAT(BuildingBlocksReplay, HudUpdates, static_cast<int32>(NumWidgetUpdates - ReplayLastWidgetUpdates),
+	                ECsvCustomStatOp::Set);
+	ReplayLastWidgetUpdates = NumWidgetUpdates;
+
+	if (!PlayerCharacter) return;
+
+	const FCharacterSimStateBB& State = PlayerCharacter->GetSimState();
+	CSV_CUSTOM_STAT(BuildingBlocksReplay, Health, State.CurrentHealth, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(BuildingBlocksReplay, Stamina, State.CurrentStamina, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(BuildingBlocksReplay, PsiPower, State.CurrentPsiPower, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(BuildingBlocksReplay, Keys, State.Keys.Num(), ECsvCustomStatOp::Set);
+}
+
+void APlayerControllerBBBase::FinishInputReplay()
+{
+	bIsReplayingInput = false;
+	FApp::SetUseFixedTimeStep(false);
+
+	// Put live input back
+	if (UEnhancedInputLocalPlayerSubsystem* InputSubsystem =
+		ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(GetLocalPlayer()))
+	{
+		InputSubsystem->ClearAllMappings();
+		if (InputMappingContent) InputSubsystem->AddMappingContext(InputMappingContent, 0);
+	}
+
+	const double ElapsedSeconds = FPlatformTime::Seconds() - ReplayStartSeconds;
+	const uint64 NumHudUpdates  = FStatLatencyTrackerBB::Get().GetNumWidgetUpdates() - ReplayStartWidgetUpdates;
+	BBLOG(Log, "Replay finished: {0} frames in {1}s, average frame {2}ms, worst frame {3}ms, {4} HUD updates",
+	      InputFrame, ElapsedSeconds, InputFrame > 0 ? ElapsedSeconds * 1000.0 / InputFrame : 0.0,
+	      ReplayWorstFrameSeconds * 1000.f, NumHudUpdates);
+
+#if CSV_PROFILER
+	FCsvProfiler::Get()->EndCapture();
+#endif
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("BBReplayExit")))
+		UKismetSystemLibrary::QuitGame(this, this, EQuitPreference::Quit, false);
 }
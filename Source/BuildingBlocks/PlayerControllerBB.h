@@ -4,6 +4,7 @@
 #include "CoreMinimal.h"
 #include "InputAction.h"
 #include "InputActionValue.h"
+#include "InputRecordingBB.h"
 #include "GameFramework/PlayerController.h"
 #include "PlayerControllerBB.generated.h"
 
@@ -11,10 +12,44 @@
 class UEnhancedInputComponent;
 class ACharacterBB;
 class UInputMappingContext;
-class AHudBB;
+
+// Delegate for when the player asks for the next UI mode.
+// The HUD lives in the client-only UI module, so it listens for this rather than the controller calling it.
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FCycleUIModeRequested);
+
+// Delegate for when the controller gets a different character, or loses it (NewCharacter is null then).
+// On clients the pawn replicates in some time after the controller and HUD exist, so this is how they find out.
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FPlayerCharacterChanged, ACharacterBB*, NewCharacter);
+
+// Look and move triggers since the last frame, so they can be applied all at once.
+struct FCoalescedInputBB
+{
+	// Look values are deltas, so they just add up.
+	FVector2D LookDelta = FVector2D::ZeroVector;
+	bool      bHasLook  = false;
+
+	// Move values are how far the stick is pushed, so they're averaged over the frame instead.
+	// Enhanced Input only triggers once per frame per action, and has no device timestamps to give,
+	// so each value counts the same.
+	void AddMove(const FVector2D& Value)
+	{
+		MoveTotal += Value;
+		++NumMoves;
+	}
+
+	FVector2D GetMove() const { return NumMoves > 0 ? MoveTotal / NumMoves : FVector2D::ZeroVector; }
+
+	bool HasMove() const { return NumMoves > 0; }
+
+	void Reset() { *this = FCoalescedInputBB(); }
+
+private:
+	FVector2D MoveTotal = FVector2D::ZeroVector;
+	int32     NumMoves  = 0;
+};
 
 UCLASS(Abstract)
-class APlayerControllerBBBase : public APlayerController
+class BUILDINGBLOCKS_API APlayerControllerBBBase : public APlayerController
 {
 public:
 	// The Input Action to map to movement.
@@ -49,6 +84,41 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Player Input|Character Movement")
 	TObjectPtr<UInputMappingContext> InputMappingContent = nullptr;
 
+	// Add up look and move triggers, and apply them once a frame, rather than as each one comes in.
+	// Saves a lot of small calls into the character with high polling rate mice and pads.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Player Input|Coalescing")
+	bool bCoalesceLookAndMove = true;
+
+	// Triggered when the player uses the cycle UI mode action.
+	UPROPERTY(BlueprintAssignable, Category="Player Input|UI")
+	FCycleUIModeRequested OnCycleUIModeRequested;
+
+	// Triggered when the controlled character changes, on the server and the owning client.
+	UPROPERTY(BlueprintAssignable, Category="Player Input")
+	FPlayerCharacterChanged OnPlayerCharacterChanged;
+
+	// The character being controlled, null until it has possessed (or, on clients, replicated) one.
+	ACharacterBB* GetPlayerCharacter() const { return PlayerCharacter; }
+
+	virtual void SetPawn(APawn* InPawn) override;
+
+	// Start recording every input action to FileName (relative to the project's Saved directory).
+	// Runs the game at a fixed timestep, so the recording can be replayed exactly.
+	UFUNCTION(Exec, BlueprintCallable, Category="Player Input|Recording")
+	void StartInputRecording(const FString& FileName = TEXT("InputRecording.bbir"));
+
+	// Stop recording, and write the recording to disk.
+	UFUNCTION(Exec, BlueprintCallable, Category="Player Input|Recording")
+	void StopInputRecording();
+
+	// Replay a recording made by StartInputRecording, ignoring any live input until it finishes.
+	// Can also be started from the command line with -BBReplay=<FileName>,
+	// add -BBReplayExit to quit once the replay is done (for build machines).
+	// Where the CSV profiler is compiled in, the replay is captured to Saved/Profiling/CSV/<FileName>.csv,
+	// with frame times, every CSV stat, and the character's stats and HUD updates for each frame.
+	UFUNCTION(Exec, BlueprintCallable, Category="Player Input|Recording")
+	void StartInputReplay(const FString& FileName = TEXT("InputRecording.bbir"));
+
 protected:
 	// Action Handler Functions
 	void HandleLook(const FInputActionValue& InputActionValue);
@@ -59,10 +129,24 @@ protected:
 	void HandleToggleCrouch();
 	void HandleCycleUIMode();
 
+	// Record (if recording) an input action which is about to be handled.
+	void RecordInput(EInputActionBB Action, const FInputActionValue& Value);
+
+	// Feed any replayed input for this frame into the handlers.
+	void ReplayInput();
+
+	// Add this frame's character stats and HUD updates to the replay's CSV capture.
+	void TraceReplayFrame();
+
+	// Called when the replay runs out of input.
+	void FinishInputReplay();
+
+	// Apply this frame's look and move, as one call each.
+	// Called from PostProcessInput, after the input handlers and before the rotation input is used.
+	void ApplyCoalescedInput();
 
-	void         AcceptScreenshot(int Width, int Height, const TArray<FColor>& Colors);
-	virtual void OnPossess(APawn* aPawn) override;
-	virtual void OnUnPossess() override;
+	virtual void PostProcessInput(const float DeltaTime, const bool bGamePaused) override;
+	virtual void SetupInputComponent() override;
 
 private:
 	// Used to store a reference to the InputComponent cast to an EnhancedInputComponent.
@@ -73,10 +157,30 @@ private:
 	UPROPERTY()
 	TObjectPtr<ACharacterBB> PlayerCharacter = nullptr;
 
-	// Used to store a reference to the pawn we are controlling.
-	UPROPERTY()
-	TObjectPtr<AHudBB> PlayerHud = nullptr;
 
+	// Look and move waiting for ApplyCoalescedInput.
+	FCoalescedInputBB CoalescedInput;
+
+	// Input recording and replay
+	FInputRecordingBB InputRecording;
+	FString           InputRecordingFileName;
+	bool              bIsRecordingInput = false;
+	bool              bIsReplayingInput = false;
+
+	// Frames since the recording or replay started.
+	uint32 InputFrame = 0;
+
+	// The next event in the recording to replay.
+	int32 ReplayCursor = 0;
+
+	// Frame time stats for the replay, so builds can be compared.
+	double ReplayStartSeconds      = 0.0;
+	double ReplayLastFrameSeconds  = 0.0;
+	float  ReplayWorstFrameSeconds = 0.f;
+
+	// Stat bar redraws (see FStatLatencyTrackerBB::GetNumWidgetUpdates) when the replay started, and last frame.
+	uint64 ReplayStartWidgetUpdates = 0;
+	uint64 ReplayLastWidgetUpdates  = 0;
 
 	GENERATED_BODY()
 };
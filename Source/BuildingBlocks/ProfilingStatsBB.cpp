@@ -0,0 +1,8 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ProfilingStatsBB.h"
+
+DEFINE_STAT(STAT_CharacterStatsBB);
+
+uint64 FStatCostScopeBB::TotalCycles = 0;
+uint64 FStatCostScopeBB::NumUpdates  = 0;
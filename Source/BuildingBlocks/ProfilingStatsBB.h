@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+// 'stat BuildingBlocks' on screen, and the same scopes show up in Insights.
+DECLARE_STATS_GROUP(TEXT("BuildingBlocks"), STATGROUP_BuildingBlocks, STATCAT_Advanced);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Character stats"), STAT_CharacterStatsBB, STATGROUP_BuildingBlocks, BUILDINGBLOCKS_API);
+
+// Adds up the time spent updating character stats, so the stress test summary has it even without stats compiled in.
+// Game thread only.
+struct BUILDINGBLOCKS_API FStatCostScopeBB
+{
+	FStatCostScopeBB() : StartCycles(FPlatformTime::Cycles64()) {}
+
+	~FStatCostScopeBB()
+	{
+		TotalCycles += FPlatformTime::Cycles64() - StartCycles;
+		++NumUpdates;
+	}
+
+	static uint64 TotalCycles;
+	static uint64 NumUpdates;
+
+private:
+	uint64 StartCycles;
+};
@@ -6,7 +6,7 @@
 #include "Logging/StructuredLog.h"
 
 /* Custom log category so that related messages can be filtered */
-DECLARE_LOG_CATEGORY_EXTERN(BBLog, Log, All);
+BUILDINGBLOCKS_API DECLARE_LOG_CATEGORY_EXTERN(BBLog, Log, All);
 
 
 
@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/* A curve over 0..1 baked into evenly spaced samples, so evaluating it is a lookup and a lerp.
+ * Only needs Core, so BuildingBlocksTests can run the stat rules without an engine or a project.
+ * UStatRegenCurvesBB does the baking. */
+struct FRegenTableBB
+{
+	static constexpr int32 NumSamples = 65;
+
+	// Flat at 1, i.e. the base rate.
+	FRegenTableBB()
+	{
+		for (float& Sample : Samples)
+		{
+			Sample = 1.f;
+		}
+	}
+
+	// For characters which don't have any curves.
+	static const FRegenTableBB& GetFlat()
+	{
+		static const FRegenTableBB FlatTable;
+		return FlatTable;
+	}
+
+	float Evaluate(float Alpha) const
+	{
+		const float Position = FMath::Clamp(Alpha, 0.f, 1.f) * (NumSamples - 1);
+		const int32 Index    = FMath::Min(static_cast<int32>(Position), NumSamples - 2);
+		return FMath::Lerp(Samples[Index], Samples[Index + 1], Position - Index);
+	}
+
+	float Samples[NumSamples];
+};
@@ -0,0 +1,282 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ReplicationGraphBB.h"
+#include "CustomLogging.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/Info.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "ReplicationGraphTypes.h"
+#include "UObject/UObjectIterator.h"
+
+// Server cost of replication, across every replication graph, since the last reset.
+static struct FReplicationCostBB
+{
+	int64  Frames           = 0;
+	int64  ConnectionFrames = 0;
+	double TotalSeconds     = 0.0;
+	double WorstSeconds     = 0.0;
+	int32  PeakConnections  = 0;
+} GReplicationCost;
+
+static FAutoConsoleCommand GReplicationReportCommand(
+	TEXT("bb.Net.Report"),
+	TEXT("Log the server CPU spent replicating, per frame and per connection. Compare with 'stat net' without the graph."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (GReplicationCost.Frames == 0)
+		{
+			BBLOG(Log, "No replication frames with connected clients yet");
+			return;
+		}
+
+		BBLOG(Log, "Replication graph, {0} frames, up to {1} connections:", GReplicationCost.Frames,
+		      GReplicationCost.PeakConnections);
+		BBLOG(Log, "  Per frame:      {0} ms average, {1} ms worst",
+		      GReplicationCost.TotalSeconds * 1000.0 / GReplicationCost.Frames, GReplicationCost.WorstSeconds * 1000.0);
+		BBLOG(Log, "  Per connection: {0} us per frame",
+		      GReplicationCost.TotalSeconds * 1e6 / FMath::Max<int64>(1, GReplicationCost.ConnectionFrames));
+	}));
+
+static FAutoConsoleCommand GReplicationResetCommand(
+	TEXT("bb.Net.Reset"),
+	TEXT("Start measuring replication cost again, e.g. once every client has connected."),
+	FConsoleCommandDelegate::CreateLambda([]() { GReplicationCost = FReplicationCostBB(); }));
+
+void UReplicationGraphBB::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	// Take the cull distance and update rate of every native replicated class from its defaults.
+	// Blueprint classes pick up the settings of their native parent.
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		UClass* Class = *It;
+		if (!Class->IsChildOf(AActor::StaticClass()) || !Class->HasAnyClassFlags(CLASS_Native) ||
+			Class->HasAnyClassFlags(CLASS_Abstract))
+			continue;
+
+		const AActor* Defaults = GetDefault<AActor>(Class);
+		if (!Defaults->GetIsReplicated()) continue;
+
+		// Only the grid culls by distance, everything else would ignore it.
+		FClassReplicationInfo ClassInfo;
+		ClassInfo.DistancePriorityScale   = 1.f;
+		ClassInfo.StarvationPriorityScale = 1.f;
+		if (GetRoute(Defaults) == ERouteBB::GridDynamic)
+			ClassInfo.SetCullDistanceSquared(Defaults->NetCullDistanceSquared);
+
+		// NetUpdateFrequency is in updates a second, the graph wants server frames between updates.
+		const float ServerTickRate = NetDriver ? NetDriver->GetNetServerMaxTickRate() : 30.f;
+		const float UpdateRate     = FMath::Max(Defaults->NetUpdateFrequency, 0.01f);
+		const int32 PeriodFrames   = FMath::RoundToInt(ServerTickRate / UpdateRate);
+		ClassInfo.ReplicationPeriodFrame = static_cast<decltype(ClassInfo.ReplicationPeriodFrame)>(
+			FMath::Clamp(PeriodFrames, 1, 255));
+
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+	}
+}
+
+void UReplicationGraphBB::InitGlobalGraphNodes()
+{
+	// Both zones start at every frame, so whatever is right next to the viewer (their own pawn, for one)
+	// is never slowed down, whichever way it counts as facing.
+	using FSpatializationZone = UReplicationGraphNode_DynamicSpatialFrequency::FSpatializationZone;
+	const uint32 FrontPeriod  = FMath::Max(1, FrontPeriodFrames);
+	const uint32 BehindPeriod = FMath::Max(1, BehindPeriodFrames);
+	SpatialFrequencyZones.Reset();
+	SpatialFrequencyZones.Add(FSpatializationZone(0.707f, 0.f, 1.f, 1, FrontPeriod, 1, FrontPeriod));    // In view
+	SpatialFrequencyZones.Add(FSpatializationZone(-1.f, 0.f, 1.f, 1, BehindPeriod, 1, BehindPeriod)); // Everything else
+	SpatialFrequencySettings = UReplicationGraphNode_DynamicSpatialFrequency::FSettings(
+		SpatialFrequencyZones, SpatialFrequencyZones,
+		UReplicationGraphNode_DynamicSpatialFrequency::DefaultSettings.MaxBitsPerFrame);
+
+	GridNode              = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize    = GridCellSize;
+	GridNode->SpatialBias = GridSpatialBias;
+
+	// Each cell only looks at the actors in it, so the frequency is only worked out for the characters
+	// near a connection, rather than every character for every connection.
+	GridNode->CreateCellNodeOverride = [this](UReplicationGraphNode_GridSpatialization2D* Parent)
+	{
+		UReplicationGraphNode_GridCell* Cell = Parent->CreateChildNode<UReplicationGraphNode_GridCell>();
+		Cell->CreateDynamicNodeOverride = [this](UReplicationGraphNode_GridCell* CellParent)
+		{
+			UReplicationGraphNode_DynamicSpatialFrequency* Node =
+				CellParent->CreateChildNode<UReplicationGraphNode_DynamicSpatialFrequency>();
+			Node->Settings = &SpatialFrequencySettings;
+			return Node;
+		};
+		return Cell;
+	};
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UReplicationGraphBB::InitConnectionGraphNodes(UNetReplicationGraphConnection* ConnectionManager)
+{
+	Super::InitConnectionGraphNodes(ConnectionManager);
+
+	UReplicationGraphNode_OwnerRelevantBB* OwnerNode = CreateNewNode<UReplicationGraphNode_OwnerRelevantBB>();
+	AddConnectionGraphNode(OwnerNode, ConnectionManager);
+	OwnerNodes.Add(ConnectionManager->NetConnection, OwnerNode);
+}
+
+void UReplicationGraphBB::RemoveClientConnection(UNetConnection* NetConnection)
+{
+	// Anything it owned waits in the pending list, in case it's given to someone else.
+	TObjectPtr<UReplicationGraphNode_OwnerRelevantBB> OwnerNode;
+	if (OwnerNodes.RemoveAndCopyValue(NetConnection, OwnerNode)) OwnerNode->TakeOwnerOnlyActors(PendingOwnerOnlyActors);
+
+	Super::RemoveClientConnection(NetConnection);
+}
+
+void UReplicationGraphBB::AddOwnerOnlyActor(AActor* Actor)
+{
+	if (const TObjectPtr<UReplicationGraphNode_OwnerRelevantBB>* OwnerNode = OwnerNodes.Find(Actor->GetNetConnection()))
+		(*OwnerNode)->NotifyAddNetworkActor(FNewReplicatedActorInfo(Actor));
+	else
+		PendingOwnerOnlyActors.AddUnique(Actor);
+}
+
+void UReplicationGraphBB::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo,
+                                                      FGlobalActorReplicationInfo& GlobalInfo)
+{
+	switch (GetRoute(ActorInfo.Actor))
+	{
+	case ERouteBB::OwnerOnly:
+		AddOwnerOnlyActor(ActorInfo.Actor);
+		break;
+	case ERouteBB::AlwaysRelevant:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+	case ERouteBB::GridDynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+	case ERouteBB::GridStatic:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+	}
+}
+
+void UReplicationGraphBB::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	switch (GetRoute(ActorInfo.Actor))
+	{
+	case ERouteBB::OwnerOnly:
+		// Its owner may have changed since, so try them all. Only happens once per actor, not every frame.
+		if (PendingOwnerOnlyActors.RemoveSwap(ActorInfo.Actor) > 0) break;
+		for (const TPair<TObjectPtr<UNetConnection>, TObjectPtr<UReplicationGraphNode_OwnerRelevantBB>>& Pair :
+		     OwnerNodes)
+		{
+			if (Pair.Value->NotifyRemoveNetworkActor(ActorInfo, false)) break;
+		}
+		break;
+	case ERouteBB::AlwaysRelevant:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+	case ERouteBB::GridDynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+	case ERouteBB::GridStatic:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+	}
+}
+
+int32 UReplicationGraphBB::ServerReplicateActors(float DeltaSeconds)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	// Try again for anything which didn't have an owner yet.
+	if (PendingOwnerOnlyActors.Num() > 0)
+	{
+		const TArray<AActor*> Pending = MoveTemp(PendingOwnerOnlyActors);
+		PendingOwnerOnlyActors.Reset();
+		for (AActor* Actor : Pending) AddOwnerOnlyActor(Actor);
+	}
+
+	const int32  Result       = Super::ServerReplicateActors(DeltaSeconds);
+	const double Seconds      = FPlatformTime::Seconds() - StartSeconds;
+
+	const int32 NumConnections = NetDriver ? NetDriver->ClientConnections.Num() : 0;
+	if (NumConnections > 0)
+	{
+		++GReplicationCost.Frames;
+		GReplicationCost.ConnectionFrames += NumConnections;
+		GReplicationCost.TotalSeconds += Seconds;
+		GReplicationCost.WorstSeconds    = FMath::Max(GReplicationCost.WorstSeconds, Seconds);
+		GReplicationCost.PeakConnections = FMath::Max(GReplicationCost.PeakConnections, NumConnections);
+	}
+
+	return Result;
+}
+
+UReplicationGraphBB::ERouteBB UReplicationGraphBB::GetRoute(const AActor* Actor)
+{
+	// Must give the same answer when the actor is removed as when it was added,
+	// so only look at things which don't change over an actor's life.
+	if (Actor->bOnlyRelevantToOwner) return ERouteBB::OwnerOnly;
+	if (Actor->bAlwaysRelevant || Actor->IsA<AInfo>()) return ERouteBB::AlwaysRelevant;
+	if (Actor->IsA<APawn>() || Actor->IsReplicatingMovement()) return ERouteBB::GridDynamic;
+	return ERouteBB::GridStatic;
+}
+
+void UReplicationGraphNode_OwnerRelevantBB::NotifyAddNetworkActor(const FNewReplicatedActorInfo& Actor)
+{
+	if (!OwnerOnlyActors.Contains(Actor.Actor)) OwnerOnlyActors.Add(Actor.Actor);
+}
+
+bool UReplicationGraphNode_OwnerRelevantBB::NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& Actor,
+                                                                     bool bWarnIfNotFound)
+{
+	return OwnerOnlyActors.RemoveFast(Actor.Actor);
+}
+
+void UReplicationGraphNode_OwnerRelevantBB::TakeOwnerOnlyActors(TArray<AActor*>& OutActors)
+{
+	for (AActor* Actor : OwnerOnlyActors) OutActors.AddUnique(Actor);
+	OwnerOnlyActors.Reset();
+}
+
+void UReplicationGraphNode_OwnerRelevantBB::NotifyResetAllNetworkActors()
+{
+	OwnerActors.Reset();
+	OwnerOnlyActors.Reset();
+}
+
+void UReplicationGraphNode_OwnerRelevantBB::GatherActorListsForConnection(
+	const FConnectionGatherActorListParameters& Params)
+{
+	// Rebuilt every frame, as the pawn can change (respawning, possessing something else...)
+	// The controller is usually owner only as well, so it's already in the other list.
+	OwnerActors.Reset();
+	for (const FNetViewer& Viewer : Params.Viewers)
+	{
+		if (Viewer.InViewer && !OwnerActors.Contains(Viewer.InViewer) && !OwnerOnlyActors.Contains(Viewer.InViewer))
+			OwnerActors.Add(Viewer.InViewer);
+
+		if (const APlayerController* Controller = Cast<APlayerController>(Viewer.InViewer))
+		{
+			if (APawn* Pawn = Controller->GetPawn(); Pawn && !OwnerActors.Contains(Pawn)) OwnerActors.Add(Pawn);
+		}
+	}
+
+	// Anything which has changed owner goes back to the graph, to be given to its new owner's node.
+	TArray<AActor*, TInlineAllocator<4>> ChangedOwner;
+	for (AActor* Actor : OwnerOnlyActors)
+	{
+		if (Actor->GetNetConnection() != Params.ConnectionManager.NetConnection) ChangedOwner.Add(Actor);
+	}
+	for (AActor* Actor : ChangedOwner)
+	{
+		OwnerOnlyActors.RemoveFast(Actor);
+		GetTypedOuter<UReplicationGraphBB>()->AddOwnerOnlyActor(Actor);
+	}
+
+	if (OwnerActors.Num() > 0) Params.OutGatheredReplicationLists.AddReplicationActorList(OwnerActors);
+	if (OwnerOnlyActors.Num() > 0) Params.OutGatheredReplicationLists.AddReplicationActorList(OwnerOnlyActors);
+}
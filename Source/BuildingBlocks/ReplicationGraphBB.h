@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "ReplicationGraphBB.generated.h"
+
+class UReplicationGraphNode_GridSpatialization2D;
+class UReplicationGraphNode_ActorList;
+class UReplicationGraphNode_OwnerRelevantBB;
+
+/* The project's replication graph, set as the IpNetDriver's ReplicationDriverClassName in DefaultEngine.ini.
+ *
+ * The default net driver asks every replicated actor whether it is relevant to every connection, every frame.
+ * Instead, this puts characters into a 2D grid, so each connection only looks at the cells around it,
+ * and the per-connection cost stays flat as the number of characters grows.
+ *  - ACharacterBB (and anything else which moves) goes in the grid.
+ *  - Info actors (game state, player states) go to everyone.
+ *  - Each connection always gets its own controller and pawn, whatever the grid thinks,
+ *    which is where the owner only stats and key wallet ride.
+ *  - Actors only relevant to their owner go to their owner's connection, and nowhere else.
+ *  - The grid cells hand moving actors to the engine's UReplicationGraphNode_DynamicSpatialFrequency,
+ *    so characters further from a connection, or behind it, replicate less often.
+ *
+ * To try it, PIE with Net Mode 'Play As Client' and a few players.
+ * For the 64+ client measurement, run a dedicated server and connect clients with -nullrhi,
+ * then use bb.Net.Report on the server. */
+UCLASS(Transient, Config=Engine)
+class BUILDINGBLOCKS_API UReplicationGraphBB : public UReplicationGraph
+{
+public:
+	// Size of a grid cell, and where the grid starts. Should comfortably cover the playable area.
+	UPROPERTY(Config)
+	float GridCellSize = 10000.f;
+
+	UPROPERTY(Config)
+	FVector2D GridSpatialBias = FVector2D(-200000.f, -200000.f);
+
+	// Moving actors replicate every frame close up, slowing down to every FrontPeriodFrames frames
+	// at their cull distance in front of the viewer, and every BehindPeriodFrames frames behind it.
+	UPROPERTY(Config)
+	int32 FrontPeriodFrames = 3;
+
+	UPROPERTY(Config)
+	int32 BehindPeriodFrames = 10;
+
+	// Give an actor which is only relevant to its owner to its owner's connection,
+	// or keep it until it has one (they often get their owner just after they are added).
+	void AddOwnerOnlyActor(AActor* Actor);
+
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* ConnectionManager) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo,
+	                                         FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+	virtual void RemoveClientConnection(UNetConnection* NetConnection) override;
+
+private:
+	enum class ERouteBB : uint8
+	{
+		OwnerOnly,     // Relevant to its owner only, their connection's owner node handles it.
+		AlwaysRelevant,
+		GridDynamic,   // Moves, so the grid re-checks its cell every frame.
+		GridStatic     // Stays put, and may go dormant.
+	};
+
+	static ERouteBB GetRoute(const AActor* Actor);
+
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_GridSpatialization2D> GridNode = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_ActorList> AlwaysRelevantNode = nullptr;
+
+	// Each connection's owner node, so owner only actors can be handed straight to theirs.
+	UPROPERTY()
+	TMap<TObjectPtr<UNetConnection>, TObjectPtr<UReplicationGraphNode_OwnerRelevantBB>> OwnerNodes;
+
+	// Owner only actors which don't have an owning connection yet.
+	TArray<AActor*> PendingOwnerOnlyActors;
+
+	// What every grid cell's UReplicationGraphNode_DynamicSpatialFrequency uses, built from the config above.
+	TArray<UReplicationGraphNode_DynamicSpatialFrequency::FSpatializationZone> SpatialFrequencyZones;
+	UReplicationGraphNode_DynamicSpatialFrequency::FSettings                   SpatialFrequencySettings;
+
+	GENERATED_BODY()
+};
+
+/* Always replicates each connection's own controller and pawn to it,
+ * along with the actors only relevant to it which the graph has handed it. */
+UCLASS()
+class BUILDINGBLOCKS_API UReplicationGraphNode_OwnerRelevantBB : public UReplicationGraphNode
+{
+public:
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& Actor) override;
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& Actor, bool bWarnIfNotFound = true) override;
+	virtual void NotifyResetAllNetworkActors() override;
+
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+	// Move the owner only actors out, when the connection goes away.
+	void TakeOwnerOnlyActors(TArray<AActor*>& OutActors);
+
+private:
+	// The connection's controller and pawn, rebuilt every frame.
+	FActorRepListRefView OwnerActors;
+
+	// Actors only relevant to this connection.
+	FActorRepListRefView OwnerOnlyActors;
+
+	GENERATED_BODY()
+};
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Summaries of measured samples, shared by everything which reports them (the balance commandlet,
+// the input latency tracker, the HUD benchmark), so their p95s all mean the same thing.
+struct FSampleStatsBB
+{
+	// Nearest rank: the smallest sample with at least Fraction of the samples at or below it.
+	// Sorted must already be sorted, smallest first.
+	static float GetPercentile(const TArray<float>& Sorted, float Fraction)
+	{
+		if (Sorted.Num() == 0) return 0.f;
+		return Sorted[FMath::Clamp(FMath::CeilToInt(Fraction * Sorted.Num()) - 1, 0, Sorted.Num() - 1)];
+	}
+
+	static float GetAverage(const TArray<float>& Values)
+	{
+		double Total = 0.0;
+		for (const float Value : Values) Total += Value;
+		return Values.Num() > 0 ? static_cast<float>(Total / Values.Num()) : 0.f;
+	}
+};
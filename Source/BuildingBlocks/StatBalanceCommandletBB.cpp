@@ -0,0 +1,298 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "StatBalanceCommandletBB.h"
+#include "CharacterSimStateBB.h"
+#include "CustomLogging.h"
+#include "SampleStatsBB.h"
+#include "StatRegenCurvesBB.h"
+#include "StatRulesBB.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+// A scripted player. Every update it rolls for what to do.
+struct FBehaviourProfileBB
+{
+	const TCHAR* Name;
+
+	// Chances per update
+	float RunChance;
+	float JumpChance;
+	float BlastChance;
+
+	// Once out of stamina, crouch until it's back to this fraction of the max. 0 to carry straight on.
+	float RestUntil;
+
+	// As if there were timed effects on the agent the whole time.
+	float StaminaRegenBonus;
+	float DamagePerSecond;
+	float PsiDrainPerSecond;
+};
+
+static const FBehaviourProfileBB GBehaviourProfiles[] =
+{
+	// Name              Run    Jump   Blast  RestUntil  Regen  Damage  PsiDrain
+	{TEXT("Stroller"),  0.10f, 0.02f, 0.01f, 0.00f,     0.0f,  0.0f,   0.0f},
+	{TEXT("Sprinter"),  0.90f, 0.05f, 0.02f, 0.00f,     0.0f,  0.0f,   0.0f},
+	{TEXT("Hopper"),    0.30f, 0.40f, 0.02f, 0.50f,     0.0f,  0.0f,   0.0f},
+	{TEXT("Caster"),    0.30f, 0.05f, 0.50f, 0.30f,     0.0f,  0.0f,   0.0f},
+	{TEXT("Brawler"),   0.60f, 0.20f, 0.20f, 0.50f,     0.0f,  0.0f,   0.0f},
+	{TEXT("Buffed"),    0.60f, 0.20f, 0.20f, 0.50f,     0.5f,  0.0f,   0.0f},
+	{TEXT("UnderFire"), 0.60f, 0.20f, 0.20f, 0.50f,     0.0f,  0.5f,   5.0f},
+};
+
+// What gets measured for every agent.
+enum class EBalanceMetricBB : uint8
+{
+	// Seconds until stamina first runs out
+	TimeToExhaustion,
+	// Of the whole run
+	ExhaustedPercent,
+	// Average seconds from running out of stamina to having enough to jump again
+	RecoverySeconds,
+	JumpsPerMinute,
+	BlastsPerMinute,
+	// Blasts wanted but not affordable
+	DeniedBlastsPerMinute,
+	// Seconds until health runs out
+	TimeToDeath,
+	Count
+};
+
+static const TCHAR* GBalanceMetricNames[] =
+{
+	TEXT("TimeToExhaustion"),
+	TEXT("ExhaustedPercent"),
+	TEXT("RecoverySeconds"),
+	TEXT("JumpsPerMinute"),
+	TEXT("BlastsPerMinute"),
+	TEXT("DeniedBlastsPerMinute"),
+	TEXT("TimeToDeath"),
+};
+
+static_assert(UE_ARRAY_COUNT(GBalanceMetricNames) == static_cast<int32>(EBalanceMetricBB::Count),
+              "Every metric needs a name");
+
+static constexpr int32 NumBalanceMetrics = static_cast<int32>(EBalanceMetricBB::Count);
+
+// Play out one agent, writing its metrics to OutMetrics.
+// Things which never happen (running out of stamina, dying) are recorded as the length of the run.
+static void SimulateAgent(const FBehaviourProfileBB& Profile, const FStatTuningBB& Tuning,
+                          const FStatModifiersBB& Modifiers, int32 NumUpdates, int32 Seed, float* OutMetrics)
+{
+	FRandomStream Random(Seed);
+
+	FCharacterSimStateBB State;
+	State.CurrentStamina  = Tuning.MaxStamina;
+	State.CurrentPsiPower = Tuning.MaxPsiPower;
+
+	bool  bResting         = false;
+	int32 FirstExhaustion  = INDEX_NONE;
+	int32 Death            = INDEX_NONE;
+	int32 ExhaustedUpdates = 0;
+	int32 RecoveryStart    = INDEX_NONE;
+	int32 RecoveryUpdates  = 0;
+	int32 NumRecoveries    = 0;
+	int32 NumJumps         = 0;
+	int32 NumBlasts        = 0;
+	int32 NumDeniedBlasts  = 0;
+
+	for (int32 Update = 1; Update <= NumUpdates; ++Update)
+	{
+		// The same checks ACharacterBB makes on input: running stops without stamina,
+		// jumping needs enough for the jump, and crouching stops running.
+		State.bIsCrouched = bResting;
+		State.bIsRunning  = !bResting && Random.FRand() < Profile.RunChance && FStatRulesBB::CanRun(State);
+		State.bHasRan     = State.bIsRunning;
+
+		if (!bResting && Random.FRand() < Profile.JumpChance && FStatRulesBB::CanJump(State, Tuning))
+		{
+			State.bHasJumped = true;
+			++NumJumps;
+		}
+
+		if (Random.FRand() < Profile.BlastChance)
+		{
+			if (FStatRulesBB::TryPsiBlast(State, Tuning)) ++NumBlasts;
+			else ++NumDeniedBlasts;
+		}
+
+		const int32 DamageDue = FStatRulesBB::Step(State, Tuning, Modifiers, FStatRulesBB::UpdateInterval);
+		if (DamageDue > 0) FStatRulesBB::ApplyHealthDelta(State, -DamageDue);
+
+		if (State.CurrentStamina <= 0.f)
+		{
+			++ExhaustedUpdates;
+			if (FirstExhaustion == INDEX_NONE) FirstExhaustion = Update;
+			if (RecoveryStart == INDEX_NONE) RecoveryStart = Update;
+			bResting = Profile.RestUntil > 0.f;
+		}
+		else if (bResting && State.CurrentStamina >= Profile.RestUntil * Tuning.MaxStamina)
+		{
+			bResting = false;
+		}
+
+		if (RecoveryStart != INDEX_NONE && FStatRulesBB::CanJump(State, Tuning))
+		{
+			RecoveryUpdates += Update - RecoveryStart;
+			++NumRecoveries;
+			RecoveryStart = INDEX_NONE;
+		}
+
+		if (Death == INDEX_NONE && State.CurrentHealth <= 0) Death = Update;
+	}
+
+	const float Minutes   = NumUpdates * FStatRulesBB::UpdateInterval / 60.f;
+	auto        ToSeconds = [NumUpdates](int32 Updates)
+	{
+		return (Updates == INDEX_NONE ? NumUpdates : Updates) * FStatRulesBB::UpdateInterval;
+	};
+
+	OutMetrics[static_cast<int32>(EBalanceMetricBB::TimeToExhaustion)] = ToSeconds(FirstExhaustion);
+	OutMetrics[static_cast<int32>(EBalanceMetricBB::ExhaustedPercent)] = 100.f * ExhaustedUpdates / NumUpdates;
+	OutMetrics[static_cast<int32>(EBalanceMetricBB::RecoverySeconds)]  =
+		NumRecoveries > 0 ? RecoveryUpdates * FStatRulesBB::UpdateInterval / NumRecoveries : 0.f;
+	OutMetrics[static_cast<int32>(EBalanceMetricBB::JumpsPerMinute)]        = NumJumps / Minutes;
+	OutMetrics[static_cast<int32>(EBalanceMetricBB::BlastsPerMinute)]       = NumBlasts / Minutes;
+	OutMetrics[static_cast<int32>(EBalanceMetricBB::DeniedBlastsPerMinute)] = NumDeniedBlasts / Minutes;
+	OutMetrics[static_cast<int32>(EBalanceMetricBB::TimeToDeath)]           = ToSeconds(Death);
+}
+
+UStatBalanceCommandletBB::UStatBalanceCommandletBB()
+{
+	IsClient     = false;
+	IsServer     = false;
+	IsEditor     = false;
+	LogToConsole = true;
+}
+
+int32 UStatBalanceCommandletBB::Main(const FString& Params)
+{
+	int32   NumAgents = 10000;
+	float   Seconds   = 600.f;
+	int32   Seed      = 1234;
+	FString ProfileList;
+	FString CurvesPath;
+	FString FileName = FPaths::ProjectSavedDir() / TEXT("StatBalance.csv");
+
+	FParse::Value(*Params, TEXT("Agents="), NumAgents);
+	FParse::Value(*Params, TEXT("Seconds="), Seconds);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("Profiles="), ProfileList);
+	FParse::Value(*Params, TEXT("Curves="), CurvesPath);
+	FParse::Value(*Params, TEXT("Output="), FileName);
+	NumAgents = FMath::Max(1, NumAgents);
+
+	const int32 NumUpdates = FMath::Max(1, FMath::RoundToInt(Seconds / FStatRulesBB::UpdateInterval));
+
+	FStatTuningBB Tuning;
+	FParse::Value(*Params, TEXT("MaxStamina="), Tuning.MaxStamina);
+	FParse::Value(*Params, TEXT("JumpStaminaCost="), Tuning.JumpStaminaCost);
+	FParse::Value(*Params, TEXT("RunStaminaCost="), Tuning.RunStaminaCost);
+	FParse::Value(*Params, TEXT("RestStaminaRebate="), Tuning.RestStaminaRebate);
+	FParse::Value(*Params, TEXT("MaxPsiPower="), Tuning.MaxPsiPower);
+	FParse::Value(*Params, TEXT("PsiRechargeRate="), Tuning.PsiRechargeRate);
+	FParse::Value(*Params, TEXT("PsiBlastCost="), Tuning.PsiBlastCost);
+
+	const UStatRegenCurvesBB* Curves = nullptr;
+	if (!CurvesPath.IsEmpty())
+	{
+		Curves = LoadObject<UStatRegenCurvesBB>(nullptr, *CurvesPath);
+		if (!Curves)
+		{
+			BBLOG(Error, "Couldn't load regen curves {0}", CurvesPath);
+			return 1;
+		}
+	}
+
+	TArray<FString> WantedProfiles;
+	ProfileList.ParseIntoArray(WantedProfiles, TEXT(","));
+
+	BBLOG(Display, "Stat balance: {0} agents per profile, {1} s each ({2} updates)", NumAgents,
+	      NumUpdates * FStatRulesBB::UpdateInterval, NumUpdates);
+	BBLOG(Display, "  Stamina: max {0}, jump {1}, run {2}, rest {3}", Tuning.MaxStamina, Tuning.JumpStaminaCost,
+	      Tuning.RunStaminaCost, Tuning.RestStaminaRebate);
+	BBLOG(Display, "  Psi power: max {0}, recharge {1}, blast {2}", Tuning.MaxPsiPower, Tuning.PsiRechargeRate,
+	      Tuning.PsiBlastCost);
+
+	FString      Csv       = TEXT("Profile,Metric,Agents,Mean,P5,P25,P50,P75,P95,Max\n");
+	int32        NumRun    = 0;
+	const double StartTime = FPlatformTime::Seconds();
+
+	// One agent's metrics after another.
+	TArray<float> Metrics;
+	TArray<float> Sorted;
+
+	for (int32 ProfileIndex = 0; ProfileIndex < UE_ARRAY_COUNT(GBehaviourProfiles); ++ProfileIndex)
+	{
+		const FBehaviourProfileBB& Profile = GBehaviourProfiles[ProfileIndex];
+		if (WantedProfiles.Num() > 0 && !WantedProfiles.Contains(Profile.Name)) continue;
+
+		FStatModifiersBB Modifiers;
+		Modifiers.StaminaRegenBonus = Profile.StaminaRegenBonus;
+		Modifiers.DamagePerSecond   = Profile.DamagePerSecond;
+		Modifiers.PsiDrainPerSecond = Profile.PsiDrainPerSecond;
+		Modifiers.StaminaRegenTable = Curves ? &Curves->GetStaminaTable() : nullptr;
+		Modifiers.PsiRegenTable     = Curves ? &Curves->GetPsiTable() : nullptr;
+
+		Metrics.SetNumUninitialized(NumAgents * NumBalanceMetrics);
+
+		// Agents are cheap, so hand them out in batches to keep the scheduling overhead down.
+		constexpr int32 AgentsPerBatch = 256;
+		const int32     NumBatches     = FMath::DivideAndRoundUp(NumAgents, AgentsPerBatch);
+		ParallelFor(NumBatches, [&](int32 BatchIndex)
+		{
+			const int32 FirstAgent = BatchIndex * AgentsPerBatch;
+			const int32 EndAgent   = FMath::Min(FirstAgent + AgentsPerBatch, NumAgents);
+			for (int32 Agent = FirstAgent; Agent < EndAgent; ++Agent)
+			{
+				const int32 AgentSeed = static_cast<int32>(HashCombine(GetTypeHash(Seed),
+				                                                       GetTypeHash(ProfileIndex * NumAgents + Agent)));
+				SimulateAgent(Profile, Tuning, Modifiers, NumUpdates, AgentSeed, &Metrics[Agent * NumBalanceMetrics]);
+			}
+		});
+
+		for (int32 MetricIndex = 0; MetricIndex < NumBalanceMetrics; ++MetricIndex)
+		{
+			Sorted.Reset(NumAgents);
+			for (int32 Agent = 0; Agent < NumAgents; ++Agent)
+			{
+				Sorted.Add(Metrics[Agent * NumBalanceMetrics + MetricIndex]);
+			}
+			Sorted.Sort();
+
+			const float Mean = FSampleStatsBB::GetAverage(Sorted);
+			const float P5   = FSampleStatsBB::GetPercentile(Sorted, 0.05f);
+			const float P25  = FSampleStatsBB::GetPercentile(Sorted, 0.25f);
+			const float P50  = FSampleStatsBB::GetPercentile(Sorted, 0.5f);
+			const float P75  = FSampleStatsBB::GetPercentile(Sorted, 0.75f);
+			const float P95  = FSampleStatsBB::GetPercentile(Sorted, 0.95f);
+			Csv.Appendf(TEXT("%s,%s,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n"), Profile.Name,
+			            GBalanceMetricNames[MetricIndex], NumAgents, Mean, P5, P25, P50, P75, P95, Sorted.Last());
+			BBLOG(Display, "{0} {1}: mean {2}, p5 {3}, p50 {4}, p95 {5}", Profile.Name,
+			      GBalanceMetricNames[MetricIndex], Mean, P5, P50, P95);
+		}
+
+		++NumRun;
+	}
+
+	if (NumRun == 0)
+	{
+		BBLOG(Error, "No profiles matched {0}", ProfileList);
+		return 1;
+	}
+
+	const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+	const double AgentSeconds   = static_cast<double>(NumRun) * NumAgents * NumUpdates * FStatRulesBB::UpdateInterval;
+	BBLOG(Display, "Simulated {0} agent-seconds in {1} s ({2} agent-seconds per second)", AgentSeconds,
+	      ElapsedSeconds, AgentSeconds / FMath::Max(ElapsedSeconds, 1e-6));
+
+	if (!FFileHelper::SaveStringToFile(Csv, *FileName))
+	{
+		BBLOG(Error, "Failed to write stat balance to {0}", FileName);
+		return 1;
+	}
+
+	BBLOG(Display, "Stat balance written to {0}", FileName);
+	return 0;
+}
@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "StatBalanceCommandletBB.generated.h"
+
+/* Plays out lots of scripted players' stats, with no world or actors, to see how a balance change feels
+ * without having to play it.
+ *
+ * Each behaviour profile (sprinting everywhere, spamming psi blasts, etc.) gets a crowd of agents,
+ * which roll for what to do every update and run it through FStatRulesBB, the same rules as ACharacterBB.
+ * The agents are independent, so they're spread across every core. Each agent has its own random seed,
+ * so the results are the same however the work gets split up.
+ *
+ * The distributions across each crowd (time to exhaustion, blasts per minute, etc.) are logged,
+ * and written to a CSV file.
+ *
+ * UnrealEditor-Cmd BuildingBlocks.uproject -run=StatBalanceCommandletBB
+ *   -Agents=10000           Agents per profile
+ *   -Seconds=600            Simulated time per agent
+ *   -Seed=1234
+ *   -Profiles=Sprinter,...  Only these profiles, default all
+ *   -Curves=/Game/...       A UStatRegenCurvesBB to use, default flat
+ *   -Output=...             default Saved/StatBalance.csv
+ * and any FStatTuningBB value to try instead of the default, e.g. -JumpStaminaCost=30 */
+UCLASS()
+class BUILDINGBLOCKS_API UStatBalanceCommandletBB : public UCommandlet
+{
+public:
+	UStatBalanceCommandletBB();
+
+	virtual int32 Main(const FString& Params) override;
+
+	GENERATED_BODY()
+};
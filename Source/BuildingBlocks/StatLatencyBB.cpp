@@ -0,0 +1,216 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "StatLatencyBB.h"
+#include "CustomLogging.h"
+#include "SampleStatsBB.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+static int32 GStatLatencyEnabled = 0;
+static FAutoConsoleVariableRef CVarStatLatencyEnabled(
+	TEXT("bb.Latency.Enable"),
+	GStatLatencyEnabled,
+	TEXT("Measure the time from an input action to the HUD showing the stat it changed."));
+
+static float GStatLatencyMaxPendingSeconds = 1.f;
+static FAutoConsoleVariableRef CVarStatLatencyMaxPendingSeconds(
+	TEXT("bb.Latency.MaxPendingSeconds"),
+	GStatLatencyMaxPendingSeconds,
+	TEXT("How long an input waits for the stat it changed to be broadcast before it is dropped, in seconds."));
+
+static FAutoConsoleCommand GStatLatencyReportCommand(
+	TEXT("bb.Latency.Report"),
+	TEXT("Log input to HUD latency percentiles for each input action."),
+	FConsoleCommandDelegate::CreateLambda([]() { FStatLatencyTrackerBB::Get().Report(); }));
+
+static FAutoConsoleCommandWithArgs GStatLatencyExportCommand(
+	TEXT("bb.Latency.Export"),
+	TEXT("Write input to HUD latency percentiles to a CSV file. Arguments: [FileName]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FStatLatencyTrackerBB::Get().ExportCsv(
+			Args.Num() > 0 ? Args[0] : FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("InputLatency.csv")));
+	}));
+
+static FAutoConsoleCommand GStatLatencyResetCommand(
+	TEXT("bb.Latency.Reset"),
+	TEXT("Throw away all input to HUD latency samples."),
+	FConsoleCommandDelegate::CreateLambda([]() { FStatLatencyTrackerBB::Get().Reset(); }));
+
+static const TCHAR* GetInputActionName(EInputActionBB Action)
+{
+	switch (Action)
+	{
+	case EInputActionBB::Move: return TEXT("Move");
+	case EInputActionBB::Look: return TEXT("Look");
+	case EInputActionBB::Jump: return TEXT("Jump");
+	case EInputActionBB::PsiBlast: return TEXT("PsiBlast");
+	case EInputActionBB::ToggleSprint: return TEXT("ToggleSprint");
+	case EInputActionBB::ToggleCrouch: return TEXT("ToggleCrouch");
+	case EInputActionBB::CycleUIMode: return TEXT("CycleUIMode");
+	default: return TEXT("Unknown");
+	}
+}
+
+FStatLatencyTrackerBB& FStatLatencyTrackerBB::Get()
+{
+	static FStatLatencyTrackerBB Tracker;
+	return Tracker;
+}
+
+void FStatLatencyTrackerBB::BeginInput(EInputActionBB Action)
+{
+	if (!GStatLatencyEnabled) return;
+
+	CurrentInput.Action  = Action;
+	CurrentInput.Seconds = FPlatformTime::Seconds();
+}
+
+void FStatLatencyTrackerBB::EndInput()
+{
+	CurrentInput = FInputStamp();
+}
+
+void FStatLatencyTrackerBB::TagStat(const UObject* Owner, EStatTypeBB Stat)
+{
+	if (!CurrentInput.IsSet() || !Owner) return;
+
+	// At most once every MaxPendingSeconds, so it costs next to nothing.
+	if (CurrentInput.Seconds >= NextExpirySeconds)
+	{
+		RemoveExpired(CurrentInput.Seconds);
+		NextExpirySeconds = CurrentInput.Seconds + GStatLatencyMaxPendingSeconds;
+	}
+
+	// Keep the oldest input which hasn't reached the HUD yet, that's the one the player is waiting on.
+	// Unless it has been waiting so long that it was never going to.
+	FInputStamp& Pending = PendingByOwner.FindOrAdd(FObjectKey(Owner)).ByStat[static_cast<int32>(Stat)];
+	if (!Pending.IsSet() || CurrentInput.Seconds - Pending.Seconds > GStatLatencyMaxPendingSeconds)
+		Pending = CurrentInput;
+}
+
+void FStatLatencyTrackerBB::EndStatUpdate(const UObject* Owner)
+{
+	// Nearly always empty, so this is just a failed lookup.
+	if (PendingByOwner.Num() > 0) PendingByOwner.Remove(FObjectKey(Owner));
+}
+
+void FStatLatencyTrackerBB::RemoveOwner(const UObject* Owner)
+{
+	if (PendingByOwner.Num() > 0) PendingByOwner.Remove(FObjectKey(Owner));
+}
+
+void FStatLatencyTrackerBB::RemoveExpired(double NowSeconds)
+{
+	for (auto It = PendingByOwner.CreateIterator(); It; ++It)
+	{
+		bool bAnyLeft = false;
+		for (FInputStamp& Stamp : It.Value().ByStat)
+		{
+			if (Stamp.IsSet() && NowSeconds - Stamp.Seconds > GStatLatencyMaxPendingSeconds) Stamp = FInputStamp();
+			bAnyLeft |= Stamp.IsSet();
+		}
+
+		if (!bAnyLeft) It.RemoveCurrent();
+	}
+}
+
+void FStatLatencyTrackerBB::BeginBroadcast(const UObject* Owner, EStatTypeBB Stat)
+{
+	ActiveBroadcast = FInputStamp();
+	if (PendingByOwner.Num() == 0) return;
+
+	const FObjectKey OwnerKey(Owner);
+	FPendingStamps*  PendingStamps = PendingByOwner.Find(OwnerKey);
+	if (!PendingStamps) return;
+
+	FInputStamp& Pending = PendingStamps->ByStat[static_cast<int32>(Stat)];
+	if (Pending.IsSet() && FPlatformTime::Seconds() - Pending.Seconds <= GStatLatencyMaxPendingSeconds)
+		ActiveBroadcast = Pending;
+	Pending = FInputStamp();
+
+	for (const FInputStamp& Stamp : PendingStamps->ByStat)
+	{
+		if (Stamp.IsSet()) return;
+	}
+	PendingByOwner.Remove(OwnerKey);
+}
+
+void FStatLatencyTrackerBB::EndBroadcast()
+{
+	ActiveBroadcast = FInputStamp();
+}
+
+void FStatLatencyTrackerBB::OnWidgetUpdated()
+{
+	++NumWidgetUpdates;
+	if (!ActiveBroadcast.IsSet()) return;
+
+	const float LatencyMs = static_cast<float>((FPlatformTime::Seconds() - ActiveBroadcast.Seconds) * 1000.0);
+	SamplesByAction[static_cast<int32>(ActiveBroadcast.Action)].Add(LatencyMs);
+
+	// Only the first bar to show the change counts.
+	ActiveBroadcast = FInputStamp();
+}
+
+void FStatLatencyTrackerBB::FSamples::Add(float Value)
+{
+	if (Values.Num() < MaxSamples)
+		Values.Add(Value);
+	else
+		Values[Next] = Value;
+
+	Next = (Next + 1) % MaxSamples;
+	++Total;
+}
+
+void FStatLatencyTrackerBB::Report() const
+{
+	BBLOG(Log, "Input to HUD latency (ms){0}", GStatLatencyEnabled ? TEXT("") : TEXT(" - bb.Latency.Enable is off"));
+	for (int32 ActionIndex = 0; ActionIndex < static_cast<int32>(EInputActionBB::Count); ++ActionIndex)
+	{
+		const FSamples& Samples = SamplesByAction[ActionIndex];
+		if (Samples.Values.Num() == 0) continue;
+
+		TArray<float> Sorted = Samples.Values;
+		Sorted.Sort();
+		BBLOG(Log, "  {0}: samples {1}, p50 {2}, p95 {3}, p99 {4}, max {5}",
+		      GetInputActionName(static_cast<EInputActionBB>(ActionIndex)), Samples.Total,
+		      FSampleStatsBB::GetPercentile(Sorted, 0.5f), FSampleStatsBB::GetPercentile(Sorted, 0.95f),
+		      FSampleStatsBB::GetPercentile(Sorted, 0.99f), Sorted.Last());
+	}
+}
+
+bool FStatLatencyTrackerBB::ExportCsv(const FString& FileName) const
+{
+	FString Csv = TEXT("Action,Samples,P50Ms,P95Ms,P99Ms,MaxMs\n");
+	for (int32 ActionIndex = 0; ActionIndex < static_cast<int32>(EInputActionBB::Count); ++ActionIndex)
+	{
+		const FSamples& Samples = SamplesByAction[ActionIndex];
+		if (Samples.Values.Num() == 0) continue;
+
+		TArray<float> Sorted = Samples.Values;
+		Sorted.Sort();
+		Csv.Appendf(TEXT("%s,%d,%.3f,%.3f,%.3f,%.3f\n"),
+		            GetInputActionName(static_cast<EInputActionBB>(ActionIndex)), Samples.Total,
+		            FSampleStatsBB::GetPercentile(Sorted, 0.5f), FSampleStatsBB::GetPercentile(Sorted, 0.95f),
+		            FSampleStatsBB::GetPercentile(Sorted, 0.99f), Sorted.Last());
+	}
+
+	const bool bSaved = FFileHelper::SaveStringToFile(Csv, *FileName);
+	if (bSaved)
+		BBLOG(Log, "Input latency written to {0}", FileName);
+	else
+		BBLOG(Error, "Failed to write input latency to {0}", FileName);
+	return bSaved;
+}
+
+void FStatLatencyTrackerBB::Reset()
+{
+	for (FSamples& Samples : SamplesByAction)
+	{
+		Samples = FSamples();
+	}
+	PendingByOwner.Reset();
+}
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InputRecordingBB.h"
+#include "UObject/ObjectKey.h"
+
+// The character stats which have a bar on the HUD.
+enum class EStatTypeBB : uint8
+{
+	Health,
+	Stamina,
+	PsiPower,
+
+	Count
+};
+
+/* Measures how long it takes from an input action being handled to the HUD bar
+ * showing the stat change it caused.
+ *
+ * The timestamp travels like this (all on the game thread):
+ * - The controller opens an FInputLatencyScopeBB around each input handler.
+ * - Anything in the character which changes a stat because of that input calls TagStat,
+ *   which parks the timestamp against that character's stat until it is next broadcast.
+ * - The character opens an FStatBroadcastScopeBB around each stat broadcast,
+ *   which makes its parked timestamp the 'active' one.
+ * - UStatBarBase::UpdateWidget calls OnWidgetUpdated, which records the latency.
+ *
+ * Not every input ends up changing a stat, so stamps don't wait forever: the server drops a character's
+ * stamps after any stat update which didn't broadcast them (EndStatUpdate), and on clients, which wait on
+ * the server, they expire after bb.Latency.MaxPendingSeconds, and are swept out when new ones are tagged.
+ * A character's stamps also go when it leaves play (RemoveOwner).
+ *
+ * Off by default, turn on with bb.Latency.Enable 1.
+ * Results with bb.Latency.Report, bb.Latency.Export [FileName] and bb.Latency.Reset. */
+class BUILDINGBLOCKS_API FStatLatencyTrackerBB
+{
+public:
+	static FStatLatencyTrackerBB& Get();
+
+	void BeginInput(EInputActionBB Action);
+	void EndInput();
+
+	// One of Owner's stats has been changed by the input currently being handled (if any).
+	void TagStat(const UObject* Owner, EStatTypeBB Stat);
+
+	// Owner's stats have been updated, so anything still parked against them isn't going to be broadcast.
+	void EndStatUpdate(const UObject* Owner);
+
+	// Owner is going away, so nothing parked against it ever will be broadcast.
+	void RemoveOwner(const UObject* Owner);
+
+	void BeginBroadcast(const UObject* Owner, EStatTypeBB Stat);
+	void EndBroadcast();
+
+	// A bar has been redrawn, in response to the active broadcast (if any).
+	void OnWidgetUpdated();
+
+	// Every bar redraw so far, counted whether or not bb.Latency.Enable is on. Input replays trace it.
+	uint64 GetNumWidgetUpdates() const { return NumWidgetUpdates; }
+
+	void Report() const;
+	bool ExportCsv(const FString& FileName) const;
+	void Reset();
+
+private:
+	struct FInputStamp
+	{
+		EInputActionBB Action  = EInputActionBB::Count;
+		double         Seconds = 0.0;
+
+		bool IsSet() const { return Action != EInputActionBB::Count; }
+	};
+
+	// Latency samples (in ms) for one action. Only the most recent MaxSamples are kept.
+	struct FSamples
+	{
+		static constexpr int32 MaxSamples = 4096;
+
+		TArray<float> Values;
+		int32         Next  = 0;
+		int32         Total = 0;
+
+		void Add(float Value);
+	};
+
+	struct FPendingStamps
+	{
+		FInputStamp ByStat[static_cast<int32>(EStatTypeBB::Count)];
+	};
+
+	// Drop every stamp which has waited longer than bb.Latency.MaxPendingSeconds.
+	void RemoveExpired(double NowSeconds);
+
+	FInputStamp CurrentInput;
+	FInputStamp ActiveBroadcast;
+
+	// Only has entries for characters which have been tagged and not broadcast yet, so it stays tiny.
+	TMap<FObjectKey, FPendingStamps> PendingByOwner;
+
+	// When TagStat next sweeps PendingByOwner for stamps which were never broadcast.
+	double NextExpirySeconds = 0.0;
+
+	FSamples SamplesByAction[static_cast<int32>(EInputActionBB::Count)];
+
+	uint64 NumWidgetUpdates = 0;
+};
+
+// Marks an input action as being handled, for as long as it is in scope.
+struct FInputLatencyScopeBB
+{
+	explicit FInputLatencyScopeBB(EInputActionBB Action) { FStatLatencyTrackerBB::Get().BeginInput(Action); }
+	~FInputLatencyScopeBB() { FStatLatencyTrackerBB::Get().EndInput(); }
+};
+
+// Marks a stat as being broadcast, for as long as it is in scope.
+struct FStatBroadcastScopeBB
+{
+	FStatBroadcastScopeBB(const UObject* Owner, EStatTypeBB Stat)
+	{
+		FStatLatencyTrackerBB::Get().BeginBroadcast(Owner, Stat);
+	}
+
+	~FStatBroadcastScopeBB() { FStatLatencyTrackerBB::Get().EndBroadcast(); }
+};
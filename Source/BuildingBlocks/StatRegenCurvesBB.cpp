@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "StatRegenCurvesBB.h"
+#include "CustomLogging.h"
+#include "HAL/IConsoleManager.h"
+
+// A curve without any keys bakes to flat 1, like a new table.
+static void BakeRegenTable(FRegenTableBB& Table, const FRichCurve& Curve)
+{
+	// With no keys, Eval would give back the curve's default value, which is nonsense as a multiplier.
+	if (Curve.GetNumKeys() == 0)
+	{
+		Table = FRegenTableBB();
+		return;
+	}
+
+	for (int32 Index = 0; Index < FRegenTableBB::NumSamples; ++Index)
+	{
+		Table.Samples[Index] = Curve.Eval(static_cast<float>(Index) / (FRegenTableBB::NumSamples - 1));
+	}
+}
+
+static FAutoConsoleCommandWithArgs GRegenBenchmarkCommand(
+	TEXT("bb.Regen.Benchmark"),
+	TEXT("Time baked regen tables against evaluating the curve. Arguments: [NumCharacters=10000] [NumTicks=100]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumCharacters = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10000;
+		const int32 NumTicks      = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100;
+
+		// The sort of thing a designer would make: fast recovery when nearly empty, tailing off when full.
+		FRichCurve Curve;
+		Curve.SetKeyInterpMode(Curve.AddKey(0.f, 3.f), RCIM_Cubic);
+		Curve.SetKeyInterpMode(Curve.AddKey(0.25f, 2.f), RCIM_Cubic);
+		Curve.SetKeyInterpMode(Curve.AddKey(0.6f, 1.2f), RCIM_Cubic);
+		Curve.SetKeyInterpMode(Curve.AddKey(0.9f, 0.8f), RCIM_Cubic);
+		Curve.SetKeyInterpMode(Curve.AddKey(1.f, 0.5f), RCIM_Cubic);
+		Curve.AutoSetTangents();
+
+		FRegenTableBB Table;
+		BakeRegenTable(Table, Curve);
+
+		FRandomStream Random(1234);
+		TArray<float> Values;
+		Values.SetNumUninitialized(NumCharacters);
+		for (float& Value : Values)
+		{
+			Value = Random.FRand();
+		}
+
+		// Summed, so the work can't be optimised away.
+		float        CurveTotal = 0.f;
+		const double CurveStart = FPlatformTime::Seconds();
+		for (int32 Tick = 0; Tick < NumTicks; ++Tick)
+		{
+			for (const float Value : Values)
+			{
+				CurveTotal += Curve.Eval(Value);
+			}
+		}
+		const double CurveSeconds = FPlatformTime::Seconds() - CurveStart;
+
+		float        TableTotal = 0.f;
+		const double TableStart = FPlatformTime::Seconds();
+		for (int32 Tick = 0; Tick < NumTicks; ++Tick)
+		{
+			for (const float Value : Values)
+			{
+				TableTotal += Table.Evaluate(Value);
+			}
+		}
+		const double TableSeconds = FPlatformTime::Seconds() - TableStart;
+
+		float MaxError = 0.f;
+		for (int32 Step = 0; Step <= 10000; ++Step)
+		{
+			const float Alpha = Step / 10000.f;
+			MaxError          = FMath::Max(MaxError, FMath::Abs(Curve.Eval(Alpha) - Table.Evaluate(Alpha)));
+		}
+
+		const int32 NumEvaluations = NumCharacters * NumTicks;
+		BBLOG(Log, "Regen curves, {0} characters for {1} ticks:", NumCharacters, NumTicks);
+		BBLOG(Log, "  Curve: {0} ns per evaluation, {1} ms per tick (sum {2})", CurveSeconds * 1e9 / NumEvaluations,
+		      CurveSeconds * 1000.0 / NumTicks, CurveTotal);
+		BBLOG(Log, "  Table: {0} ns per evaluation, {1} ms per tick (sum {2})", TableSeconds * 1e9 / NumEvaluations,
+		      TableSeconds * 1000.0 / NumTicks, TableTotal);
+		BBLOG(Log, "  Table is {0}x faster, largest difference from the curve {1}",
+		      CurveSeconds / FMath::Max(TableSeconds, 1e-9), MaxError);
+	}));
+
+void UStatRegenCurvesBB::BakeTables()
+{
+	BakeRegenTable(StaminaTable, *StaminaRecovery.GetRichCurveConst());
+	BakeRegenTable(PsiTable, *PsiRecharge.GetRichCurveConst());
+}
+
+void UStatRegenCurvesBB::PostLoad()
+{
+	Super::PostLoad();
+	BakeTables();
+}
+
+#if WITH_EDITOR
+
+void UStatRegenCurvesBB::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	BakeTables();
+}
+
+#endif
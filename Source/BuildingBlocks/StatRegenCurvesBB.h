@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Curves/CurveFloat.h"
+#include "Engine/DataAsset.h"
+#include "RegenTableBB.h"
+#include "StatRegenCurvesBB.generated.h"
+
+/* Designer curves for how fast stats come back, depending on how full they are.
+ * e.g. stamina recovering quicker when it's nearly empty.
+ *
+ * Evaluating a curve means searching its keys and interpolating between them, which adds up
+ * across a crowd of characters every tick. So the curves are baked into FRegenTableBB lookup tables
+ * when the asset loads (and when it's edited), and characters only ever read the tables.
+ * Changes to an external curve asset are picked up the next time this asset is loaded or edited. */
+UCLASS(BlueprintType)
+class BUILDINGBLOCKS_API UStatRegenCurvesBB : public UDataAsset
+{
+public:
+	// Multiplies stamina recovery. X is how full stamina is, 0 to 1. Doesn't affect the cost of running or jumping.
+	UPROPERTY(EditAnywhere, Category="Regen")
+	FRuntimeFloatCurve StaminaRecovery;
+
+	// Multiplies psi power recharge. X is how full psi power is, 0 to 1.
+	UPROPERTY(EditAnywhere, Category="Regen")
+	FRuntimeFloatCurve PsiRecharge;
+
+	const FRegenTableBB& GetStaminaTable() const { return StaminaTable; }
+	const FRegenTableBB& GetPsiTable() const { return PsiTable; }
+
+	void BakeTables();
+
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+	FRegenTableBB StaminaTable;
+	FRegenTableBB PsiTable;
+
+	GENERATED_BODY()
+};
@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RegenTableBB.h"
+
+// The numbers the stat rules run on. Characters use the defaults, the balance commandlet can try others.
+struct FStatTuningBB
+{
+	// Stamina
+	float MaxStamina        = 100.0f;
+	float JumpStaminaCost   = 25.0f;
+	float RunStaminaCost    = 5.0f;
+	float RestStaminaRebate = 4.0f;
+
+	// Psi Power
+	float MaxPsiPower     = 1000.0f;
+	float PsiRechargeRate = 1.0f;
+	float PsiBlastCost    = 150.0f;
+};
+
+// What timed effects and regen curves add on top of the tuning.
+struct FStatModifiersBB
+{
+	float StaminaRegenBonus = 0.f; // Added to x1
+	float DamagePerSecond   = 0.f;
+	float PsiDrainPerSecond = 0.f;
+
+	const FRegenTableBB* StaminaRegenTable = nullptr;
+	const FRegenTableBB* PsiRegenTable     = nullptr;
+};
+
+/* How stamina, psi power and health change, on nothing but FCharacterSimStateBB.
+ * Only needs Core, so BuildingBlocksTests can check the clamps and regen without an engine or a project.
+ * That's why the state is a template parameter, FCharacterSimStateBB needs UHT, the tests use a plain struct
+ * with the same fields.
+ *
+ * ACharacterBB runs its stats through these, and so does UStatBalanceCommandletBB,
+ * which simulates crowds of scripted players without a world, so balance changes can be tried out
+ * without playing. Anything which changes how stats behave belongs in here, or the two will drift apart.
+ *
+ * Stamina and psi power change by a fixed amount per update, not per second, it's only the timed effects
+ * which are scaled by DeltaTime. So the rules only mean what they say at ACharacterBB's tick rate. */
+struct FStatRulesBB
+{
+	// How often a character updates its stats.
+	static constexpr float UpdateInterval = 0.5f;
+
+	template <typename StateType>
+	static bool CanJump(const StateType& State, const FStatTuningBB& Tuning)
+	{
+		return State.CurrentStamina - Tuning.JumpStaminaCost >= 0.f;
+	}
+
+	// Running stops once stamina runs out.
+	template <typename StateType>
+	static bool CanRun(const StateType& State)
+	{
+		return State.CurrentStamina > 0.f;
+	}
+
+	// Takes the cost off psi power, if there's enough. Returns whether the blast happened.
+	template <typename StateType>
+	static bool TryPsiBlast(StateType& State, const FStatTuningBB& Tuning)
+	{
+		if (State.CurrentPsiPower < Tuning.PsiBlastCost) return false;
+
+		State.CurrentPsiPower -= Tuning.PsiBlastCost;
+		return true;
+	}
+
+	// Dead is dead, nothing changes health once it gets to 0.
+	// Returns false if health didn't change.
+	template <typename StateType>
+	static bool ApplyHealthDelta(StateType& State, int32 DeltaHealth)
+	{
+		if (State.CurrentHealth <= 0) return false;
+
+		const int32 OldValue = State.CurrentHealth;
+		State.CurrentHealth  = FMath::Clamp(State.CurrentHealth + DeltaHealth, -1, State.MaxHealth);
+		return State.CurrentHealth != OldValue;
+	}
+
+	// Move stamina and psi power on by one update, and clear the exertion flags.
+	// Returns the whole points of damage over time which are now due, to go through ApplyHealthDelta.
+	template <typename StateType>
+	static int32 Step(StateType& State, const FStatTuningBB& Tuning, const FStatModifiersBB& Modifiers, float DeltaTime)
+	{
+		const FRegenTableBB& FlatTable = FRegenTableBB::GetFlat();
+
+		// How has stamina been affected?
+		// We move from the worst-case scenario to the best.
+		// if they jumped, otherwise if they ran, otherwise if they rested.
+		// and if they did none of those they get the default recharge rate.
+		float StaminaFactor = State.StaminaRecuperationFactor;
+
+		if (State.bHasJumped) StaminaFactor = -Tuning.JumpStaminaCost;
+		else if (State.bHasRan) StaminaFactor = -Tuning.RunStaminaCost;
+		// Player gets extra stamina back when crouched.
+		else if (State.bIsCrouched) StaminaFactor = Tuning.RestStaminaRebate;
+
+		// Timed effects speed up (or slow down) recovery, but never change the cost of exertion.
+		// Same goes for the regen curve.
+		if (StaminaFactor > 0.f)
+		{
+			const FRegenTableBB& StaminaTable = Modifiers.StaminaRegenTable ? *Modifiers.StaminaRegenTable : FlatTable;
+			StaminaFactor *= FMath::Max(0.f, 1.f + Modifiers.StaminaRegenBonus) *
+				StaminaTable.Evaluate(State.CurrentStamina / Tuning.MaxStamina);
+		}
+
+		State.CurrentStamina = FMath::Clamp(State.CurrentStamina + StaminaFactor, 0.f, Tuning.MaxStamina);
+		State.bHasRan        = false;
+		State.bHasJumped     = false;
+
+		// Psi drain from timed effects works against the recharge.
+		if (State.CurrentPsiPower != Tuning.MaxPsiPower || Modifiers.PsiDrainPerSecond > 0.f)
+		{
+			const FRegenTableBB& PsiTable = Modifiers.PsiRegenTable ? *Modifiers.PsiRegenTable : FlatTable;
+			const float Recharge = Tuning.PsiRechargeRate * PsiTable.Evaluate(State.CurrentPsiPower / Tuning.MaxPsiPower);
+			const float Drain    = Modifiers.PsiDrainPerSecond * DeltaTime;
+			State.CurrentPsiPower = FMath::Clamp(State.CurrentPsiPower + Recharge - Drain, 0.f, Tuning.MaxPsiPower);
+		}
+
+		// Health is whole numbers, so the fractions are carried over until they add up to a point.
+		if (Modifiers.DamagePerSecond <= 0.f) return 0;
+
+		State.PendingDamage += Modifiers.DamagePerSecond * DeltaTime;
+		const int32 WholeDamage = FMath::FloorToInt(State.PendingDamage);
+		if (WholeDamage > 0) State.PendingDamage -= WholeDamage;
+		return FMath::Max(0, WholeDamage);
+	}
+};
@@ -0,0 +1,179 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformProcess.h"
+#include <atomic>
+#include <type_traits>
+
+// The lock-free part of UStatSnapshotSubsystemBB. Only needs Core, so BuildingBlocksTests can stress it
+// without an engine or a project.
+
+// A character's stats as of its last update, for reading off the game thread.
+struct FStatSnapshotBB
+{
+	// Which character this is, unique for the life of the world. 0 for an empty slot.
+	uint32 Serial = 0;
+
+	int32 Health    = 0;
+	int32 MaxHealth = 0;
+	float Stamina   = 0.f;
+	float PsiPower  = 0.f;
+	int32 NumKeys   = 0;
+
+	// World time when it was published.
+	float Time = 0.f;
+
+	bool bIsRunning  = false;
+	bool bIsCrouched = false;
+};
+
+static_assert(std::is_trivially_copyable_v<FStatSnapshotBB>, "FStatSnapshotBB is copied as plain memory");
+
+/* For bb.Snapshots.Stress and BuildingBlocksTests. Every field of a stress snapshot comes from one counter,
+ * so a reader can tell if it got bits of two different writes. */
+struct FStatSnapshotStressBB
+{
+	static FStatSnapshotBB Make(uint32 Counter)
+	{
+		FStatSnapshotBB Snapshot;
+		Snapshot.Serial      = Counter | 1;
+		Snapshot.Health      = static_cast<int32>(Counter);
+		Snapshot.MaxHealth   = static_cast<int32>(Counter ^ 0x5a5a5a5a);
+		Snapshot.Stamina     = static_cast<float>(Counter & 0xffff);
+		Snapshot.PsiPower    = static_cast<float>((Counter & 0xffff) * 2);
+		Snapshot.NumKeys     = static_cast<int32>(Counter * 3);
+		Snapshot.Time        = static_cast<float>(Counter >> 16);
+		Snapshot.bIsRunning  = (Counter & 1) != 0;
+		Snapshot.bIsCrouched = (Counter & 2) != 0;
+		return Snapshot;
+	}
+
+	// Field by field, as the padding bytes are whatever happened to be in memory, not part of the write.
+	static bool IsConsistent(const FStatSnapshotBB& Snapshot)
+	{
+		const FStatSnapshotBB Expected = Make(static_cast<uint32>(Snapshot.Health));
+		return Snapshot.Serial == Expected.Serial
+			&& Snapshot.MaxHealth == Expected.MaxHealth
+			&& Snapshot.Stamina == Expected.Stamina
+			&& Snapshot.PsiPower == Expected.PsiPower
+			&& Snapshot.NumKeys == Expected.NumKeys
+			&& Snapshot.Time == Expected.Time
+			&& Snapshot.bIsRunning == Expected.bIsRunning
+			&& Snapshot.bIsCrouched == Expected.bIsCrouched;
+	}
+};
+
+/* A value with one writer and any number of readers on other threads, which never block each other.
+ *
+ * The writer bumps a sequence number to odd, writes, then bumps it to even again. A reader notes the sequence,
+ * copies the value, and tries again if the sequence was odd or has moved on since, so it never sees half a write.
+ * With one write per character update, retries hardly ever happen.
+ *
+ * The value is held as atomic words rather than plain memory, so there's never a data race as far as
+ * the C++ memory model (or ThreadSanitizer) is concerned, even on the reads which get thrown away. */
+template <typename ValueType>
+class TSeqLockBB
+{
+	static_assert(std::is_trivially_copyable_v<ValueType>, "Values are copied as plain memory");
+
+public:
+	TSeqLockBB()
+	{
+		for (std::atomic<uint64>& Word : Words) Word.store(0, std::memory_order_relaxed);
+	}
+
+	// Only ever from one thread at a time.
+	void Write(const ValueType& Value)
+	{
+		uint64 Buffer[NumWords] = {};
+		FMemory::Memcpy(Buffer, &Value, sizeof(ValueType));
+
+		const uint32 Before = Sequence.load(std::memory_order_relaxed);
+		Sequence.store(Before + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		for (int32 Index = 0; Index < NumWords; ++Index)
+		{
+			Words[Index].store(Buffer[Index], std::memory_order_relaxed);
+		}
+
+		Sequence.store(Before + 2, std::memory_order_release);
+	}
+
+	// One attempt, false if a write got in the way.
+	bool TryRead(ValueType& OutValue) const
+	{
+		const uint32 Before = Sequence.load(std::memory_order_acquire);
+		if (Before & 1) return false;
+
+		uint64 Buffer[NumWords];
+		for (int32 Index = 0; Index < NumWords; ++Index)
+		{
+			Buffer[Index] = Words[Index].load(std::memory_order_relaxed);
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (Sequence.load(std::memory_order_relaxed) != Before) return false;
+
+		FMemory::Memcpy(&OutValue, Buffer, sizeof(ValueType));
+		return true;
+	}
+
+	// Any thread. Returns the number of attempts which had to be thrown away.
+	int32 Read(ValueType& OutValue) const
+	{
+		int32 NumRetries = 0;
+		while (!TryRead(OutValue))
+		{
+			++NumRetries;
+			FPlatformProcess::YieldCycles(64);
+		}
+		return NumRetries;
+	}
+
+private:
+	static constexpr int32 NumWords = (sizeof(ValueType) + sizeof(uint64) - 1) / sizeof(uint64);
+
+	std::atomic<uint32> Sequence = 0;
+	std::atomic<uint64> Words[NumWords];
+};
+
+// Every character's published stats, as handed to worker threads.
+// Cheap to copy, and only good for as long as the world is.
+class FStatSnapshotViewBB
+{
+public:
+	FStatSnapshotViewBB() = default;
+
+	FStatSnapshotViewBB(const TSeqLockBB<FStatSnapshotBB>* InSlots, const std::atomic<int32>* InNumSlots)
+		: Slots(InSlots), NumSlots(InNumSlots)
+	{
+	}
+
+	// Slots which have ever been used, some of which may be empty now.
+	int32 Num() const { return NumSlots ? NumSlots->load(std::memory_order_acquire) : 0; }
+
+	// False for an empty slot.
+	bool Read(int32 Index, FStatSnapshotBB& OutSnapshot) const
+	{
+		Slots[Index].Read(OutSnapshot);
+		return OutSnapshot.Serial != 0;
+	}
+
+	// Call Function with every character's snapshot.
+	template <typename FunctionType>
+	void ForEach(FunctionType&& Function) const
+	{
+		FStatSnapshotBB Snapshot;
+		for (int32 Index = 0, Count = Num(); Index < Count; ++Index)
+		{
+			if (Read(Index, Snapshot)) Function(Snapshot);
+		}
+	}
+
+private:
+	const TSeqLockBB<FStatSnapshotBB>* Slots    = nullptr;
+	const std::atomic<int32>*          NumSlots = nullptr;
+};
@@ -0,0 +1,161 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "StatSnapshotsBB.h"
+#include "CustomLogging.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+
+static FAutoConsoleCommand GSnapshotStressCommand(
+	TEXT("bb.Snapshots.Stress"),
+	TEXT("Publish stat snapshots as fast as possible while every worker thread reads them, checking none are torn. ")
+	TEXT("Arguments: [Seconds=2] [Slots=64]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const double Seconds  = Args.Num() > 0 ? FMath::Max(0.1, FCString::Atod(*Args[0])) : 2.0;
+		const int32  NumSlots = Args.Num() > 1 ? FMath::Clamp(FCString::Atoi(*Args[1]), 1, 4096) : 64;
+
+		// Few slots means readers and the writer are nearly always on the same one, which is the worst case.
+		TUniquePtr<TSeqLockBB<FStatSnapshotBB>[]> Slots = MakeUnique<TSeqLockBB<FStatSnapshotBB>[]>(NumSlots);
+		std::atomic<int32> NumSlotsUsed = NumSlots;
+		std::atomic<bool>  bStop        = false;
+		const FStatSnapshotViewBB View(Slots.Get(), &NumSlotsUsed);
+
+		struct FReaderResult
+		{
+			uint64 NumReads   = 0;
+			uint64 NumRetries = 0;
+			uint64 NumTorn    = 0;
+		};
+
+		const int32 NumReaders = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads());
+		TArray<TFuture<FReaderResult>> Readers;
+		for (int32 ReaderIndex = 0; ReaderIndex < NumReaders; ++ReaderIndex)
+		{
+			Readers.Add(Async(EAsyncExecution::ThreadPool, [&View, &Slots, &bStop, ReaderIndex]()
+			{
+				FReaderResult   Result;
+				FStatSnapshotBB Snapshot;
+				for (int32 Index = ReaderIndex; !bStop.load(std::memory_order_relaxed); ++Index)
+				{
+					const int32 SlotIndex = Index % View.Num();
+					Result.NumRetries += Slots[SlotIndex].Read(Snapshot);
+					if (Snapshot.Serial != 0 && !FStatSnapshotStressBB::IsConsistent(Snapshot)) ++Result.NumTorn;
+					++Result.NumReads;
+				}
+				return Result;
+			}));
+		}
+
+		// One writer, as there is on the game thread.
+		uint32       Counter = 0;
+		const double EndTime = FPlatformTime::Seconds() + Seconds;
+		while (FPlatformTime::Seconds() < EndTime)
+		{
+			for (int32 Batch = 0; Batch < 1024; ++Batch, ++Counter)
+			{
+				Slots[Counter % NumSlots].Write(FStatSnapshotStressBB::Make(Counter));
+			}
+		}
+		bStop.store(true, std::memory_order_relaxed);
+
+		FReaderResult Total;
+		for (TFuture<FReaderResult>& Reader : Readers)
+		{
+			const FReaderResult Result = Reader.Get();
+			Total.NumReads   += Result.NumReads;
+			Total.NumRetries += Result.NumRetries;
+			Total.NumTorn    += Result.NumTorn;
+		}
+
+		BBLOG(Display, "Snapshot stress: {0} writes and {1} reads on {2} threads, over {3} slots in {4}s",
+		      Counter, Total.NumReads, NumReaders, NumSlots, Seconds);
+		BBLOG(Display, "  {0} million writes/s, {1} million reads/s, {2} retries per 1000 reads",
+		      Counter / Seconds / 1e6, Total.NumReads / Seconds / 1e6,
+		      Total.NumReads > 0 ? 1000.0 * Total.NumRetries / Total.NumReads : 0.0);
+
+		if (Total.NumTorn > 0)
+		{
+			BBLOG(Error, "  {0} torn reads!", Total.NumTorn);
+		}
+		else
+		{
+			BBLOG(Display, "  No torn reads");
+		}
+	}));
+
+FStatSlotBB UStatSnapshotSubsystemBB::AddSlot()
+{
+	FStatSlotBB Slot;
+	if (FreeSlots.Num() > 0)
+	{
+		Slot.Index = FreeSlots.Pop(false);
+	}
+	else if (NumSlotsUsed.load(std::memory_order_relaxed) < MaxSlots)
+	{
+		// Published after the slot is, so readers never go past what's been written.
+		Slot.Index = NumSlotsUsed.load(std::memory_order_relaxed);
+		NumSlotsUsed.store(Slot.Index + 1, std::memory_order_release);
+	}
+	else
+	{
+		BBLOG(Warning, "Out of stat snapshot slots, {0} is the most characters which can publish stats", MaxSlots);
+		return Slot;
+	}
+
+	Slot.Serial = NextSerial++;
+	if (NextSerial == 0) NextSerial = 1;
+	return Slot;
+}
+
+void UStatSnapshotSubsystemBB::RemoveSlot(const FStatSlotBB& Slot)
+{
+	if (!Slot.IsValid() || !Slots) return;
+
+	// Empty, so readers skip it until someone else has it.
+	Slots[Slot.Index].Write(FStatSnapshotBB());
+	FreeSlots.Add(Slot.Index);
+}
+
+void UStatSnapshotSubsystemBB::Publish(const FStatSlotBB& Slot, const FStatSnapshotBB& Snapshot)
+{
+	if (!Slot.IsValid() || !Slots) return;
+
+	FStatSnapshotBB Stamped = Snapshot;
+	Stamped.Serial          = Slot.Serial;
+	Slots[Slot.Index].Write(Stamped);
+}
+
+FStatSnapshotBB UStatSnapshotSubsystemBB::Read(int32 SlotIndex) const
+{
+	FStatSnapshotBB Snapshot;
+	if (Slots && SlotIndex >= 0 && SlotIndex < MaxSlots) Slots[SlotIndex].Read(Snapshot);
+	return Snapshot;
+}
+
+FStatSnapshotViewBB UStatSnapshotSubsystemBB::GetView() const
+{
+	return FStatSnapshotViewBB(Slots.Get(), &NumSlotsUsed);
+}
+
+void UStatSnapshotSubsystemBB::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// All up front, so they never move under a reader.
+	Slots = MakeUnique<TSeqLockBB<FStatSnapshotBB>[]>(MaxSlots);
+}
+
+void UStatSnapshotSubsystemBB::Deinitialize()
+{
+	NumSlotsUsed.store(0, std::memory_order_release);
+	FreeSlots.Empty();
+	Slots.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UStatSnapshotSubsystemBB::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	// Only worlds which are actually played in, not every editor preview allocating MaxSlots.
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
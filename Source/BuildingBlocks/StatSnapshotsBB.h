@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StatSnapshotBB.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StatSnapshotsBB.generated.h"
+
+// Where one character publishes its stats.
+struct FStatSlotBB
+{
+	int32  Index  = INDEX_NONE;
+	uint32 Serial = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+};
+
+/* A slot per character, each holding the stats from its last update, for worker threads to read.
+ *
+ * Async AI scoring or analytics can take a view from GetView (or a single slot from ACharacterBB::GetStatSlot)
+ * on the game thread, then read from any thread without locks, or waiting on the game thread.
+ * The slots are all allocated up front, so they never move while someone is reading them.
+ * Jobs need to be finished before the world goes, as with anything else belonging to it.
+ * bb.Snapshots.Stress hammers a set of slots from every worker thread, checking nothing is ever torn.
+ * BuildingBlocksTests does the same on every run, and is the one to build with ThreadSanitizer. */
+UCLASS()
+class BUILDINGBLOCKS_API UStatSnapshotSubsystemBB : public UWorldSubsystem
+{
+public:
+	static constexpr int32 MaxSlots = 4096;
+
+	// Game thread only. Invalid once every slot is taken.
+	FStatSlotBB AddSlot();
+	void        RemoveSlot(const FStatSlotBB& Slot);
+	void        Publish(const FStatSlotBB& Slot, const FStatSnapshotBB& Snapshot);
+
+	// Any thread, for a slot from AddSlot. The serial says whose it is, in case it has changed hands since.
+	FStatSnapshotBB Read(int32 SlotIndex) const;
+
+	FStatSnapshotViewBB GetView() const;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	TUniquePtr<TSeqLockBB<FStatSnapshotBB>[]> Slots;
+	TArray<int32>                             FreeSlots;
+	std::atomic<int32>                        NumSlotsUsed = 0;
+	uint32                                    NextSerial   = 1;
+
+	GENERATED_BODY()
+};
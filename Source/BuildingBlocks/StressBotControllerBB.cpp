@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "StressBotControllerBB.h"
+#include "CharacterBB.h"
+
+// Keys bots pass around. A few, so wallets and locks see adds, duplicates and removes.
+static constexpr int32 NumStressKeys = 4;
+
+AStressBotControllerBB::AStressBotControllerBB()
+{
+	PrimaryActorTick.bCanEverTick = true;
+}
+
+void AStressBotControllerBB::SetSeed(int32 Seed)
+{
+	Random.Initialize(Seed);
+
+	// Spread out the first actions, so a freshly spawned crowd doesn't all jump on the same frame.
+	TimeUntilTurn   = Random.FRandRange(0.f, 2.f);
+	TimeUntilAction = Random.FRandRange(0.f, 2.f);
+}
+
+void AStressBotControllerBB::SetBehaviour(EStressBehaviourBB NewBehaviour)
+{
+	Behaviour = NewBehaviour;
+
+	if (ACharacterBB* Character = GetPawn<ACharacterBB>(); Character && Behaviour == EStressBehaviourBB::Idle)
+	{
+		Character->SetRunning(false);
+		Character->UnCrouch();
+	}
+}
+
+void AStressBotControllerBB::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	ACharacterBB* Character = GetPawn<ACharacterBB>();
+	if (!Character || Behaviour == EStressBehaviourBB::Idle) return;
+
+	TimeUntilTurn -= DeltaSeconds;
+	if (TimeUntilTurn <= 0.f)
+	{
+		MoveDirection = FRotator(0.f, Random.FRandRange(0.f, 360.f), 0.f).Vector();
+		TimeUntilTurn = Random.FRandRange(1.f, 4.f);
+	}
+	Character->AddMovementInput(MoveDirection);
+
+	TimeUntilAction -= DeltaSeconds;
+	if (TimeUntilAction <= 0.f)
+	{
+		DoRandomAction(*Character);
+		TimeUntilAction = Behaviour == EStressBehaviourBB::Frantic
+			                  ? Random.FRandRange(0.1f, 0.5f)
+			                  : Random.FRandRange(2.f, 6.f);
+	}
+}
+
+void AStressBotControllerBB::DoRandomAction(ACharacterBB& Character)
+{
+	// Only the jump button gets held, let go of it before doing anything else.
+	Character.StopJumping();
+
+	// Wandering bots only move about, frantic ones use everything.
+	const int32 NumActions = Behaviour == EStressBehaviourBB::Frantic ? 7 : 3;
+	switch (Random.RandHelper(NumActions))
+	{
+	case 0:
+		Character.ToggleRunning();
+		break;
+	case 1:
+		Character.Jump();
+		break;
+	case 2:
+		if (Character.bIsCrouched)
+			Character.UnCrouch();
+		else
+			Character.Crouch();
+		break;
+	case 3:
+		Character.PsiBlast();
+		break;
+	case 4:
+		// Never enough to kill them, a dead bot doesn't change its health any more.
+		Character.UpdateHealth(Character.GetHealth() > 30 ? -Random.RandRange(1, 20) : Random.RandRange(10, 40));
+		break;
+	case 5:
+		Character.AddKey(FString::Printf(TEXT("StressKey%d"), Random.RandHelper(NumStressKeys)));
+		break;
+	case 6:
+		Character.RemoveKey(FString::Printf(TEXT("StressKey%d"), Random.RandHelper(NumStressKeys)));
+		break;
+	default: ;
+	}
+}
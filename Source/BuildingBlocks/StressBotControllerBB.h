@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Controller.h"
+#include "StressBotControllerBB.generated.h"
+
+class ACharacterBB;
+
+// What stress test bots get up to.
+UENUM(BlueprintType)
+enum class EStressBehaviourBB : uint8
+{
+	Idle UMETA(Tooltip = "Stand still. Only the stats themselves tick."),
+	Wander UMETA(Tooltip = "Walk about, now and then running, jumping or crouching."),
+	Frantic UMETA(Tooltip = "Everything, all the time: running, jumping, psi blasts, damage, healing and keys.")
+};
+
+/* Drives a character for load testing, through the same calls a player's input ends up making
+ * (AddMovementInput, SetRunning, Jump, Crouch, PsiBlast, UpdateHealth, AddKey...).
+ * Deliberately not an AIController, so there's no pathfinding or perception cost muddying the numbers.
+ * Every bot has its own seeded random stream, so the same seed gives the same run. */
+UCLASS(NotBlueprintable)
+class BUILDINGBLOCKS_API AStressBotControllerBB : public AController
+{
+public:
+	AStressBotControllerBB();
+
+	void SetSeed(int32 Seed);
+	void SetBehaviour(EStressBehaviourBB NewBehaviour);
+
+	virtual void Tick(float DeltaSeconds) override;
+
+private:
+	// Do one random thing, from whatever the behaviour allows.
+	void DoRandomAction(ACharacterBB& Character);
+
+	FRandomStream      Random;
+	EStressBehaviourBB Behaviour = EStressBehaviourBB::Wander;
+
+	FVector MoveDirection   = FVector::ForwardVector;
+	float   TimeUntilTurn   = 0.f;
+	float   TimeUntilAction = 0.f;
+
+	GENERATED_BODY()
+};
@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "StressTestSubsystemBB.h"
+#include "CharacterBB.h"
+#include "CustomLogging.h"
+#include "ProfilingStatsBB.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+// Room for a character and a bit, so they don't all start off pushing each other about.
+static constexpr float BotSpacing = 200.f;
+
+static FAutoConsoleCommandWithWorldAndArgs GStressSpawnCommand(
+	TEXT("bb.Stress.Spawn"),
+	TEXT("Spawn bot controlled characters around the player. Arguments: [Count=100] [Seed=1234]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UStressTestSubsystemBB* StressTest = World ? World->GetSubsystem<UStressTestSubsystemBB>() : nullptr;
+		if (!StressTest) return;
+
+		const int32 Count      = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100;
+		const int32 Seed       = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1234;
+		const int32 NumSpawned = StressTest->SpawnBots(Count, Seed);
+		BBLOG(Log, "Spawned {0} stress bots, {1} in total", NumSpawned, StressTest->GetNumBots());
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GStressBehaviourCommand(
+	TEXT("bb.Stress.Behaviour"),
+	TEXT("Set what the stress bots do. Arguments: Idle|Wander|Frantic"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UStressTestSubsystemBB* StressTest = World ? World->GetSubsystem<UStressTestSubsystemBB>() : nullptr;
+		if (!StressTest) return;
+
+		const int64 Value = Args.Num() > 0 ? StaticEnum<EStressBehaviourBB>()->GetValueByNameString(Args[0]) : INDEX_NONE;
+		if (Value == INDEX_NONE)
+		{
+			BBLOG(Warning, "Usage: bb.Stress.Behaviour Idle|Wander|Frantic");
+			return;
+		}
+
+		StressTest->SetBehaviour(static_cast<EStressBehaviourBB>(Value));
+		BBLOG(Log, "Stress bots are now {0}", Args[0]);
+	}));
+
+static FAutoConsoleCommandWithWorld GStressClearCommand(
+	TEXT("bb.Stress.Clear"),
+	TEXT("Destroy every stress bot."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UStressTestSubsystemBB* StressTest = World ? World->GetSubsystem<UStressTestSubsystemBB>() : nullptr)
+			BBLOG(Log, "Destroyed {0} stress bots", StressTest->ClearBots());
+	}));
+
+int32 UStressTestSubsystemBB::SpawnBots(int32 Count, int32 Seed)
+{
+	UWorld* World = GetWorld();
+	if (World->GetNetMode() == NM_Client)
+	{
+		BBLOG(Warning, "Stress bots can only be spawned on the server");
+		return 0;
+	}
+
+	// The same character as the player, so the bots cost what real players would.
+	APlayerController* PlayerController = World->GetFirstPlayerController();
+	const APawn*       PlayerPawn       = PlayerController ? PlayerController->GetPawn() : nullptr;
+	UClass*            CharacterClass   = PlayerPawn && PlayerPawn->IsA<ACharacterBB>()
+		                                      ? PlayerPawn->GetClass()
+		                                      : ACharacterBB::StaticClass();
+
+	// A grid, starting a little in front of the player.
+	const FVector  Origin  = PlayerPawn ? PlayerPawn->GetActorLocation() : FVector::ZeroVector;
+	const FRotator Facing  = PlayerPawn ? FRotator(0.f, PlayerPawn->GetActorRotation().Yaw, 0.f) : FRotator::ZeroRotator;
+	const int32    Columns = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Bots.Num() + Count)));
+
+	FActorSpawnParameters ControllerSpawnParameters;
+	ControllerSpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	int32 NumSpawned = 0;
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const int32      BotIndex = NextBotIndex++;
+		const int32      Slot     = Bots.Num();
+		const FVector    Offset((Slot / Columns + 2) * BotSpacing, (Slot % Columns - Columns / 2) * BotSpacing, 0.f);
+		const FTransform Transform(Facing, Origin + Facing.RotateVector(Offset));
+
+		// Deferred, so a blueprint set to auto possess doesn't get its own AI controller first.
+		ACharacterBB* Character = World->SpawnActorDeferred<ACharacterBB>(
+			CharacterClass, Transform, nullptr, nullptr,
+			ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+		if (!Character) continue;
+		Character->AutoPossessAI = EAutoPossessAI::Disabled;
+		Character->FinishSpawning(Transform);
+
+		AStressBotControllerBB* Controller = World->SpawnActor<AStressBotControllerBB>(ControllerSpawnParameters);
+		Controller->SetSeed(Seed + BotIndex);
+		Controller->SetBehaviour(Behaviour);
+		Controller->Possess(Character);
+
+		Bots.Add(Character);
+		++NumSpawned;
+	}
+
+	// Start the summary over, so the numbers are for the new load.
+	SummaryFrames = 0;
+	return NumSpawned;
+}
+
+void UStressTestSubsystemBB::SetBehaviour(EStressBehaviourBB NewBehaviour)
+{
+	Behaviour = NewBehaviour;
+	for (const TWeakObjectPtr<ACharacterBB>& Bot : Bots)
+	{
+		if (AStressBotControllerBB* Controller = Bot.IsValid() ? Bot->GetController<AStressBotControllerBB>() : nullptr)
+			Controller->SetBehaviour(Behaviour);
+	}
+	SummaryFrames = 0;
+}
+
+int32 UStressTestSubsystemBB::ClearBots()
+{
+	int32 NumDestroyed = 0;
+	for (const TWeakObjectPtr<ACharacterBB>& Bot : Bots)
+	{
+		ACharacterBB* Character = Bot.Get();
+		if (!Character) continue;
+
+		if (AController* Controller = Character->GetController()) Controller->Destroy();
+		Character->Destroy();
+		++NumDestroyed;
+	}
+
+	Bots.Empty();
+	NextBotIndex = 0;
+	return NumDestroyed;
+}
+
+void UStressTestSubsystemBB::Tick(float DeltaTime)
+{
+	if (Bots.Num() == 0) return;
+
+	if (SummaryFrames == 0)
+	{
+		SummaryStartSeconds = FPlatformTime::Seconds();
+		SummaryStartCycles  = FStatCostScopeBB::TotalCycles;
+		SummaryStartUpdates = FStatCostScopeBB::NumUpdates;
+	}
+	++SummaryFrames;
+
+	if (FPlatformTime::Seconds() - SummaryStartSeconds >= 1.0) ReportCost();
+}
+
+TStatId UStressTestSubsystemBB::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStressTestSubsystemBB, STATGROUP_Tickables);
+}
+
+void UStressTestSubsystemBB::Deinitialize()
+{
+	Bots.Empty();
+	Super::Deinitialize();
+}
+
+void UStressTestSubsystemBB::ReportCost()
+{
+	// Bots which were destroyed some other way
+	Bots.RemoveAllSwap([](const TWeakObjectPtr<ACharacterBB>& Bot) { return !Bot.IsValid(); });
+
+	const double Seconds    = FPlatformTime::Seconds() - SummaryStartSeconds;
+	const double StatsMs    = FPlatformTime::ToMilliseconds64(FStatCostScopeBB::TotalCycles - SummaryStartCycles);
+	const uint64 NumUpdates = FStatCostScopeBB::NumUpdates - SummaryStartUpdates;
+
+	const FString Summary = FString::Printf(
+		TEXT("Stress: %d bots (%s), %.1f fps, character stats %.3f ms/frame, %.2f updates/frame, %.2f us/update"),
+		Bots.Num(), *StaticEnum<EStressBehaviourBB>()->GetNameStringByValue(static_cast<int64>(Behaviour)),
+		SummaryFrames / Seconds, StatsMs / SummaryFrames, static_cast<double>(NumUpdates) / SummaryFrames,
+		NumUpdates > 0 ? StatsMs * 1000.0 / NumUpdates : 0.0);
+
+	BBLOG(Log, "{0}", Summary);
+	if (GEngine) GEngine->AddOnScreenDebugMessage(GetUniqueID(), 1.5f, FColor::Yellow, Summary);
+
+	SummaryFrames = 0;
+}
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StressBotControllerBB.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StressTestSubsystemBB.generated.h"
+
+class ACharacterBB;
+
+/* Fills the level with bot driven characters, for profiling under load.
+ *   bb.Stress.Spawn [Count=100] [Seed=1234]   Spawn more bots around the player.
+ *   bb.Stress.Behaviour [Idle|Wander|Frantic] What the bots do, see EStressBehaviourBB.
+ *   bb.Stress.Clear                            Get rid of them all.
+ * While there are bots, the cost of the character stats per frame is logged, and shown on screen, every second. */
+UCLASS()
+class BUILDINGBLOCKS_API UStressTestSubsystemBB : public UTickableWorldSubsystem
+{
+public:
+	// Spawn Count bots in a grid in front of the player. Only where stats can change, i.e. not on a client.
+	int32 SpawnBots(int32 Count, int32 Seed);
+
+	void SetBehaviour(EStressBehaviourBB NewBehaviour);
+
+	// Destroy every bot, and its controller. Returns how many there were.
+	int32 ClearBots();
+
+	int32 GetNumBots() const { return Bots.Num(); }
+
+	virtual void    Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual void Deinitialize() override;
+
+private:
+	void ReportCost();
+
+	TArray<TWeakObjectPtr<ACharacterBB>> Bots;
+	EStressBehaviourBB                   Behaviour = EStressBehaviourBB::Wander;
+
+	// Seeds carry on from one spawn to the next, so two spawns of 100 are the same as one of 200.
+	int32 NextBotIndex = 0;
+
+	// For the summary
+	double SummaryStartSeconds = 0.0;
+	int32  SummaryFrames       = 0;
+	uint64 SummaryStartCycles  = 0;
+	uint64 SummaryStartUpdates = 0;
+
+	GENERATED_BODY()
+};
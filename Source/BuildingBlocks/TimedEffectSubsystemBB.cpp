@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TimedEffectSubsystemBB.h"
+#include "CharacterBB.h"
+#include "CustomLogging.h"
+#include "HAL/IConsoleManager.h"
+
+static FAutoConsoleCommandWithArgs GTimedEffectBenchmarkCommand(
+	TEXT("bb.Effects.Benchmark"),
+	TEXT("Time the timing wheel with lots of concurrent effects. Arguments: [NumEffects=100000]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumEffects = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100000;
+
+		// Durations from a frame to 10 minutes, like a real mix of effects.
+		FRandomStream Random(1234);
+		TArray<uint64> Delays;
+		Delays.SetNumUninitialized(NumEffects);
+		for (uint64& Delay : Delays)
+		{
+			Delay = Random.RandRange(1, 12000);
+		}
+
+		FTimingWheelBB     Wheel;
+		TArray<FTimerIdBB> TimerIds;
+		TimerIds.SetNumUninitialized(NumEffects);
+
+		const double ScheduleStart = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < NumEffects; ++Index)
+		{
+			TimerIds[Index] = Wheel.Schedule(Delays[Index]);
+		}
+		const double ScheduleSeconds = FPlatformTime::Seconds() - ScheduleStart;
+
+		// Cancel every 4th effect, as if they were dispelled.
+		int32        NumCancelled = 0;
+		const double CancelStart  = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < NumEffects; Index += 4)
+		{
+			NumCancelled += Wheel.Cancel(TimerIds[Index]) ? 1 : 0;
+		}
+		const double CancelSeconds = FPlatformTime::Seconds() - CancelStart;
+
+		int32        NumExpired  = 0;
+		const double ExpireStart = FPlatformTime::Seconds();
+		Wheel.Advance(12000, [&NumExpired](FTimerIdBB) { ++NumExpired; });
+		const double ExpireSeconds = FPlatformTime::Seconds() - ExpireStart;
+
+		BBLOG(Log, "Timing wheel, {0} effects over 12000 ticks:", NumEffects);
+		BBLOG(Log, "  Schedule: {0} ns/op", ScheduleSeconds * 1e9 / NumEffects);
+		BBLOG(Log, "  Cancel:   {0} ns/op ({1} cancelled)", CancelSeconds * 1e9 / FMath::Max(1, NumCancelled),
+		      NumCancelled);
+		BBLOG(Log, "  Advance:  {0} ms total, {1} ns per expiry ({2} expired, {3} left)", ExpireSeconds * 1000.0,
+		      ExpireSeconds * 1e9 / FMath::Max(1, NumExpired), NumExpired, Wheel.Num());
+	}));
+
+FTimedEffectHandleBB UTimedEffectSubsystemBB::ApplyTimedEffect(ACharacterBB* Target, ETimedEffectTypeBB Type,
+                                                               float Magnitude, float Duration)
+{
+	FTimedEffectHandleBB Handle;
+	if (!Target || Duration <= 0.f) return Handle;
+
+	Handle.TimerId = Wheel.Schedule(static_cast<uint64>(FMath::CeilToInt(Duration / SecondsPerTick)));
+
+	// Multipliers stack by adding what they add on top of x1, which means they can be taken off again exactly.
+	const float Modifier = Type == ETimedEffectTypeBB::StaminaRegenMultiplier ? Magnitude - 1.f : Magnitude;
+
+	if (Handle.TimerId.Index >= Effects.Num()) Effects.SetNum(Handle.TimerId.Index + 1);
+	Effects[Handle.TimerId.Index] = FTimedEffect{Target, Handle.TimerId, Type, Modifier};
+
+	Target->AddTimedEffectModifier(Type, Modifier);
+	return Handle;
+}
+
+bool UTimedEffectSubsystemBB::CancelTimedEffect(FTimedEffectHandleBB Handle)
+{
+	if (!Wheel.Cancel(Handle.TimerId)) return false;
+
+	EndEffect(Handle.TimerId);
+	return true;
+}
+
+void UTimedEffectSubsystemBB::CancelEffectsOn(const ACharacterBB* Target)
+{
+	for (FTimedEffect& Effect : Effects)
+	{
+		if (Effect.Target.Get() == Target && Wheel.Cancel(Effect.TimerId))
+			EndEffect(Effect.TimerId);
+	}
+}
+
+int32 UTimedEffectSubsystemBB::GetNumActiveEffects() const
+{
+	return Wheel.Num();
+}
+
+void UTimedEffectSubsystemBB::Tick(float DeltaTime)
+{
+	UnprocessedSeconds += DeltaTime;
+	const int32 NumTicks = FMath::FloorToInt(UnprocessedSeconds / SecondsPerTick);
+	if (NumTicks <= 0) return;
+
+	UnprocessedSeconds -= NumTicks * SecondsPerTick;
+	Wheel.Advance(NumTicks, [this](FTimerIdBB TimerId) { EndEffect(TimerId); });
+}
+
+TStatId UTimedEffectSubsystemBB::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTimedEffectSubsystemBB, STATGROUP_Tickables);
+}
+
+void UTimedEffectSubsystemBB::Deinitialize()
+{
+	Wheel.Reset();
+	Effects.Empty();
+	Super::Deinitialize();
+}
+
+void UTimedEffectSubsystemBB::EndEffect(FTimerIdBB TimerId)
+{
+	FTimedEffect& Effect = Effects[TimerId.Index];
+
+	// The character may have gone away while the effect was running, which is fine.
+	if (ACharacterBB* Target = Effect.Target.Get())
+		Target->AddTimedEffectModifier(Effect.Type, -Effect.Modifier);
+
+	Effect = FTimedEffect();
+}
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TimingWheelBB.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TimedEffectSubsystemBB.generated.h"
+
+class ACharacterBB;
+
+// The different kinds of timed effect which can be applied to a character.
+UENUM(BlueprintType)
+enum class ETimedEffectTypeBB : uint8
+{
+	StaminaRegenMultiplier UMETA(Tooltip = "Multiplies stamina recovery. Stacks additively, two x1.5 effects give x2."),
+	DamageOverTime UMETA(Tooltip = "Health lost per second."),
+	PsiDrain UMETA(Tooltip = "Psi power lost per second.")
+};
+
+// Identifies an applied effect, so it can be cancelled before it runs out.
+USTRUCT(BlueprintType)
+struct FTimedEffectHandleBB
+{
+	FTimerIdBB TimerId;
+
+	GENERATED_BODY()
+};
+
+/* Buffs and debuffs which last for a set time.
+ *
+ * Rather than a timer per effect, every effect's expiry goes into one timing wheel,
+ * so applying, cancelling and expiring are all O(1) however many there are.
+ * While an effect is active its magnitude is added to a running total on the character,
+ * which ACharacterBB::Tick applies once per tick, so the cost per character
+ * doesn't grow with the number of effects on it either. */
+UCLASS()
+class BUILDINGBLOCKS_API UTimedEffectSubsystemBB : public UTickableWorldSubsystem
+{
+public:
+	// Resolution of effect durations.
+	static constexpr float SecondsPerTick = 0.05f;
+
+	// Apply an effect to a character for Duration seconds.
+	UFUNCTION(BlueprintCallable, Category="Timed Effects")
+	FTimedEffectHandleBB ApplyTimedEffect(ACharacterBB* Target, ETimedEffectTypeBB Type, float Magnitude,
+	                                      float Duration);
+
+	// End an effect early. Returns false if it had already ended.
+	UFUNCTION(BlueprintCallable, Category="Timed Effects")
+	bool CancelTimedEffect(FTimedEffectHandleBB Handle);
+
+	// End every effect on a character, e.g. when it goes back into a pool.
+	// Goes through every effect, so not something to do every frame.
+	void CancelEffectsOn(const ACharacterBB* Target);
+
+	UFUNCTION(BlueprintPure, Category="Timed Effects")
+	int32 GetNumActiveEffects() const;
+
+	virtual void    Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual void Deinitialize() override;
+
+private:
+	struct FTimedEffect
+	{
+		TWeakObjectPtr<ACharacterBB> Target;
+		FTimerIdBB                   TimerId;
+		ETimedEffectTypeBB           Type     = ETimedEffectTypeBB::StaminaRegenMultiplier;
+		float                        Modifier = 0.f;
+	};
+
+	// Take an effect's contribution back off its character.
+	void EndEffect(FTimerIdBB TimerId);
+
+	FTimingWheelBB Wheel;
+
+	// Indexed the same as the wheel's timers.
+	TArray<FTimedEffect> Effects;
+
+	// Time which hasn't yet made up a whole tick.
+	float UnprocessedSeconds = 0.f;
+
+	GENERATED_BODY()
+};
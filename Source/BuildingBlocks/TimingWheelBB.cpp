@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TimingWheelBB.h"
+
+FTimingWheelBB::FTimingWheelBB()
+{
+	Reset();
+}
+
+FTimerIdBB FTimingWheelBB::Schedule(uint64 DelayTicks)
+{
+	int32 NodeIndex;
+	if (FreeNodes.Num() > 0)
+		NodeIndex = FreeNodes.Pop(false);
+	else
+		NodeIndex = Nodes.AddDefaulted();
+
+	FNode& Node     = Nodes[NodeIndex];
+	Node.ExpiryTick = CurrentTick + FMath::Clamp<uint64>(DelayTicks, 1, MaxDelayTicks);
+	Link(NodeIndex);
+	++NumScheduled;
+
+	return FTimerIdBB{NodeIndex, Node.Generation};
+}
+
+bool FTimingWheelBB::Cancel(FTimerIdBB TimerId)
+{
+	if (!IsScheduled(TimerId)) return false;
+
+	FNode& Node = Nodes[TimerId.Index];
+	Unlink(TimerId.Index);
+	++Node.Generation;
+	FreeNodes.Add(TimerId.Index);
+	--NumScheduled;
+	return true;
+}
+
+bool FTimingWheelBB::IsScheduled(FTimerIdBB TimerId) const
+{
+	return Nodes.IsValidIndex(TimerId.Index) &&
+		Nodes[TimerId.Index].Slot != INDEX_NONE &&
+		Nodes[TimerId.Index].Generation == TimerId.Generation;
+}
+
+void FTimingWheelBB::Advance(uint64 NumTicks, TFunctionRef<void(FTimerIdBB)> OnExpired)
+{
+	for (uint64 Tick = 0; Tick < NumTicks; ++Tick)
+	{
+		// Nothing to do, so skip straight to the end.
+		if (NumScheduled == 0)
+		{
+			CurrentTick += NumTicks - Tick;
+			return;
+		}
+
+		++CurrentTick;
+
+		// When a level wraps around, bring the next slot of the level above down.
+		// Highest first, as what comes down from one level may need to go down another.
+		for (int32 Level = NumLevels - 1; Level > 0; --Level)
+		{
+			if ((CurrentTick & ((1ull << (SlotBits * Level)) - 1)) == 0)
+				Cascade(Level);
+		}
+
+		// Everything in the current level 0 slot expires now.
+		// Free them all before calling anyone, so the callbacks can do what they like with the wheel.
+		Expired.Reset();
+		int32& Head = SlotHeads[CurrentTick & SlotMask];
+		while (Head != INDEX_NONE)
+		{
+			const int32 NodeIndex = Head;
+			FNode&      Node      = Nodes[NodeIndex];
+			Expired.Add(FTimerIdBB{NodeIndex, Node.Generation});
+			Unlink(NodeIndex);
+			++Node.Generation;
+			FreeNodes.Add(NodeIndex);
+			--NumScheduled;
+		}
+
+		for (const FTimerIdBB& TimerId : Expired)
+		{
+			OnExpired(TimerId);
+		}
+	}
+}
+
+void FTimingWheelBB::Reserve(int32 NumTimers)
+{
+	Nodes.Reserve(NumTimers);
+	FreeNodes.Reserve(NumTimers);
+	Expired.Reserve(FMath::Min(NumTimers, 4096));
+}
+
+void FTimingWheelBB::Reset()
+{
+	// The nodes are freed rather than thrown away, so their generations carry on counting up,
+	// and an id from before the reset can never match a timer scheduled after it.
+	// Backwards, so the lowest nodes are reused first, as they would be in a new wheel.
+	FreeNodes.Reset();
+	for (int32 NodeIndex = Nodes.Num() - 1; NodeIndex >= 0; --NodeIndex)
+	{
+		FNode& Node = Nodes[NodeIndex];
+		if (Node.Slot != INDEX_NONE) ++Node.Generation;
+		Node.Prev = INDEX_NONE;
+		Node.Next = INDEX_NONE;
+		Node.Slot = INDEX_NONE;
+		FreeNodes.Add(NodeIndex);
+	}
+
+	for (int32& Head : SlotHeads)
+	{
+		Head = INDEX_NONE;
+	}
+	CurrentTick  = 0;
+	NumScheduled = 0;
+}
+
+void FTimingWheelBB::Link(int32 NodeIndex)
+{
+	FNode& Node = Nodes[NodeIndex];
+
+	// The level is decided by the highest 'digit' in which the expiry differs from now.
+	// Within a level, the slot is that digit of the expiry.
+	const uint64 Difference = Node.ExpiryTick ^ CurrentTick;
+	int32        Level      = 0;
+	while (Level < NumLevels - 1 && (Difference >> (SlotBits * (Level + 1))) != 0)
+	{
+		++Level;
+	}
+
+	Node.Slot  = Level * NumSlots + static_cast<int32>((Node.ExpiryTick >> (SlotBits * Level)) & SlotMask);
+	Node.Prev  = INDEX_NONE;
+	Node.Next  = SlotHeads[Node.Slot];
+	if (Node.Next != INDEX_NONE) Nodes[Node.Next].Prev = NodeIndex;
+	SlotHeads[Node.Slot] = NodeIndex;
+}
+
+void FTimingWheelBB::Unlink(int32 NodeIndex)
+{
+	FNode& Node = Nodes[NodeIndex];
+
+	if (Node.Prev != INDEX_NONE)
+		Nodes[Node.Prev].Next = Node.Next;
+	else
+		SlotHeads[Node.Slot] = Node.Next;
+
+	if (Node.Next != INDEX_NONE) Nodes[Node.Next].Prev = Node.Prev;
+
+	Node.Prev = INDEX_NONE;
+	Node.Next = INDEX_NONE;
+	Node.Slot = INDEX_NONE;
+}
+
+void FTimingWheelBB::Cascade(int32 Level)
+{
+	const int32 Slot      = Level * NumSlots + static_cast<int32>((CurrentTick >> (SlotBits * Level)) & SlotMask);
+	int32       NodeIndex = SlotHeads[Slot];
+	SlotHeads[Slot]       = INDEX_NONE;
+
+	while (NodeIndex != INDEX_NONE)
+	{
+		const int32 Next = Nodes[NodeIndex].Next;
+		Link(NodeIndex);
+		NodeIndex = Next;
+	}
+}
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Identifies a single timer in an FTimingWheelBB.
+// The generation stops an old id from cancelling a newer timer which reused the same node.
+struct FTimerIdBB
+{
+	int32  Index      = INDEX_NONE;
+	uint32 Generation = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+};
+
+/* A hierarchical timing wheel. Timers are counted in whole ticks,
+ * the owner decides how long a tick is and calls Advance.
+ *
+ * There are 4 levels of 256 slots. Level 0 holds timers due in the next 256 ticks,
+ * level 1 those due in the next 65536, and so on. Each slot is a linked list of nodes,
+ * so scheduling and cancelling are O(1), and when a lower level wraps around
+ * the matching slot from the level above is moved down ('cascaded').
+ * Every timer is cascaded at most 3 times, so expiry is O(1) per timer too.
+ *
+ * Nodes live in a single array and are recycled, so once the array has grown
+ * to the peak number of timers, nothing allocates. */
+class BUILDINGBLOCKS_API FTimingWheelBB
+{
+public:
+	static constexpr int32  NumLevels = 4;
+	static constexpr int32  SlotBits  = 8;
+	static constexpr int32  NumSlots  = 1 << SlotBits;
+	static constexpr uint64 SlotMask  = NumSlots - 1;
+
+	// The longest delay which can be scheduled, anything longer is clamped to this.
+	static constexpr uint64 MaxDelayTicks = (1ull << (SlotBits * (NumLevels - 1))) * (NumSlots - 1);
+
+	FTimingWheelBB();
+
+	// Schedule a timer to expire DelayTicks from now (at least 1).
+	FTimerIdBB Schedule(uint64 DelayTicks);
+
+	// Stop a timer from expiring. Returns false if it already expired, or was already cancelled.
+	bool Cancel(FTimerIdBB TimerId);
+
+	bool IsScheduled(FTimerIdBB TimerId) const;
+
+	// Move time on by NumTicks, calling OnExpired for every timer which expires.
+	// OnExpired is free to schedule and cancel other timers.
+	void Advance(uint64 NumTicks, TFunctionRef<void(FTimerIdBB)> OnExpired);
+
+	// Make room for this many timers, so scheduling them won't allocate.
+	void Reserve(int32 NumTimers);
+
+	// Throw away every timer, without calling anything, and go back to tick 0.
+	// Ids from before stay invalid, and the nodes are kept, so rescheduling doesn't allocate.
+	void Reset();
+
+	uint64 GetCurrentTick() const { return CurrentTick; }
+	int32  Num() const { return NumScheduled; }
+
+private:
+	struct FNode
+	{
+		uint64 ExpiryTick = 0;
+		int32  Prev       = INDEX_NONE;
+		int32  Next       = INDEX_NONE;
+		int32  Slot       = INDEX_NONE; // INDEX_NONE when the node is free
+		uint32 Generation = 0;
+	};
+
+	// Put a node into the slot its ExpiryTick belongs in, relative to the current tick.
+	void Link(int32 NodeIndex);
+
+	// Take a node out of whichever slot it is in.
+	void Unlink(int32 NodeIndex);
+
+	// Move every node in a slot down to where it now belongs.
+	void Cascade(int32 Level);
+
+	TArray<FNode> Nodes;
+	TArray<int32> FreeNodes;
+	int32         SlotHeads[NumLevels * NumSlots];
+
+	// Reused between Advance calls, so expiring timers doesn't allocate.
+	TArray<FTimerIdBB> Expired;
+
+	uint64 CurrentTick  = 0;
+	int32  NumScheduled = 0;
+};
@@ -11,5 +11,6 @@ public class BuildingBlocksEditorTarget : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V2;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_1;
 		ExtraModuleNames.Add("BuildingBlocks");
+		ExtraModuleNames.Add("BuildingBlocksUI");
 	}
 }
@@ -0,0 +1,17 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+// Dedicated server. Only the gameplay module is built,
+// BuildingBlocksUI (the HUD and widgets) is ClientOnly and left out entirely.
+public class BuildingBlocksServerTarget : TargetRules
+{
+	public BuildingBlocksServerTarget( TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Server;
+		DefaultBuildSettings = BuildSettingsVersion.V2;
+		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_1;
+		ExtraModuleNames.Add("BuildingBlocks");
+	}
+}
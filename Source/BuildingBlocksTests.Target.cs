@@ -0,0 +1,21 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+// A Core-only Low Level Tests program, see BuildingBlocksTests.Build.cs.
+[SupportedPlatforms(UnrealPlatformClass.Desktop)]
+public class BuildingBlocksTestsTarget : TestTargetRules
+{
+	public BuildingBlocksTestsTarget(TargetInfo Target) : base(Target)
+	{
+		DefaultBuildSettings = BuildSettingsVersion.V2;
+		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_1;
+
+		// No engine and no UObjects, so there's no project to load and it runs in a second or two.
+		bCompileAgainstEngine = false;
+		bCompileAgainstCoreUObject = false;
+		bCompileAgainstApplicationCore = false;
+		bUsesSlate = false;
+	}
+}
@@ -0,0 +1,27 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using System.IO;
+using UnrealBuildTool;
+
+// Low Level Tests (Catch2) for the bits of the game which only need Core: the stat bar text, view mode cycling
+// and the stat rules, with ns/op for each, and the stat snapshot seqlock under stress.
+// Unlike the commandlets, these don't need the editor or the project, so CI can run them on every change:
+//   Build the BuildingBlocksTests target, then run BuildingBlocksTests[.exe] from Binaries
+public class BuildingBlocksTests : TestModuleRules
+{
+	public BuildingBlocksTests(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		// Only the Core-only headers, the game and UI modules themselves need the engine.
+		PrivateIncludePaths.Add(Path.Combine(ModuleDirectory, "..", "BuildingBlocksUI", "Public"));
+		PrivateIncludePaths.Add(Path.Combine(ModuleDirectory, "..", "BuildingBlocks"));
+
+		PrivateDependencyModuleNames.AddRange(new string[]
+		{
+			"Core"
+		});
+
+		UpdateBuildGraphPropertiesFile(new Metadata { TestName = "BuildingBlocks", TestShortName = "BuildingBlocks" });
+	}
+}
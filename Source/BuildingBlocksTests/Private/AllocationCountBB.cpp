@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AllocationCountBB.h"
+#include "HAL/MemoryBase.h"
+
+// Per thread, so only the thread doing the counting is counted.
+static thread_local uint64 GNumAllocations = 0;
+static thread_local int32  GNumOpenCounts  = 0;
+
+// Passes everything on to the real allocator, counting on the way.
+class FCountingMallocBB final : public FMalloc
+{
+public:
+	explicit FCountingMallocBB(FMalloc* InInner)
+		: Inner(InInner)
+	{
+	}
+
+	virtual void* Malloc(SIZE_T Size, uint32 Alignment) override
+	{
+		Count();
+		return Inner->Malloc(Size, Alignment);
+	}
+
+	virtual void* Realloc(void* Ptr, SIZE_T NewSize, uint32 Alignment) override
+	{
+		// Growing or shrinking in place still costs a trip to the allocator, so it counts too.
+		if (NewSize > 0) Count();
+		return Inner->Realloc(Ptr, NewSize, Alignment);
+	}
+
+	virtual void Free(void* Ptr) override { Inner->Free(Ptr); }
+
+	virtual bool GetAllocationSize(void* Ptr, SIZE_T& OutSize) override
+	{
+		return Inner->GetAllocationSize(Ptr, OutSize);
+	}
+
+	virtual SIZE_T QuantizeSize(SIZE_T Size, uint32 Alignment) override { return Inner->QuantizeSize(Size, Alignment); }
+
+	virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+
+	virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+
+	virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+	{
+		Inner->ClearAndDisableTLSCachesOnCurrentThread();
+	}
+
+	virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+
+	virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+
+	virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+private:
+	static void Count()
+	{
+		if (GNumOpenCounts > 0) ++GNumAllocations;
+	}
+
+	FMalloc* Inner;
+};
+
+static void InstallCountingMalloc()
+{
+	static FCountingMallocBB* CountingMalloc = nullptr;
+	if (CountingMalloc) return;
+
+	// GMalloc is only created by the first allocation, which has long since happened by the time a test runs.
+	check(GMalloc);
+	CountingMalloc = new FCountingMallocBB(GMalloc);
+	GMalloc        = CountingMalloc;
+}
+
+FScopedAllocationCountBB::FScopedAllocationCountBB()
+{
+	InstallCountingMalloc();
+	++GNumOpenCounts;
+	NumAtStart = GNumAllocations;
+}
+
+FScopedAllocationCountBB::~FScopedAllocationCountBB()
+{
+	--GNumOpenCounts;
+}
+
+uint64 FScopedAllocationCountBB::GetNum() const
+{
+	return GNumAllocations - NumAtStart;
+}
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/* Counts the heap allocations made on this thread while it is in scope.
+ *
+ * The first one puts a counting allocator in front of GMalloc, the same way the engine's own proxies go in,
+ * and leaves it there for the rest of the run. That's only safe because the test program is single threaded
+ * and has nothing else allocating at the time, which is why this lives here, and not anywhere the game can use it. */
+class FScopedAllocationCountBB
+{
+public:
+	FScopedAllocationCountBB();
+	~FScopedAllocationCountBB();
+
+	// Allocations (and reallocations) since this was made.
+	uint64 GetNum() const;
+
+private:
+	uint64 NumAtStart = 0;
+};
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+#include "TestHarness.h"
+
+/* Times Iterations calls of Function(Index), after a few to warm up, and reports the ns/op with the test results.
+ * Times vary from machine to machine, so they are only reported, not checked. Function returns something to sum,
+ * so the compiler can't throw away the calls being timed. */
+template <typename FunctionType>
+double BenchmarkNsPerOpBB(const char* Name, FunctionType&& Function, int32 Iterations = 1000000)
+{
+	static volatile int64 Sink = 0;
+
+	int64 Sum = 0;
+	for (int32 Index = 0; Index < FMath::Min(Iterations, 1000); ++Index) Sum += Function(Index);
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < Iterations; ++Index) Sum += Function(Index);
+	const double NsPerOp = (FPlatformTime::Seconds() - StartTime) * 1e9 / Iterations;
+	Sink                 = Sink + Sum;
+
+	WARN(Name << ": " << NsPerOp << " ns/op");
+	return NsPerOp;
+}
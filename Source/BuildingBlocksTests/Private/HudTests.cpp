@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AllocationCountBB.h"
+#include "BenchmarkBB.h"
+#include "HudViewModeOrderBB.h"
+#include "StatBarTextBB.h"
+#include "TestHarness.h"
+
+namespace
+{
+	// EHudViewMode needs UHT, so this stands in for it. HudBB.h checks the two match.
+	using FTestViewModeCycleBB = THudViewModeCycleBB<EHudViewModeOrderBB>;
+
+	constexpr int32 NumViewModes = static_cast<int32>(EHudViewModeOrderBB::Num);
+
+	struct FFormatCase
+	{
+		float        Value;
+		const TCHAR* Expected;
+	};
+
+	// Every range the formatting treats differently, and both sides of each boundary.
+	const FFormatCase FormatCases[] =
+	{
+		{0.f, TEXT("0.00")},
+		{7.f, TEXT("7.00")},
+		{5.5f, TEXT("5.50")},
+		{3.25f, TEXT("3.25")},
+		{50.f, TEXT("50.0")},
+		{99.9f, TEXT("99.9")},
+		{250.f, TEXT("250")},
+		{986.4f, TEXT("986")},
+		{1500.f, TEXT("1.5k")},
+		{12345.f, TEXT("12k")},
+	};
+}
+
+TEST_CASE("BuildingBlocks::StatBarText::FormatValue", "[BuildingBlocks][Hud]")
+{
+	for (const FFormatCase& Case : FormatCases)
+	{
+		const FString Text = FStatBarTextBB::FormatValue(Case.Value);
+		INFO(Case.Value << " gave " << TCHAR_TO_UTF8(*Text) << ", expected " << TCHAR_TO_UTF8(Case.Expected));
+		CHECK(Text == Case.Expected);
+	}
+}
+
+TEST_CASE("BuildingBlocks::StatBarText::Allocations", "[BuildingBlocks][Hud]")
+{
+	// The string SanitizeFloat makes, which is then cut down or padded in place. Runs on every stat change.
+	constexpr uint64 MaxAllocations = 1;
+
+	for (const FFormatCase& Case : FormatCases)
+	{
+		uint64 NumAllocations = 0;
+		{
+			const FScopedAllocationCountBB AllocationCount;
+			const FString                  Text = FStatBarTextBB::FormatValue(Case.Value);
+			NumAllocations                      = AllocationCount.GetNum();
+		}
+
+		INFO(Case.Value << " made " << NumAllocations << " allocations");
+		CHECK(NumAllocations <= MaxAllocations);
+	}
+}
+
+TEST_CASE("BuildingBlocks::StatBarText::Benchmark", "[BuildingBlocks][Hud][Benchmark]")
+{
+	BenchmarkNsPerOpBB("FormatValue", [](int32 Index)
+	{
+		return FStatBarTextBB::FormatValue(FormatCases[Index % UE_ARRAY_COUNT(FormatCases)].Value).Len();
+	});
+}
+
+TEST_CASE("BuildingBlocks::ViewMode::Cycle", "[BuildingBlocks][Hud]")
+{
+	SECTION("Wraps at both ends")
+	{
+		CHECK(FTestViewModeCycleBB::Next(EHudViewModeOrderBB::SensoryOverload) ==
+			EHudViewModeOrderBB::CleanAndPristine);
+		CHECK(FTestViewModeCycleBB::Previous(EHudViewModeOrderBB::CleanAndPristine) ==
+			EHudViewModeOrderBB::SensoryOverload);
+	}
+
+	SECTION("Visits every mode in order, both ways")
+	{
+		EHudViewModeOrderBB ViewMode = EHudViewModeOrderBB::CleanAndPristine;
+		for (int32 Step = 0; Step < NumViewModes; ++Step)
+		{
+			const int32 Before = static_cast<int32>(ViewMode);
+			ViewMode           = FTestViewModeCycleBB::Next(ViewMode);
+			CHECK(static_cast<int32>(ViewMode) == (Before + 1) % NumViewModes);
+		}
+		CHECK(ViewMode == EHudViewModeOrderBB::CleanAndPristine);
+
+		for (int32 Step = 0; Step < NumViewModes; ++Step)
+		{
+			const int32 Before = static_cast<int32>(ViewMode);
+			ViewMode           = FTestViewModeCycleBB::Previous(ViewMode);
+			CHECK(static_cast<int32>(ViewMode) == (Before + NumViewModes - 1) % NumViewModes);
+		}
+		CHECK(ViewMode == EHudViewModeOrderBB::CleanAndPristine);
+	}
+}
+
+TEST_CASE("BuildingBlocks::ViewMode::Benchmark", "[BuildingBlocks][Hud][Benchmark]")
+{
+	EHudViewModeOrderBB ViewMode = EHudViewModeOrderBB::CleanAndPristine;
+	BenchmarkNsPerOpBB("ViewMode cycle", [&ViewMode](int32 Index)
+	{
+		ViewMode = Index % 3 == 0 ? FTestViewModeCycleBB::Previous(ViewMode) : FTestViewModeCycleBB::Next(ViewMode);
+		return static_cast<int32>(ViewMode);
+	});
+}
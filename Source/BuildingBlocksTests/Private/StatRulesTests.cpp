@@ -0,0 +1,213 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BenchmarkBB.h"
+#include "StatRulesBB.h"
+#include "TestHarness.h"
+
+namespace
+{
+	// The fields of FCharacterSimStateBB the rules use, with the same defaults. That one is a USTRUCT, so needs UHT.
+	struct FTestSimStateBB
+	{
+		int32 CurrentHealth             = 100;
+		int32 MaxHealth                 = 100;
+		float PendingDamage             = 0.f;
+		float CurrentStamina            = 100.f;
+		float StaminaRecuperationFactor = 1.f;
+		float CurrentPsiPower           = 1000.f;
+		bool  bIsRunning                = false;
+		bool  bHasRan                   = false;
+		bool  bHasJumped                = false;
+		bool  bIsCrouched               = false;
+	};
+
+	constexpr float DeltaTime = FStatRulesBB::UpdateInterval;
+
+	bool IsNear(float Value, float Expected)
+	{
+		return FMath::IsNearlyEqual(Value, Expected, KINDA_SMALL_NUMBER);
+	}
+}
+
+TEST_CASE("BuildingBlocks::StatRules::Health", "[BuildingBlocks][Stats]")
+{
+	// Health clamps to -1..Max, and dead is dead.
+	FTestSimStateBB State;
+	CHECK(FStatRulesBB::ApplyHealthDelta(State, -30));
+	CHECK(State.CurrentHealth == 70);
+
+	FStatRulesBB::ApplyHealthDelta(State, 1000);
+	CHECK(State.CurrentHealth == State.MaxHealth);
+	CHECK_FALSE(FStatRulesBB::ApplyHealthDelta(State, 10));
+
+	FStatRulesBB::ApplyHealthDelta(State, -1000);
+	CHECK(State.CurrentHealth == -1);
+	CHECK_FALSE(FStatRulesBB::ApplyHealthDelta(State, 50));
+	CHECK(State.CurrentHealth == -1);
+}
+
+TEST_CASE("BuildingBlocks::StatRules::Stamina", "[BuildingBlocks][Stats]")
+{
+	// Exertion costs stamina, worst first, resting gets it back, and it stays within 0..Max.
+	const FStatTuningBB    Tuning;
+	const FStatModifiersBB NoModifiers;
+	FTestSimStateBB        State;
+
+	SECTION("A jump costs more than a run, and only the jump is paid for")
+	{
+		State.bHasJumped = true;
+		State.bHasRan    = true;
+		FStatRulesBB::Step(State, Tuning, NoModifiers, DeltaTime);
+		CHECK(IsNear(State.CurrentStamina, Tuning.MaxStamina - Tuning.JumpStaminaCost));
+		CHECK_FALSE(State.bHasJumped);
+		CHECK_FALSE(State.bHasRan);
+	}
+
+	SECTION("Running")
+	{
+		State.bHasRan = true;
+		FStatRulesBB::Step(State, Tuning, NoModifiers, DeltaTime);
+		CHECK(IsNear(State.CurrentStamina, Tuning.MaxStamina - Tuning.RunStaminaCost));
+	}
+
+	SECTION("Crouching gets the rebate")
+	{
+		State.CurrentStamina = 50.f;
+		State.bIsCrouched    = true;
+		FStatRulesBB::Step(State, Tuning, NoModifiers, DeltaTime);
+		CHECK(IsNear(State.CurrentStamina, 50.f + Tuning.RestStaminaRebate));
+	}
+
+	SECTION("Recovering stops at the max")
+	{
+		State.CurrentStamina = Tuning.MaxStamina - 0.5f;
+		FStatRulesBB::Step(State, Tuning, NoModifiers, DeltaTime);
+		CHECK(IsNear(State.CurrentStamina, Tuning.MaxStamina));
+	}
+
+	SECTION("Jumping with none left stops at 0")
+	{
+		State.CurrentStamina = 1.f;
+		State.bHasJumped     = true;
+		FStatRulesBB::Step(State, Tuning, NoModifiers, DeltaTime);
+		CHECK(State.CurrentStamina == 0.f);
+	}
+
+	SECTION("Jumping needs the whole cost")
+	{
+		State.CurrentStamina = Tuning.JumpStaminaCost;
+		CHECK(FStatRulesBB::CanJump(State, Tuning));
+		State.CurrentStamina = Tuning.JumpStaminaCost - 0.1f;
+		CHECK_FALSE(FStatRulesBB::CanJump(State, Tuning));
+	}
+
+	SECTION("Running needs some stamina")
+	{
+		State.CurrentStamina = 0.f;
+		CHECK_FALSE(FStatRulesBB::CanRun(State));
+	}
+
+	SECTION("Regen curves scale recovery but not exertion")
+	{
+		FRegenTableBB Double;
+		for (float& Sample : Double.Samples)
+		{
+			Sample = 2.f;
+		}
+
+		FStatModifiersBB Modifiers;
+		Modifiers.StaminaRegenTable = &Double;
+
+		State.CurrentStamina = 50.f;
+		FStatRulesBB::Step(State, Tuning, Modifiers, DeltaTime);
+		CHECK(IsNear(State.CurrentStamina, 50.f + 2.f * State.StaminaRecuperationFactor));
+
+		State.bHasRan = true;
+		FStatRulesBB::Step(State, Tuning, Modifiers, DeltaTime);
+		CHECK(IsNear(State.CurrentStamina, 52.f - Tuning.RunStaminaCost));
+	}
+}
+
+TEST_CASE("BuildingBlocks::StatRules::PsiPower", "[BuildingBlocks][Stats]")
+{
+	// Psi power recharges, drains, and pays for blasts.
+	const FStatTuningBB    Tuning;
+	const FStatModifiersBB NoModifiers;
+	FTestSimStateBB        State;
+
+	State.CurrentPsiPower = 500.f;
+	FStatRulesBB::Step(State, Tuning, NoModifiers, DeltaTime);
+	CHECK(IsNear(State.CurrentPsiPower, 500.f + Tuning.PsiRechargeRate));
+
+	FStatModifiersBB Drain;
+	Drain.PsiDrainPerSecond = 10.f;
+	State.CurrentPsiPower   = 500.f;
+	FStatRulesBB::Step(State, Tuning, Drain, DeltaTime);
+	const float Drained = 500.f + Tuning.PsiRechargeRate - Drain.PsiDrainPerSecond * DeltaTime;
+	CHECK(IsNear(State.CurrentPsiPower, Drained));
+
+	State.CurrentPsiPower   = 0.f;
+	Drain.PsiDrainPerSecond = 1000.f;
+	FStatRulesBB::Step(State, Tuning, Drain, DeltaTime);
+	CHECK(State.CurrentPsiPower == 0.f);
+
+	State.CurrentPsiPower = Tuning.PsiBlastCost - 1.f;
+	CHECK_FALSE(FStatRulesBB::TryPsiBlast(State, Tuning));
+	CHECK(State.CurrentPsiPower == Tuning.PsiBlastCost - 1.f);
+
+	State.CurrentPsiPower = Tuning.PsiBlastCost;
+	CHECK(FStatRulesBB::TryPsiBlast(State, Tuning));
+	CHECK(State.CurrentPsiPower == 0.f);
+}
+
+TEST_CASE("BuildingBlocks::StatRules::DamageOverTime", "[BuildingBlocks][Stats]")
+{
+	// Health is whole numbers, so the fractions carry over.
+	const FStatTuningBB Tuning;
+	FStatModifiersBB    Damage;
+	FTestSimStateBB     State;
+	Damage.DamagePerSecond = 3.f;
+
+	CHECK(FStatRulesBB::Step(State, Tuning, Damage, DeltaTime) == 1);
+	CHECK(FStatRulesBB::Step(State, Tuning, Damage, DeltaTime) == 2);
+	CHECK(IsNear(State.PendingDamage, 0.f));
+}
+
+TEST_CASE("BuildingBlocks::StatRules::RegenTable", "[BuildingBlocks][Stats]")
+{
+	CHECK(FRegenTableBB::GetFlat().Evaluate(0.f) == 1.f);
+	CHECK(FRegenTableBB::GetFlat().Evaluate(0.5f) == 1.f);
+
+	// Outside 0..1 clamps to the ends, in between lerps.
+	FRegenTableBB Ramp;
+	for (int32 Index = 0; Index < FRegenTableBB::NumSamples; ++Index)
+	{
+		Ramp.Samples[Index] = static_cast<float>(Index) / (FRegenTableBB::NumSamples - 1);
+	}
+	CHECK(Ramp.Evaluate(-1.f) == 0.f);
+	CHECK(IsNear(Ramp.Evaluate(2.f), 1.f));
+	CHECK(IsNear(Ramp.Evaluate(0.3f), 0.3f));
+}
+
+TEST_CASE("BuildingBlocks::StatRules::Benchmark", "[BuildingBlocks][Stats][Benchmark]")
+{
+	// What ACharacterBB::Tick does each update, with a bit of everything going on.
+	const FStatTuningBB Tuning;
+	FStatModifiersBB    Modifiers;
+	FTestSimStateBB     State;
+	Modifiers.DamagePerSecond   = 1.f;
+	Modifiers.PsiDrainPerSecond = 2.f;
+
+	BenchmarkNsPerOpBB("StatRules Step", [&](int32 Index)
+	{
+		State.bHasJumped  = (Index & 7) == 0 && FStatRulesBB::CanJump(State, Tuning);
+		State.bHasRan     = (Index & 3) == 1;
+		State.bIsCrouched = (Index & 15) == 2;
+		if ((Index & 31) == 3) FStatRulesBB::TryPsiBlast(State, Tuning);
+
+		const int32 Damage = FStatRulesBB::Step(State, Tuning, Modifiers, DeltaTime);
+		FStatRulesBB::ApplyHealthDelta(State, -Damage);
+		if (State.CurrentHealth <= 0) State.CurrentHealth = State.MaxHealth;
+		return State.CurrentHealth;
+	});
+}
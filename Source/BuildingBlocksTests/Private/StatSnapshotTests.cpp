@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "StatSnapshotBB.h"
+#include "HAL/PlatformTime.h"
+#include "TestHarness.h"
+#include <thread>
+
+TEST_CASE("BuildingBlocks::StatSnapshots::ReadWrite", "[BuildingBlocks][Snapshots]")
+{
+	TSeqLockBB<FStatSnapshotBB> Slot;
+	FStatSnapshotBB             Snapshot = FStatSnapshotStressBB::Make(1);
+
+	// Starts out empty.
+	CHECK(Slot.Read(Snapshot) == 0);
+	CHECK(Snapshot.Serial == 0);
+
+	Slot.Write(FStatSnapshotStressBB::Make(1234));
+	CHECK(Slot.TryRead(Snapshot));
+	CHECK(Snapshot.Health == 1234);
+	CHECK(FStatSnapshotStressBB::IsConsistent(Snapshot));
+
+	Snapshot.Stamina += 1.f;
+	CHECK_FALSE(FStatSnapshotStressBB::IsConsistent(Snapshot));
+}
+
+/* The same as bb.Snapshots.Stress, but short enough for every run: one writer, as on the game thread,
+ * against readers on every other core, all on a handful of slots so they nearly always collide.
+ * Build the target with ThreadSanitizer (-EnableTSan) to check the seqlock has no data races as well. */
+TEST_CASE("BuildingBlocks::StatSnapshots::Stress", "[BuildingBlocks][Snapshots]")
+{
+	constexpr int32  NumSlots = 8;
+	constexpr double Seconds  = 0.5;
+
+	TUniquePtr<TSeqLockBB<FStatSnapshotBB>[]> Slots = MakeUnique<TSeqLockBB<FStatSnapshotBB>[]>(NumSlots);
+	std::atomic<int32>                        NumSlotsUsed = NumSlots;
+	std::atomic<bool>                         bStop        = false;
+	const FStatSnapshotViewBB                 View(Slots.Get(), &NumSlotsUsed);
+
+	const int32 NumReaders = FMath::Max(2, static_cast<int32>(std::thread::hardware_concurrency()) - 1);
+	TArray<uint64> NumReads;
+	TArray<uint64> NumTorn;
+	NumReads.SetNumZeroed(NumReaders);
+	NumTorn.SetNumZeroed(NumReaders);
+
+	TArray<std::thread> Readers;
+	Readers.Reserve(NumReaders);
+	for (int32 ReaderIndex = 0; ReaderIndex < NumReaders; ++ReaderIndex)
+	{
+		Readers.Emplace([&View, &bStop, &NumReads, &NumTorn, ReaderIndex]()
+		{
+			FStatSnapshotBB Snapshot;
+			for (int32 Index = ReaderIndex; !bStop.load(std::memory_order_relaxed); ++Index)
+			{
+				if (View.Read(Index % View.Num(), Snapshot) && !FStatSnapshotStressBB::IsConsistent(Snapshot))
+					++NumTorn[ReaderIndex];
+				++NumReads[ReaderIndex];
+			}
+		});
+	}
+
+	uint32       Counter = 0;
+	const double EndTime = FPlatformTime::Seconds() + Seconds;
+	while (FPlatformTime::Seconds() < EndTime)
+	{
+		for (int32 Batch = 0; Batch < 1024; ++Batch, ++Counter)
+		{
+			Slots[Counter % NumSlots].Write(FStatSnapshotStressBB::Make(Counter));
+		}
+	}
+	bStop.store(true, std::memory_order_relaxed);
+
+	uint64 TotalReads = 0;
+	uint64 TotalTorn  = 0;
+	for (int32 ReaderIndex = 0; ReaderIndex < NumReaders; ++ReaderIndex)
+	{
+		Readers[ReaderIndex].join();
+		TotalReads += NumReads[ReaderIndex];
+		TotalTorn  += NumTorn[ReaderIndex];
+	}
+
+	INFO(Counter << " writes, " << TotalReads << " reads on " << NumReaders << " threads");
+	CHECK(TotalReads > 0);
+	CHECK(TotalTorn == 0);
+}
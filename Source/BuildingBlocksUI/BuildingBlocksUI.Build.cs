@@ -0,0 +1,32 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+// Everything only a client needs: the HUD, the widgets, and screenshot/frame capture.
+// Marked ClientOnly in the .uproject, so dedicated servers never build or load it.
+public class BuildingBlocksUI : ModuleRules
+{
+	public BuildingBlocksUI(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[]
+		{
+			"Core",
+			"CoreUObject",
+			"Engine",
+			"UMG",
+			"Slate",
+			"SlateCore",
+			"BuildingBlocks"
+		});
+
+		PrivateDependencyModuleNames.AddRange(new string[]
+		{
+			"ImageCore",
+			"ImageWrapper",
+			"RHI",
+			"RenderCore"
+		});
+	}
+}
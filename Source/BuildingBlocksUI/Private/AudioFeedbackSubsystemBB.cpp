@@ -0,0 +1,334 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AudioFeedbackSubsystemBB.h"
+#include "CharacterPoolSubsystemBB.h"
+#include "CustomLogging.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Components/AudioComponent.h"
+#include "Sound/SoundBase.h"
+
+// Sounds which loop, or don't know how long they are, count as playing for this long.
+static constexpr double MaxCueSeconds = 10.0;
+
+static const TCHAR* GetAudioFeedbackEventName(EAudioFeedbackEventBB Event)
+{
+	switch (Event)
+	{
+	case EAudioFeedbackEventBB::HealthLost: return TEXT("HealthLost");
+	case EAudioFeedbackEventBB::HealthGained: return TEXT("HealthGained");
+	case EAudioFeedbackEventBB::Died: return TEXT("Died");
+	case EAudioFeedbackEventBB::StaminaEmpty: return TEXT("StaminaEmpty");
+	case EAudioFeedbackEventBB::PsiSpent: return TEXT("PsiSpent");
+	case EAudioFeedbackEventBB::KeyAdded: return TEXT("KeyAdded");
+	case EAudioFeedbackEventBB::KeyRemoved: return TEXT("KeyRemoved");
+	case EAudioFeedbackEventBB::KeyActionFailed: return TEXT("KeyActionFailed");
+	default: return TEXT("Unknown");
+	}
+}
+
+static FAutoConsoleCommandWithWorld GAudioStatsCommand(
+	TEXT("bb.Audio.Stats"),
+	TEXT("Log how many feedback sounds have played, and how many were dropped and why."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (!World) return;
+		const UAudioFeedbackSubsystemBB* AudioFeedback = World->GetSubsystem<UAudioFeedbackSubsystemBB>();
+		if (!AudioFeedback) return;
+
+		BBLOG(Display, "Audio feedback (played / too many / too soon / no free component):");
+		for (int32 EventIndex = 0; EventIndex < static_cast<int32>(EAudioFeedbackEventBB::Count); ++EventIndex)
+		{
+			const EAudioFeedbackEventBB                   Event = static_cast<EAudioFeedbackEventBB>(EventIndex);
+			const UAudioFeedbackSubsystemBB::FEventStats& Stats = AudioFeedback->GetEventStats(Event);
+			BBLOG(Display, "  {0}: {1} / {2} / {3} / {4}", GetAudioFeedbackEventName(Event), Stats.NumPlayed,
+			      Stats.NumTooMany, Stats.NumTooSoon, Stats.NumNoFreeComponent);
+		}
+	}));
+
+static FAutoConsoleCommandWithArgs GAudioTestCommand(
+	TEXT("bb.Audio.Test"),
+	TEXT("Run the cue limits against a crowd of characters all losing health, without any audio. ")
+	TEXT("Arguments: [NumCharacters=200] [Seconds=10] [MaxConcurrent=4] [MaxPerSecond=8]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumCharacters = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 200;
+		const float Seconds       = Args.Num() > 1 ? FMath::Max(0.1f, FCString::Atof(*Args[1])) : 10.f;
+		const int32 MaxConcurrent = Args.Num() > 2 ? FMath::Max(1, FCString::Atoi(*Args[2])) : 4;
+		const float MaxPerSecond  = Args.Num() > 3 ? FMath::Max(0.f, FCString::Atof(*Args[3])) : 8.f;
+
+		// Each character takes damage twice a second, at its own moment, with a half second sound each time.
+		constexpr double FrameSeconds  = 1.0 / 60.0;
+		constexpr double SoundSeconds  = 0.5;
+		constexpr double EventInterval = 0.5;
+
+		FRandomStream  Random(1234);
+		TArray<double> NextEventTimes;
+		NextEventTimes.SetNumUninitialized(NumCharacters);
+		for (double& Time : NextEventTimes)
+		{
+			Time = Random.FRand() * EventInterval;
+		}
+
+		FAudioCueLimiterBB Limiter;
+		int32              NumEvents  = 0;
+		int32              NumPlayed  = 0;
+		int32              NumTooMany = 0;
+		int32              NumTooSoon = 0;
+		int32              MaxInFrame = 0;
+
+		for (double Now = 0.0; Now < Seconds; Now += FrameSeconds)
+		{
+			int32 PlayedInFrame = 0;
+			for (double& NextEventTime : NextEventTimes)
+			{
+				if (NextEventTime > Now) continue;
+				NextEventTime += EventInterval;
+				++NumEvents;
+
+				switch (Limiter.TryStart(MaxConcurrent, MaxPerSecond, Now, SoundSeconds))
+				{
+				case FAudioCueLimiterBB::EResult::Play: ++NumPlayed;
+					++PlayedInFrame;
+					break;
+				case FAudioCueLimiterBB::EResult::TooMany: ++NumTooMany;
+					break;
+				case FAudioCueLimiterBB::EResult::TooSoon: ++NumTooSoon;
+					break;
+				}
+			}
+			MaxInFrame = FMath::Max(MaxInFrame, PlayedInFrame);
+		}
+
+		BBLOG(Log, "Audio cue limits, {0} characters for {1} s (at most {2} at once, {3} a second):", NumCharacters,
+		      Seconds, MaxConcurrent, MaxPerSecond);
+		BBLOG(Log, "  {0} events: {1} played ({2} a second), {3} too many, {4} too soon, most started in a frame {5}",
+		      NumEvents, NumPlayed, NumPlayed / Seconds, NumTooMany, NumTooSoon, MaxInFrame);
+	}));
+
+FAudioCueLimiterBB::EResult FAudioCueLimiterBB::TryStart(int32 MaxConcurrent, float MaxPerSecond, double Now,
+                                                         double Duration)
+{
+	if (Now < NextAllowedTime) return EResult::TooSoon;
+
+	// Forget the ones which have finished.
+	EndTimes.RemoveAllSwap([Now](double EndTime) { return EndTime <= Now; }, false);
+	if (EndTimes.Num() >= MaxConcurrent) return EResult::TooMany;
+
+	EndTimes.Add(Now + Duration);
+	NextAllowedTime = MaxPerSecond > 0.f ? Now + 1.0 / MaxPerSecond : Now;
+	return EResult::Play;
+}
+
+void FAudioCueLimiterBB::Reset()
+{
+	EndTimes.Reset();
+	NextAllowedTime = 0.0;
+}
+
+void UAudioFeedbackListenerBB::Bind()
+{
+	ACharacterBB* Target = Character.Get();
+	if (!Target) return;
+
+	Target->OnHealthChanged.AddUniqueDynamic(this, &UAudioFeedbackListenerBB::HandleHealthChanged);
+	Target->OnPlayerDied.AddUniqueDynamic(this, &UAudioFeedbackListenerBB::HandlePlayerDied);
+	Target->OnStaminaChanged.AddUniqueDynamic(this, &UAudioFeedbackListenerBB::HandleStaminaChanged);
+	Target->OnPsiPowerChanged.AddUniqueDynamic(this, &UAudioFeedbackListenerBB::HandlePsiPowerChanged);
+	Target->OnKeyWalletAction.AddUniqueDynamic(this, &UAudioFeedbackListenerBB::HandleKeyWalletAction);
+}
+
+void UAudioFeedbackListenerBB::HandleHealthChanged(int32 OldValue, int32 NewValue, int32 MaxValue)
+{
+	// Changes to the max alone don't make a sound.
+	if (NewValue < OldValue) Play(EAudioFeedbackEventBB::HealthLost);
+	else if (NewValue > OldValue) Play(EAudioFeedbackEventBB::HealthGained);
+}
+
+void UAudioFeedbackListenerBB::HandlePlayerDied()
+{
+	Play(EAudioFeedbackEventBB::Died);
+}
+
+void UAudioFeedbackListenerBB::HandleStaminaChanged(float OldValue, float NewValue, float MaxValue)
+{
+	// Stamina changes every update, only running out is worth a sound.
+	if (NewValue <= 0.f && OldValue > 0.f) Play(EAudioFeedbackEventBB::StaminaEmpty);
+}
+
+void UAudioFeedbackListenerBB::HandlePsiPowerChanged(float OldValue, float NewValue, float MaxValue)
+{
+	const UAudioFeedbackSubsystemBB* AudioFeedback = GetTypedOuter<UAudioFeedbackSubsystemBB>();
+	if (AudioFeedback && OldValue - NewValue >= AudioFeedback->GetPsiSpentFraction() * MaxValue)
+		Play(EAudioFeedbackEventBB::PsiSpent);
+}
+
+void UAudioFeedbackListenerBB::HandleKeyWalletAction(FString KeyString, EPlayerKeyAction KeyAction, bool IsSuccess)
+{
+	if (!IsSuccess) Play(EAudioFeedbackEventBB::KeyActionFailed);
+	else if (KeyAction == EPlayerKeyAction::AddKey) Play(EAudioFeedbackEventBB::KeyAdded);
+	else if (KeyAction == EPlayerKeyAction::RemoveKey) Play(EAudioFeedbackEventBB::KeyRemoved);
+}
+
+void UAudioFeedbackListenerBB::Play(EAudioFeedbackEventBB Event) const
+{
+	const ACharacterBB* Target = Character.Get();
+	if (!Target) return;
+
+	if (UAudioFeedbackSubsystemBB* AudioFeedback = GetTypedOuter<UAudioFeedbackSubsystemBB>())
+		AudioFeedback->PlayEvent(Event, Target->GetActorLocation());
+}
+
+void UAudioFeedbackSubsystemBB::SetCues(UAudioFeedbackCuesBB* InCues)
+{
+	Cues = InCues;
+	if (!Cues) return;
+
+	UWorld* World = GetWorld();
+
+	// All the components there will ever be, made now rather than as sounds are played.
+	const int32 NumComponents = FMath::Clamp(Cues->NumComponents, 1, 128);
+	while (Components.Num() < NumComponents)
+	{
+		UAudioComponent* Component = NewObject<UAudioComponent>(this);
+		Component->bAutoActivate        = false;
+		Component->bAutoDestroy         = false;
+		Component->bAllowSpatialization = true;
+		Component->RegisterComponentWithWorld(World);
+		Components.Add(Component);
+	}
+	ComponentBusyUntil.SetNumZeroed(Components.Num());
+
+	for (FAudioCueLimiterBB& Limiter : Limiters)
+	{
+		Limiter.Reset();
+	}
+
+	// Only needs doing once, whatever cues come after.
+	if (ActorSpawnedHandle.IsValid()) return;
+
+	for (ACharacterBB* Character : TActorRange<ACharacterBB>(World))
+	{
+		Watch(Character);
+	}
+
+	ActorSpawnedHandle = World->AddOnActorSpawnedHandler(
+		FOnActorSpawned::FDelegate::CreateUObject(this, &UAudioFeedbackSubsystemBB::OnActorSpawned));
+
+	if (UCharacterPoolSubsystemBB* CharacterPool = World->GetSubsystem<UCharacterPoolSubsystemBB>())
+		CharacterAcquiredHandle = CharacterPool->OnCharacterAcquired.AddUObject(
+			this, &UAudioFeedbackSubsystemBB::Watch);
+}
+
+void UAudioFeedbackSubsystemBB::Watch(ACharacterBB* Character)
+{
+	if (!Character) return;
+
+	TObjectPtr<UAudioFeedbackListenerBB>& Listener = Listeners.FindOrAdd(Character);
+	if (!Listener)
+	{
+		Listener            = NewObject<UAudioFeedbackListenerBB>(this);
+		Listener->Character = Character;
+		Character->OnDestroyed.AddUniqueDynamic(this, &UAudioFeedbackSubsystemBB::HandleCharacterDestroyed);
+	}
+	Listener->Bind();
+}
+
+bool UAudioFeedbackSubsystemBB::PlayEvent(EAudioFeedbackEventBB Event, const FVector& Location)
+{
+	const FAudioFeedbackCueBB* Cue = Cues ? Cues->Cues.Find(Event) : nullptr;
+	if (!Cue || !Cue->Sound) return false;
+
+	const int32  EventIndex = static_cast<int32>(Event);
+	FEventStats& EventStats = Stats[EventIndex];
+	const double Now        = GetWorld()->GetRealTimeSeconds();
+
+	// Find a free component before touching the limiter, so a dropped sound doesn't count as playing.
+	int32 ComponentIndex = INDEX_NONE;
+	for (int32 Index = 0; Index < Components.Num(); ++Index)
+	{
+		if (ComponentBusyUntil[Index] <= Now && !Components[Index]->IsPlaying())
+		{
+			ComponentIndex = Index;
+			break;
+		}
+	}
+
+	if (ComponentIndex == INDEX_NONE)
+	{
+		++EventStats.NumNoFreeComponent;
+		return false;
+	}
+
+	const float  SoundDuration = Cue->Sound->GetDuration();
+	const double Duration      = SoundDuration > 0.f ? FMath::Min<double>(SoundDuration, MaxCueSeconds) : MaxCueSeconds;
+	switch (Limiters[EventIndex].TryStart(Cue->MaxConcurrent, Cue->MaxPerSecond, Now, Duration))
+	{
+	case FAudioCueLimiterBB::EResult::TooMany: ++EventStats.NumTooMany;
+		return false;
+	case FAudioCueLimiterBB::EResult::TooSoon: ++EventStats.NumTooSoon;
+		return false;
+	default: ;
+	}
+
+	UAudioComponent* Component = Components[ComponentIndex];
+	Component->SetSound(Cue->Sound);
+	Component->AttenuationSettings = Cue->Attenuation;
+	Component->SetVolumeMultiplier(Cue->VolumeMultiplier);
+	Component->SetWorldLocation(Location);
+	Component->Play();
+
+	ComponentBusyUntil[ComponentIndex] = Now + Duration;
+	++EventStats.NumPlayed;
+	return true;
+}
+
+float UAudioFeedbackSubsystemBB::GetPsiSpentFraction() const
+{
+	return Cues ? Cues->PsiSpentFraction : 1.f;
+}
+
+const UAudioFeedbackSubsystemBB::FEventStats& UAudioFeedbackSubsystemBB::GetEventStats(
+	EAudioFeedbackEventBB Event) const
+{
+	return Stats[static_cast<int32>(Event)];
+}
+
+void UAudioFeedbackSubsystemBB::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+		if (UCharacterPoolSubsystemBB* CharacterPool = World->GetSubsystem<UCharacterPoolSubsystemBB>())
+			CharacterPool->OnCharacterAcquired.Remove(CharacterAcquiredHandle);
+	}
+	ActorSpawnedHandle.Reset();
+	CharacterAcquiredHandle.Reset();
+
+	for (UAudioComponent* Component : Components)
+	{
+		if (Component) Component->DestroyComponent();
+	}
+	Components.Empty();
+	ComponentBusyUntil.Empty();
+	Listeners.Empty();
+	Cues = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool UAudioFeedbackSubsystemBB::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	// Only worlds which are actually played in.
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UAudioFeedbackSubsystemBB::OnActorSpawned(AActor* Actor)
+{
+	if (ACharacterBB* Character = Cast<ACharacterBB>(Actor)) Watch(Character);
+}
+
+void UAudioFeedbackSubsystemBB::HandleCharacterDestroyed(AActor* DestroyedActor)
+{
+	Listeners.Remove(Cast<ACharacterBB>(DestroyedActor));
+}
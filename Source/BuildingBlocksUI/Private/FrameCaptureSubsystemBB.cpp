@@ -0,0 +1,325 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FrameCaptureSubsystemBB.h"
+#include "CustomLogging.h"
+#include "MappedFileBB.h"
+#include "RenderingThread.h"
+#include "RHIGPUReadback.h"
+#include "Async/Async.h"
+#include "Engine/GameViewportClient.h"
+#include "Framework/Application/SlateApplication.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Rendering/SlateRenderer.h"
+
+// How many GPU copies can be waiting to be read back at once.
+// The readback is usually ready one or two frames after it was queued.
+static constexpr int32 NumFrameCaptureReadbacks = 3;
+
+struct FFrameCaptureStateBB
+{
+	FMappedFileBB File;
+
+	// These point into File
+	FFrameCaptureHeaderBB*     Header = nullptr;
+	FFrameCaptureIndexEntryBB* Index  = nullptr;
+
+	// Only ever compared against, never dereferenced, from the render thread.
+	const SWindow* Window = nullptr;
+
+	FSlateRenderer* Renderer = nullptr;
+	FDelegateHandle BackBufferReadyHandle;
+
+	// Told when the file fills up, so it can close it.
+	TWeakObjectPtr<UFrameCaptureSubsystemBB> Owner;
+
+	// Ring of GPU readbacks, and the index entry each one will be written with.
+	// Only touched on the render thread.
+	TUniquePtr<FRHIGPUTextureReadback> Readbacks[NumFrameCaptureReadbacks];
+	FFrameCaptureIndexEntryBB          PendingEntries[NumFrameCaptureReadbacks];
+	int32                              NextToEnqueue = 0;
+	int32                              NextToResolve = 0;
+	int32                              InFlight      = 0;
+
+	// Every frame left in the file has a copy in flight. Render thread only.
+	bool bFull = false;
+
+	std::atomic<bool>  bAccepting     = false;
+	std::atomic<int32> CapturedFrames = 0;
+	std::atomic<int32> DroppedFrames  = 0;
+
+	// Called on the render thread just before the back buffer is presented.
+	void OnBackBufferReady(SWindow& InWindow, const FTextureRHIRef& BackBuffer)
+	{
+		if (&InWindow != Window) return;
+
+		FRHICommandListImmediate& RHICmdList = FRHICommandListExecutor::GetImmediateCommandList();
+
+		// Write out any earlier frames which have finished copying, oldest first.
+		ResolveReadyFrames();
+
+		// No more copies once the file is spoken for, just wait for the last ones to land, then unhook.
+		if (bFull)
+		{
+			if (InFlight == 0) OnFileFull();
+			return;
+		}
+
+		if (!bAccepting) return;
+
+		const FIntPoint Size = BackBuffer->GetSizeXY();
+		if (InFlight == NumFrameCaptureReadbacks ||
+			Size.X != static_cast<int32>(Header->Width) ||
+			Size.Y != static_cast<int32>(Header->Height))
+		{
+			++DroppedFrames;
+			return;
+		}
+
+		// We only store 4 byte pixels, which covers both the usual BGRA8 and 10 bit HDR back buffers.
+		// The offline pass uses the header to tell which one it got.
+		const EPixelFormat Format = BackBuffer->GetFormat();
+		if (GPixelFormats[Format].BlockBytes != Header->BytesPerPixel)
+		{
+			++DroppedFrames;
+			return;
+		}
+		Header->PixelFormat = Format;
+
+		RHICmdList.Transition(FRHITransitionInfo(BackBuffer, ERHIAccess::Unknown, ERHIAccess::CopySrc));
+		Readbacks[NextToEnqueue]->EnqueueCopy(RHICmdList, BackBuffer);
+		RHICmdList.Transition(FRHITransitionInfo(BackBuffer, ERHIAccess::CopySrc, ERHIAccess::Present));
+
+		PendingEntries[NextToEnqueue].Seconds     = FPlatformTime::Seconds();
+		PendingEntries[NextToEnqueue].FrameNumber = GFrameNumberRenderThread;
+
+		NextToEnqueue = (NextToEnqueue + 1) % NumFrameCaptureReadbacks;
+		++InFlight;
+
+		if (Header->FrameCount + InFlight >= Header->MaxFrames) bFull = true;
+	}
+
+	// Render thread. Stops the callback, then has the game thread close the file.
+	void OnFileFull()
+	{
+		bAccepting = false;
+		Renderer->OnBackBufferReadyToPresent().Remove(BackBufferReadyHandle);
+		BackBufferReadyHandle.Reset();
+
+		AsyncTask(ENamedThreads::GameThread, [Owner = Owner, State = this]()
+		{
+			if (UFrameCaptureSubsystemBB* Capture = Owner.Get()) Capture->OnCaptureFull(State);
+		});
+	}
+
+	void ResolveReadyFrames()
+	{
+		while (InFlight > 0 && Readbacks[NextToResolve]->IsReady())
+		{
+			WriteFrame(*Readbacks[NextToResolve], PendingEntries[NextToResolve]);
+			NextToResolve = (NextToResolve + 1) % NumFrameCaptureReadbacks;
+			--InFlight;
+		}
+	}
+
+	void WriteFrame(FRHIGPUTextureReadback& Readback, const FFrameCaptureIndexEntryBB& Entry)
+	{
+		const uint32 FrameIndex = Header->FrameCount;
+		if (FrameIndex >= Header->MaxFrames)
+		{
+			// The file is full, shouldn't happen as copies stop once every frame left has one
+			++DroppedFrames;
+			return;
+		}
+
+		int32       RowPitchInPixels = 0;
+		const void* Source           = Readback.Lock(RowPitchInPixels);
+		if (!Source)
+		{
+			++DroppedFrames;
+			return;
+		}
+
+		// The readback rows are usually padded, so copy row by row into the tightly packed frame.
+		const SIZE_T RowBytes    = static_cast<SIZE_T>(Header->Width) * Header->BytesPerPixel;
+		const SIZE_T SourcePitch = static_cast<SIZE_T>(RowPitchInPixels) * Header->BytesPerPixel;
+		const uint8* SourceRow   = static_cast<const uint8*>(Source);
+		uint8*       DestRow     = File.GetData() + Header->FirstFrameOffset + FrameIndex * Header->FrameStride;
+
+		if (SourcePitch == RowBytes)
+		{
+			FMemory::Memcpy(DestRow, SourceRow, RowBytes * Header->Height);
+		}
+		else
+		{
+			for (uint32 Row = 0; Row < Header->Height; ++Row)
+			{
+				FMemory::Memcpy(DestRow, SourceRow, RowBytes);
+				DestRow += RowBytes;
+				SourceRow += SourcePitch;
+			}
+		}
+
+		Readback.Unlock();
+
+		// Publish the index entry before the count, so a reader never sees a frame without its entry.
+		Index[FrameIndex]  = Entry;
+		Header->FrameCount = FrameIndex + 1;
+		++CapturedFrames;
+	}
+};
+
+static FAutoConsoleCommandWithWorldAndArgs GFrameCaptureStartCommand(
+	TEXT("bb.Capture.Start"),
+	TEXT("Start a raw frame capture. Arguments: [Seconds=10] [ExpectedFrameRate=60] [FileName]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		if (UFrameCaptureSubsystemBB* Capture = GameInstance ? GameInstance->GetSubsystem<UFrameCaptureSubsystemBB>() : nullptr)
+		{
+			Capture->StartCapture(Args.Num() > 0 ? FCString::Atof(*Args[0]) : 10.f,
+			                      Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 60,
+			                      Args.Num() > 2 ? Args[2] : FString());
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld GFrameCaptureStopCommand(
+	TEXT("bb.Capture.Stop"),
+	TEXT("Stop the current raw frame capture."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		if (UFrameCaptureSubsystemBB* Capture = GameInstance ? GameInstance->GetSubsystem<UFrameCaptureSubsystemBB>() : nullptr)
+		{
+			Capture->StopCapture();
+		}
+	}));
+
+void UFrameCaptureSubsystemBB::Deinitialize()
+{
+	StopCapture();
+	Super::Deinitialize();
+}
+
+bool UFrameCaptureSubsystemBB::StartCapture(float Seconds, int32 ExpectedFrameRate, FString FileName)
+{
+	if (CaptureState)
+	{
+		BBLOG(Warning, "A frame capture is already running");
+		return false;
+	}
+
+	UGameViewportClient* GameViewport = GetGameInstance()->GetGameViewportClient();
+	if (!GameViewport || !GameViewport->GetWindow() || !FSlateApplication::IsInitialized() ||
+		!FSlateApplication::Get().GetRenderer())
+	{
+		BBLOG(Warning, "Frame capture needs a game viewport to capture");
+		return false;
+	}
+
+	TSharedPtr<FFrameCaptureStateBB, ESPMode::ThreadSafe> State = MakeShared<FFrameCaptureStateBB, ESPMode::ThreadSafe>();
+
+	// The back buffer is the size of the window, not the viewport
+	const FVector2D WindowSize = GameViewport->GetWindow()->GetSizeInScreen();
+
+	FFrameCaptureHeaderBB Header;
+	Header.Width         = static_cast<uint32>(WindowSize.X);
+	Header.Height        = static_cast<uint32>(WindowSize.Y);
+	Header.BytesPerPixel = 4;
+	Header.PixelFormat   = PF_B8G8R8A8;
+	Header.MaxFrames     = static_cast<uint32>(FMath::Max(1, FMath::CeilToInt(Seconds * ExpectedFrameRate)));
+	Header.FrameStride   = Align(static_cast<uint64>(Header.Width) * Header.Height * Header.BytesPerPixel, 4096);
+	Header.FirstFrameOffset = Align(sizeof(FFrameCaptureHeaderBB) +
+	                                sizeof(FFrameCaptureIndexEntryBB) * Header.MaxFrames, 4096);
+
+	if (FileName.IsEmpty())
+	{
+		FileName = FPaths::Combine(FPaths::ScreenShotDir(),
+		                           FString::Printf(TEXT("Capture_%s.bbfc"), *FDateTime::Now().ToString()));
+	}
+	FileName = FPaths::ConvertRelativePathToFull(FileName);
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(FileName), true);
+
+	// Sizing the whole file now means nothing needs allocating, or growing, while we capture.
+	const int64 FileSize = Header.FirstFrameOffset + Header.FrameStride * Header.MaxFrames;
+	if (!State->File.Open(FileName, FileSize)) return false;
+
+	State->Header  = reinterpret_cast<FFrameCaptureHeaderBB*>(State->File.GetData());
+	*State->Header = Header;
+	State->Index   = reinterpret_cast<FFrameCaptureIndexEntryBB*>(State->File.GetData() + sizeof(FFrameCaptureHeaderBB));
+
+	for (TUniquePtr<FRHIGPUTextureReadback>& Readback : State->Readbacks)
+	{
+		Readback = MakeUnique<FRHIGPUTextureReadback>(TEXT("BBFrameCapture"));
+	}
+
+	State->Window     = GameViewport->GetWindow().Get();
+	State->Renderer   = FSlateApplication::Get().GetRenderer();
+	State->Owner      = this;
+	State->bAccepting = true;
+
+	// The delegate is broadcast on the render thread, so only ever change it from there.
+	ENQUEUE_RENDER_COMMAND(BBFrameCaptureStart)([State](FRHICommandListImmediate&)
+	{
+		State->BackBufferReadyHandle = State->Renderer->OnBackBufferReadyToPresent().AddRaw(
+			State.Get(), &FFrameCaptureStateBB::OnBackBufferReady);
+	});
+
+	CaptureState = State;
+
+	BBLOG(Log, "Frame capture started {0}: {1}x{2}, up to {3} frames ({4} MB)", FileName,
+	      Header.Width, Header.Height, Header.MaxFrames, FileSize / (1024 * 1024));
+	return true;
+}
+
+void UFrameCaptureSubsystemBB::StopCapture()
+{
+	if (!CaptureState) return;
+
+	CaptureState->bAccepting = false;
+
+	// Unhook on the render thread, and give any copies which have finished one last chance to be written.
+	// Anything still on the GPU after that is dropped, it is only ever a frame or two.
+	TSharedPtr<FFrameCaptureStateBB, ESPMode::ThreadSafe> State = CaptureState;
+	ENQUEUE_RENDER_COMMAND(BBFrameCaptureStop)([State](FRHICommandListImmediate&)
+	{
+		State->Renderer->OnBackBufferReadyToPresent().Remove(State->BackBufferReadyHandle);
+		State->ResolveReadyFrames();
+		State->DroppedFrames += State->InFlight;
+		for (TUniquePtr<FRHIGPUTextureReadback>& Readback : State->Readbacks)
+		{
+			Readback.Reset();
+		}
+	});
+	FlushRenderingCommands();
+
+	BBLOG(Log, "Frame capture stopped: {0} frames written, {1} dropped",
+	      CaptureState->CapturedFrames.load(), CaptureState->DroppedFrames.load());
+
+	CaptureState->File.Close();
+	CaptureState.Reset();
+}
+
+void UFrameCaptureSubsystemBB::OnCaptureFull(const FFrameCaptureStateBB* State)
+{
+	// Unless it has been stopped, and maybe another started, since.
+	if (CaptureState.Get() != State) return;
+
+	BBLOG(Log, "Frame capture file is full");
+	StopCapture();
+}
+
+bool UFrameCaptureSubsystemBB::IsCapturing() const
+{
+	return CaptureState.IsValid();
+}
+
+int32 UFrameCaptureSubsystemBB::GetCapturedFrameCount() const
+{
+	return CaptureState ? CaptureState->CapturedFrames.load() : 0;
+}
+
+int32 UFrameCaptureSubsystemBB::GetDroppedFrameCount() const
+{
+	return CaptureState ? CaptureState->DroppedFrames.load() : 0;
+}
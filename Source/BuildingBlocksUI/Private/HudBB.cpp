@@ -0,0 +1,328 @@
+#include "HudBB.h"
+#include "AudioFeedbackSubsystemBB.h"
+#include "CustomLogging.h"
+#include "CharacterBB.h"
+#include "HSPBarBase.h"
+#include "MemoryTagsBB.h"
+#include "MinimalLayoutBase.h"
+#include "ModerateLayoutBase.h"
+#include "OverloadLayoutBase.h"
+#include "PlayerControllerBB.h"
+#include "StatBarBase.h"
+#include "Misc/Paths.h"
+
+AHudBB::AHudBB()
+{
+	// Only ticks while benchmarking view modes.
+	PrimaryActorTick.bCanEverTick          = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	// HudBB.h can only check the modes both enums have, not one added to the end of EHudViewMode. (-1 for _MAX)
+	ensureMsgf(StaticEnum<EHudViewMode>()->NumEnums() - 1 == static_cast<int32>(EHudViewModeOrderBB::Num),
+	           TEXT("EHudViewMode has a mode EHudViewModeOrderBB doesn't, add it there too"));
+}
+
+void AHudBB::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Grab a reference to the current world
+	World = GetWorld();
+	checkf(World, TEXT("Failed to reference world."));
+
+	// Ensure we have valid values for the 3 classes of widget used by the HUD
+	checkf(MinimalLayoutClass, TEXT("Invalid MinimalLayoutClass reference."));
+	checkf(ModerateLayoutClass, TEXT("Invalid ModerateLayoutClass reference."));
+	checkf(OverloadLayoutClass, TEXT("Invalid OverloadLayoutClass reference."));
+
+	// The layout widgets themselves are created by UpdateWidgets, the first time one is needed.
+
+	// The controller doesn't know about the HUD (it lives in a different module), so listen for it asking.
+	// On clients the pawn usually replicates in after the HUD exists, so the stat handlers are hooked up
+	// whenever the controller says it has a character, rather than only now.
+	if (APlayerControllerBBBase* PlayerController = Cast<APlayerControllerBBBase>(GetOwningPlayerController()))
+	{
+		PlayerController->OnCycleUIModeRequested.AddDynamic(this, &AHudBB::CycleToNextViewMode);
+		PlayerController->OnPlayerCharacterChanged.AddDynamic(this, &AHudBB::OnPlayerCharacterChanged);
+		PlayerCharacter = PlayerController->GetPlayerCharacter();
+	}
+
+	if (AudioFeedbackCues)
+	{
+		if (UAudioFeedbackSubsystemBB* AudioFeedback = World->GetSubsystem<UAudioFeedbackSubsystemBB>())
+			AudioFeedback->SetCues(AudioFeedbackCues);
+	}
+
+	// Set the initial viewmode to the 'current' one, which allows setting via the editor.
+	//SetCurrentViewMode(CurrentViewMode);
+	UpdateWidgets();
+}
+
+void AHudBB::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Benchmark.Stop();
+
+	// Release any event handlers
+	ClearAllHandlers();
+
+	if (APlayerControllerBBBase* PlayerController = Cast<APlayerControllerBBBase>(GetOwningPlayerController()))
+	{
+		PlayerController->OnCycleUIModeRequested.RemoveDynamic(this, &AHudBB::CycleToNextViewMode);
+		PlayerController->OnPlayerCharacterChanged.RemoveDynamic(this, &AHudBB::OnPlayerCharacterChanged);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AHudBB::DrawHUD()
+{
+	Super::DrawHUD();
+
+	if (CurrentViewMode == EHudViewMode::CanvasOnly) DrawCanvasStats();
+
+	NameplateRenderer.Draw(*this, *Canvas, NameplateSettings);
+}
+
+void AHudBB::SetCurrentViewMode(EHudViewMode NewViewMode)
+{
+	CurrentViewMode = NewViewMode;
+	UpdateWidgets();
+}
+
+void AHudBB::CycleToNextViewMode()
+{
+	++CurrentViewMode;
+	BBLOG(Log, "CycleToNextViewMode {0}", UEnum::GetValueAsString(CurrentViewMode));
+	UpdateWidgets();
+}
+
+void AHudBB::OnPlayerCharacterChanged(ACharacterBB* NewCharacter)
+{
+	// Unhook from the old character before forgetting it.
+	ClearAllHandlers();
+	PlayerCharacter = NewCharacter;
+	UpdateWidgets();
+}
+
+void AHudBB::UpdateWidgets()
+{
+	// Unhook any delegate handlers.
+	ClearAllHandlers();
+
+	// Nothing to show stats for yet, OnPlayerCharacterChanged calls back in here once there is.
+	if (!PlayerCharacter)
+	{
+		if (MinimalLayoutWidget) MinimalLayoutWidget->SetVisibility(ESlateVisibility::Collapsed);
+		if (ModerateLayoutWidget) ModerateLayoutWidget->SetVisibility(ESlateVisibility::Collapsed);
+		if (OverloadLayoutWidget) OverloadLayoutWidget->SetVisibility(ESlateVisibility::Collapsed);
+		return;
+	}
+
+	// DrawCanvasStats reads the stats itself every frame, so there's nothing to bind, and no widgets to keep.
+	if (CurrentViewMode == EHudViewMode::CanvasOnly)
+	{
+		ReleaseLayouts();
+		return;
+	}
+
+	CreateLayouts();
+
+	// Set all the widgets so we see none of them
+	MinimalLayoutWidget->SetVisibility(ESlateVisibility::Collapsed);
+	ModerateLayoutWidget->SetVisibility(ESlateVisibility::Collapsed);
+	OverloadLayoutWidget->SetVisibility(ESlateVisibility::Collapsed);
+
+	switch (CurrentViewMode)
+	{
+	case EHudViewMode::CleanAndPristine:
+		// Currently there isn't actually anything to do here!
+		break;
+	case EHudViewMode::Minimal:
+		PlayerCharacter->OnHealthChanged.AddDynamic(MinimalLayoutWidget->HSPBar->HealthBar,
+		                                            &UStatBarBase::OnIntStatUpdated);
+		PlayerCharacter->OnStaminaChanged.AddDynamic(MinimalLayoutWidget->HSPBar->StaminaBar,
+		                                             &UStatBarBase::OnFloatStatUpdated);
+		PlayerCharacter->OnPsiPowerChanged.AddDynamic(MinimalLayoutWidget->HSPBar->PsiBar,
+		                                              &UStatBarBase::OnFloatStatUpdated);
+		MinimalLayoutWidget->SetVisibility(ESlateVisibility::Visible);
+		break;
+	case EHudViewMode::Moderate:
+		PlayerCharacter->OnHealthChanged.AddDynamic(ModerateLayoutWidget->HSPBar->HealthBar,
+		                                            &UStatBarBase::OnIntStatUpdated);
+		PlayerCharacter->OnStaminaChanged.AddDynamic(ModerateLayoutWidget->HSPBar->StaminaBar,
+		                                             &UStatBarBase::OnFloatStatUpdated);
+		PlayerCharacter->OnPsiPowerChanged.AddDynamic(ModerateLayoutWidget->HSPBar->PsiBar,
+		                                              &UStatBarBase::OnFloatStatUpdated);
+		ModerateLayoutWidget->SetVisibility(ESlateVisibility::Visible);
+		break;
+	case EHudViewMode::SensoryOverload:
+		PlayerCharacter->OnHealthChanged.AddDynamic(OverloadLayoutWidget->HSPBar->HealthBar,
+		                                            &UStatBarBase::OnIntStatUpdated);
+		PlayerCharacter->OnStaminaChanged.AddDynamic(OverloadLayoutWidget->HSPBar->StaminaBar,
+		                                             &UStatBarBase::OnFloatStatUpdated);
+		PlayerCharacter->OnPsiPowerChanged.AddDynamic(OverloadLayoutWidget->HSPBar->PsiBar,
+		                                              &UStatBarBase::OnFloatStatUpdated);
+		PlayerCharacter->OnKeyWalletAction.AddDynamic(OverloadLayoutWidget, &UOverloadLayoutBase::OnKeyWalletAction);
+		OverloadLayoutWidget->SyncKeyWallet(PlayerCharacter->GetKeyWallet());
+		OverloadLayoutWidget->SetVisibility(ESlateVisibility::Visible);
+		break;
+	default: ;
+	}
+
+	// This ensures that even if something has not changed recently, the newly switched-to widget will get sent
+	// the latest character stats, so it can update itself.
+	PlayerCharacter->BroadcastCurrentStats();
+}
+
+void AHudBB::CreateLayouts()
+{
+	// create the 3 types of layout widget, and add them to the viewport
+	// We could have been 'clever' here, and had maybe a single widget which 'mutates'
+	// based on the requirements, but this IS a tutorial afterall, and we wanna keep it simple(er!)
+	// When creating a widget, the first parameter (owning object) must be one of the following types:
+	// UWidget, UWidgetTree, APlayerController, UGameInstance, or UWorld
+	LLM_SCOPE_BYTAG(BuildingBlocks_HudLayouts);
+
+	if (!MinimalLayoutWidget)
+	{
+		MinimalLayoutWidget = CreateWidget<UMinimalLayoutBase>(World, MinimalLayoutClass);
+		MinimalLayoutWidget->AddToViewport();
+		MinimalLayoutWidget->SetVisibility(ESlateVisibility::Collapsed);
+	}
+
+	if (!ModerateLayoutWidget)
+	{
+		ModerateLayoutWidget = CreateWidget<UModerateLayoutBase>(World, ModerateLayoutClass);
+		ModerateLayoutWidget->AddToViewport();
+		ModerateLayoutWidget->SetVisibility(ESlateVisibility::Collapsed);
+	}
+
+	if (!OverloadLayoutWidget)
+	{
+		OverloadLayoutWidget = CreateWidget<UOverloadLayoutBase>(World, OverloadLayoutClass);
+		OverloadLayoutWidget->AddToViewport();
+		OverloadLayoutWidget->SetVisibility(ESlateVisibility::Collapsed);
+	}
+}
+
+void AHudBB::ReleaseLayouts()
+{
+	// Once nothing references them, the garbage collector gets rid of them.
+	if (MinimalLayoutWidget) MinimalLayoutWidget->RemoveFromParent();
+	if (ModerateLayoutWidget) ModerateLayoutWidget->RemoveFromParent();
+	if (OverloadLayoutWidget) OverloadLayoutWidget->RemoveFromParent();
+
+	MinimalLayoutWidget  = nullptr;
+	ModerateLayoutWidget = nullptr;
+	OverloadLayoutWidget = nullptr;
+}
+
+void AHudBB::DrawCanvasStats()
+{
+	if (!PlayerCharacter) return;
+
+	// Bottom left, the same colours as the default stat bar style.
+	constexpr float Left      = 40.f;
+	constexpr float BarWidth  = 200.f;
+	constexpr float BarHeight = 12.f;
+	constexpr float Spacing   = 6.f;
+	float           Top       = Canvas->ClipY - 40.f - 3.f * (BarHeight + Spacing);
+
+	struct FCanvasBar
+	{
+		float        Value;
+		float        MaxValue;
+		FLinearColor Color;
+	};
+
+	const FCanvasBar Bars[] = {
+		{static_cast<float>(PlayerCharacter->GetHealth()), static_cast<float>(PlayerCharacter->GetMaxHealth()),
+		 FLinearColor(1.f, 0.f, 0.f, 0.75f)},
+		{PlayerCharacter->GetStamina(), PlayerCharacter->GetMaxStamina(), FLinearColor(0.f, 1.f, 0.f, 0.75f)},
+		{PlayerCharacter->GetPsiPower(), PlayerCharacter->GetMaxPsiPower(), FLinearColor(0.2f, 0.4f, 1.f, 0.75f)}
+	};
+
+	for (const FCanvasBar& Bar : Bars)
+	{
+		const float Percentage = Bar.MaxValue > 0.f ? FMath::Clamp(Bar.Value / Bar.MaxValue, 0.f, 1.f) : 0.f;
+		DrawRect(FLinearColor(0.f, 0.f, 0.f, 0.4f), Left, Top, BarWidth, BarHeight);
+		DrawRect(Bar.Color, Left, Top, BarWidth * Percentage, BarHeight);
+		DrawText(FString::FromInt(FMath::RoundToInt(Bar.Value)), FLinearColor::White, Left + BarWidth + 8.f, Top - 2.f);
+		Top += BarHeight + Spacing;
+	}
+
+	// Crosshair
+	const float CenterX = Canvas->ClipX * 0.5f;
+	const float CenterY = Canvas->ClipY * 0.5f;
+	DrawLine(CenterX - 8.f, CenterY, CenterX + 8.f, CenterY, FLinearColor::White, 2.f);
+	DrawLine(CenterX, CenterY - 8.f, CenterX, CenterY + 8.f, FLinearColor::White, 2.f);
+}
+
+void AHudBB::CompareCanvasHud(float SecondsPerMode)
+{
+	FHudBenchmarkBB::FOptions Options;
+	Options.SecondsPerMode = SecondsPerMode;
+
+	if (Benchmark.Start(*this, {EHudViewMode::Minimal, EHudViewMode::CanvasOnly}, Options))
+		SetActorTickEnabled(true);
+}
+
+void AHudBB::BenchmarkLayouts(float SecondsPerMode, FString FileName)
+{
+	FHudBenchmarkBB::FOptions Options;
+	Options.SecondsPerMode = SecondsPerMode;
+	Options.bChurnStats    = true;
+	Options.CsvFileName    = FileName.IsEmpty()
+		                         ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("HudBenchmark.csv"))
+		                         : FileName;
+
+	TArray<EHudViewMode> ViewModes;
+	for (int32 ViewMode = 0; ViewMode < static_cast<int32>(EHudViewModeOrderBB::Num); ++ViewMode)
+	{
+		ViewModes.Add(static_cast<EHudViewMode>(ViewMode));
+	}
+
+	if (Benchmark.Start(*this, ViewModes, Options))
+		SetActorTickEnabled(true);
+}
+
+UUserWidget* AHudBB::GetCurrentLayout() const
+{
+	switch (CurrentViewMode)
+	{
+	case EHudViewMode::Minimal: return MinimalLayoutWidget;
+	case EHudViewMode::Moderate: return ModerateLayoutWidget;
+	case EHudViewMode::SensoryOverload: return OverloadLayoutWidget;
+	default: return nullptr;
+	}
+}
+
+void AHudBB::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// Only ticking for the benchmark, so stop when it does.
+	if (!Benchmark.Tick(*this)) SetActorTickEnabled(false);
+}
+
+void AHudBB::ClearAllHandlers()
+{
+	if (!PlayerCharacter) return;
+
+	// Only our own widgets' bindings, as other things (e.g. the audio feedback) listen to the same delegates.
+	auto RemoveBarHandlers = [this](const UHSPBarBase* HSPBar)
+	{
+		if (!HSPBar) return;
+		PlayerCharacter->OnHealthChanged.RemoveAll(HSPBar->HealthBar);
+		PlayerCharacter->OnStaminaChanged.RemoveAll(HSPBar->StaminaBar);
+		PlayerCharacter->OnPsiPowerChanged.RemoveAll(HSPBar->PsiBar);
+	};
+
+	if (MinimalLayoutWidget) RemoveBarHandlers(MinimalLayoutWidget->HSPBar);
+	if (ModerateLayoutWidget) RemoveBarHandlers(ModerateLayoutWidget->HSPBar);
+	if (OverloadLayoutWidget)
+	{
+		RemoveBarHandlers(OverloadLayoutWidget->HSPBar);
+		PlayerCharacter->OnKeyWalletAction.RemoveAll(OverloadLayoutWidget);
+	}
+}
@@ -0,0 +1,342 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HudBenchmarkBB.h"
+#include "CharacterBB.h"
+#include "CustomLogging.h"
+#include "HudBB.h"
+#include "RenderCore.h"
+#include "RHI.h"
+#include "SampleStatsBB.h"
+#include "Blueprint/UserWidget.h"
+#include "Blueprint/WidgetTree.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Input/HittestGrid.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Rendering/DrawElements.h"
+#include "Types/PaintArgs.h"
+
+// Time to let a view mode settle (creating widgets, first paints) before timing it.
+static constexpr float WarmupSeconds = 1.f;
+
+// How many times the one-off measurements are repeated, to get something steadier than a single run.
+static constexpr int32 NumLayoutIterations = 100;
+static constexpr int32 NumSwitchIterations = 20;
+
+static const TCHAR*    ChurnKey    = TEXT("HudBenchmarkKey");
+static constexpr int32 ChurnHealth = 5;
+
+// Every widget in a user widget's tree, including those inside nested user widgets (the HSP bar, the stat bars...)
+static void CountWidgets(const UUserWidget& UserWidget, int32& NumWidgets, SIZE_T& WidgetBytes)
+{
+	if (!UserWidget.WidgetTree) return;
+
+	UserWidget.WidgetTree->ForEachWidget([&NumWidgets, &WidgetBytes](UWidget* Widget)
+	{
+		++NumWidgets;
+		WidgetBytes += Widget->GetClass()->GetStructureSize();
+		if (const UUserWidget* Nested = Cast<UUserWidget>(Widget))
+			CountWidgets(*Nested, NumWidgets, WidgetBytes);
+	});
+}
+
+static int32 CountSlateWidgets(SWidget& Widget)
+{
+	int32      NumWidgets = 1;
+	FChildren* Children   = Widget.GetChildren();
+	for (int32 ChildIndex = 0; ChildIndex < Children->Num(); ++ChildIndex)
+	{
+		NumWidgets += CountSlateWidgets(Children->GetChildAt(ChildIndex).Get());
+	}
+	return NumWidgets;
+}
+
+FHudBenchmarkBB::~FHudBenchmarkBB()
+{
+	Stop();
+}
+
+bool FHudBenchmarkBB::Start(AHudBB& Hud, const TArray<EHudViewMode>& ViewModes, const FOptions& InOptions)
+{
+	if (IsRunning())
+	{
+		BBLOG(Warning, "A HUD benchmark is already running");
+		return false;
+	}
+	if (ViewModes.Num() == 0) return false;
+
+	Options                = InOptions;
+	Options.SecondsPerMode = FMath::Max(1.f, Options.SecondsPerMode);
+
+	Modes.Reset();
+	for (const EHudViewMode ViewMode : ViewModes)
+	{
+		Modes.AddDefaulted_GetRef().ViewMode = ViewMode;
+	}
+
+	if (Options.bChurnStats && Hud.GetPlayerCharacter() && !Hud.GetPlayerCharacter()->HasAuthority())
+		BBLOG(Warning, "Stats can only be changed on the server, so the HUD benchmark won't churn them");
+
+	if (FSlateApplication::IsInitialized())
+	{
+		PreTickHandle  = FSlateApplication::Get().OnPreTick().AddRaw(this, &FHudBenchmarkBB::OnSlatePreTick);
+		PostTickHandle = FSlateApplication::Get().OnPostTick().AddRaw(this, &FHudBenchmarkBB::OnSlatePostTick);
+	}
+
+	ViewModeBefore = Hud.GetCurrentViewMode();
+	ModeIndex      = 0;
+	ModeElapsed    = 0.f;
+	LastSlateMs    = -1.f;
+	ChurnFrame     = 0;
+	bHealthLowered = false;
+	bAddedChurnKey = false;
+	SwitchToCurrentMode(Hud);
+	return true;
+}
+
+bool FHudBenchmarkBB::Tick(AHudBB& Hud)
+{
+	if (!IsRunning()) return false;
+
+	if (Options.bChurnStats) ChurnStats(Hud);
+
+	// Undilated, and the thread times are for the last whole frame.
+	FModeSamples& Samples = Modes[ModeIndex];
+	ModeElapsed += FApp::GetDeltaTime();
+	if (ModeElapsed > WarmupSeconds)
+	{
+		Samples.FrameMs.Add(FApp::GetDeltaTime() * 1000.f);
+		Samples.GameThreadMs.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+		Samples.RenderThreadMs.Add(FPlatformTime::ToMilliseconds(GRenderThreadTime));
+		Samples.GpuMs.Add(FPlatformTime::ToMilliseconds(RHIGetGPUFrameCycles()));
+		if (LastSlateMs >= 0.f) Samples.SlateMs.Add(LastSlateMs);
+	}
+	LastSlateMs = -1.f;
+
+	if (ModeElapsed < WarmupSeconds + Options.SecondsPerMode) return true;
+
+	MeasureLayout(Hud, Samples);
+
+	ModeElapsed = 0.f;
+	if (++ModeIndex < Modes.Num())
+	{
+		SwitchToCurrentMode(Hud);
+		return true;
+	}
+
+	// Sorted once here for the percentiles, the order the frames came in doesn't matter any more.
+	for (FModeSamples& ModeSamples : Modes) ModeSamples.Sort();
+
+	Report();
+	if (!Options.CsvFileName.IsEmpty()) WriteCsv(Options.CsvFileName);
+
+	if (Options.bChurnStats) UndoChurn(Hud);
+	Stop();
+	Hud.SetCurrentViewMode(ViewModeBefore);
+	return false;
+}
+
+void FHudBenchmarkBB::Stop()
+{
+	if (FSlateApplication::IsInitialized())
+	{
+		FSlateApplication::Get().OnPreTick().Remove(PreTickHandle);
+		FSlateApplication::Get().OnPostTick().Remove(PostTickHandle);
+	}
+	PreTickHandle.Reset();
+	PostTickHandle.Reset();
+
+	ModeIndex = INDEX_NONE;
+}
+
+void FHudBenchmarkBB::SwitchToCurrentMode(AHudBB& Hud)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+	Hud.SetCurrentViewMode(Modes[ModeIndex].ViewMode);
+	Modes[ModeIndex].SwitchMs = static_cast<float>((FPlatformTime::Seconds() - StartSeconds) * 1000.0);
+}
+
+void FHudBenchmarkBB::MeasureLayout(AHudBB& Hud, FModeSamples& Samples)
+{
+	// Switching to the mode we're already in still unbinds, rebinds and rebroadcasts everything,
+	// so this is a switch without the cost of creating the layouts.
+	const double SwitchStart = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < NumSwitchIterations; ++Iteration)
+	{
+		Hud.SetCurrentViewMode(Samples.ViewMode);
+	}
+	Samples.WarmSwitchMs = static_cast<float>((FPlatformTime::Seconds() - SwitchStart) * 1000.0 / NumSwitchIterations);
+
+	Samples.UsedPhysicalMB = FPlatformMemory::GetStats().UsedPhysical / (1024 * 1024);
+
+	UUserWidget* Layout = Hud.GetCurrentLayout();
+	if (!Layout) return;
+
+	CountWidgets(*Layout, Samples.NumWidgets, Samples.WidgetBytes);
+
+	const TSharedPtr<SWidget> Root = Layout->GetCachedWidget();
+	if (!Root.IsValid()) return;
+
+	Samples.NumSlateWidgets = CountSlateWidgets(*Root);
+
+	// Lay out and paint just this layout, the same way the window does every frame.
+	// The paint goes into an element list of our own, which is thrown away, so nothing extra reaches the screen.
+	const FGeometry Geometry = Layout->GetCachedGeometry();
+
+	const double PrepassStart = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < NumLayoutIterations; ++Iteration)
+	{
+		Root->SlatePrepass(Geometry.Scale);
+	}
+	Samples.PrepassUs = static_cast<float>((FPlatformTime::Seconds() - PrepassStart) * 1e6 / NumLayoutIterations);
+
+	const TSharedPtr<SWindow> Window = FSlateApplication::Get().FindWidgetWindow(Root.ToSharedRef());
+	if (!Window.IsValid()) return;
+
+	FHittestGrid     HittestGrid;
+	const FSlateRect CullingRect = Geometry.GetLayoutBoundingRect();
+	const double     PaintStart  = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < NumLayoutIterations; ++Iteration)
+	{
+		FSlateWindowElementList DrawElements(Window);
+		const FPaintArgs        PaintArgs(Window.Get(), HittestGrid, FVector2D::ZeroVector, FApp::GetCurrentTime(),
+		                                  FApp::GetDeltaTime());
+		Root->Paint(PaintArgs, Geometry, CullingRect, DrawElements, 0, FWidgetStyle(), true);
+		Samples.NumDrawElements = DrawElements.GetUncachedDrawElements().Num();
+	}
+	Samples.PaintUs = static_cast<float>((FPlatformTime::Seconds() - PaintStart) * 1e6 / NumLayoutIterations);
+}
+
+void FHudBenchmarkBB::ChurnStats(AHudBB& Hud)
+{
+	ACharacterBB* Character = Hud.GetPlayerCharacter();
+	if (!Character || !Character->HasAuthority()) return;
+
+	++ChurnFrame;
+
+	// Down one frame and back up the next. Never far enough to kill anyone.
+	if (bHealthLowered)
+	{
+		Character->UpdateHealth(ChurnHealth);
+		bHealthLowered = false;
+	}
+	else if (Character->GetHealth() > ChurnHealth)
+	{
+		Character->UpdateHealth(-ChurnHealth);
+		bHealthLowered = true;
+	}
+
+	// Adds and removes entries in the overload layout's key wallet.
+	if (ChurnFrame % 15 == 0)
+	{
+		if (bAddedChurnKey)
+			Character->RemoveKey(ChurnKey);
+		else if (!Character->HasKey(ChurnKey))
+			Character->AddKey(ChurnKey);
+		bAddedChurnKey = Character->HasKey(ChurnKey);
+	}
+
+	// Psi power then recharges over the following frames.
+	if (ChurnFrame % 120 == 0) Character->PsiBlast();
+}
+
+void FHudBenchmarkBB::UndoChurn(AHudBB& Hud)
+{
+	ACharacterBB* Character = Hud.GetPlayerCharacter();
+	if (!Character) return;
+
+	if (bHealthLowered) Character->UpdateHealth(ChurnHealth);
+	if (bAddedChurnKey) Character->RemoveKey(ChurnKey);
+	bHealthLowered = false;
+	bAddedChurnKey = false;
+}
+
+void FHudBenchmarkBB::FModeSamples::Sort()
+{
+	FrameMs.Sort();
+	GameThreadMs.Sort();
+	RenderThreadMs.Sort();
+	GpuMs.Sort();
+	SlateMs.Sort();
+}
+
+void FHudBenchmarkBB::Report()
+{
+	BBLOG(Log, "HUD view mode benchmark, average / p95 (ms):");
+	for (const FModeSamples& Samples : Modes)
+	{
+		BBLOG(Log, "  {0}: {1} frames, frame {2} / {3}, game {4} / {5}, render {6} / {7}, gpu {8} / {9}, "
+		      "slate {10} / {11}",
+		      UEnum::GetValueAsString(Samples.ViewMode), Samples.FrameMs.Num(),
+		      FSampleStatsBB::GetAverage(Samples.FrameMs),
+		      FSampleStatsBB::GetPercentile(Samples.FrameMs, 0.95f),
+		      FSampleStatsBB::GetAverage(Samples.GameThreadMs),
+		      FSampleStatsBB::GetPercentile(Samples.GameThreadMs, 0.95f),
+		      FSampleStatsBB::GetAverage(Samples.RenderThreadMs),
+		      FSampleStatsBB::GetPercentile(Samples.RenderThreadMs, 0.95f),
+		      FSampleStatsBB::GetAverage(Samples.GpuMs),
+		      FSampleStatsBB::GetPercentile(Samples.GpuMs, 0.95f),
+		      FSampleStatsBB::GetAverage(Samples.SlateMs),
+		      FSampleStatsBB::GetPercentile(Samples.SlateMs, 0.95f));
+		BBLOG(Log, "    switch {0} ms ({1} ms warm), prepass {2} us, paint {3} us, {4} draw elements, "
+		      "{5} widgets ({6} slate, {7} bytes), {8} MB used",
+		      Samples.SwitchMs, Samples.WarmSwitchMs, Samples.PrepassUs, Samples.PaintUs, Samples.NumDrawElements,
+		      Samples.NumWidgets, Samples.NumSlateWidgets, Samples.WidgetBytes, Samples.UsedPhysicalMB);
+	}
+
+	// Everything against the first mode.
+	const float FirstFrameMs = FSampleStatsBB::GetAverage(Modes[0].FrameMs);
+	if (FirstFrameMs <= 0.f) return;
+
+	for (int32 Index = 1; Index < Modes.Num(); ++Index)
+	{
+		BBLOG(Log, "  {0} frames take {1}% of {2}'s", UEnum::GetValueAsString(Modes[Index].ViewMode),
+		      FSampleStatsBB::GetAverage(Modes[Index].FrameMs) / FirstFrameMs * 100.f,
+		      UEnum::GetValueAsString(Modes[0].ViewMode));
+	}
+}
+
+bool FHudBenchmarkBB::WriteCsv(const FString& FileName)
+{
+	FString Csv = TEXT("ViewMode,Frames,FrameAvgMs,FrameP95Ms,GameThreadAvgMs,GameThreadP95Ms,RenderThreadAvgMs,"
+		"RenderThreadP95Ms,GpuAvgMs,GpuP95Ms,SlateAvgMs,SlateP95Ms,PrepassUs,PaintUs,DrawElements,Widgets,"
+		"SlateWidgets,WidgetBytes,UsedPhysicalMB,SwitchMs,WarmSwitchMs\n");
+	for (const FModeSamples& Samples : Modes)
+	{
+		Csv.Appendf(TEXT("%s,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,")
+		            TEXT("%.2f,%.2f,%d,%d,%d,%llu,%llu,%.3f,%.3f\n"),
+		            *StaticEnum<EHudViewMode>()->GetNameStringByValue(static_cast<int64>(Samples.ViewMode)),
+		            Samples.FrameMs.Num(),
+		            FSampleStatsBB::GetAverage(Samples.FrameMs),
+		            FSampleStatsBB::GetPercentile(Samples.FrameMs, 0.95f),
+		            FSampleStatsBB::GetAverage(Samples.GameThreadMs),
+		            FSampleStatsBB::GetPercentile(Samples.GameThreadMs, 0.95f),
+		            FSampleStatsBB::GetAverage(Samples.RenderThreadMs),
+		            FSampleStatsBB::GetPercentile(Samples.RenderThreadMs, 0.95f),
+		            FSampleStatsBB::GetAverage(Samples.GpuMs),
+		            FSampleStatsBB::GetPercentile(Samples.GpuMs, 0.95f),
+		            FSampleStatsBB::GetAverage(Samples.SlateMs),
+		            FSampleStatsBB::GetPercentile(Samples.SlateMs, 0.95f),
+		            Samples.PrepassUs, Samples.PaintUs, Samples.NumDrawElements, Samples.NumWidgets,
+		            Samples.NumSlateWidgets, static_cast<uint64>(Samples.WidgetBytes), Samples.UsedPhysicalMB,
+		            Samples.SwitchMs, Samples.WarmSwitchMs);
+	}
+
+	const bool bSaved = FFileHelper::SaveStringToFile(Csv, *FileName);
+	if (bSaved)
+		BBLOG(Log, "HUD benchmark written to {0}", FileName);
+	else
+		BBLOG(Error, "Failed to write HUD benchmark to {0}", FileName);
+	return bSaved;
+}
+
+void FHudBenchmarkBB::OnSlatePreTick(float DeltaTime)
+{
+	SlateTickStart = FPlatformTime::Seconds();
+}
+
+void FHudBenchmarkBB::OnSlatePostTick(float DeltaTime)
+{
+	// Widget ticks, prepass and paint for every window. Just the game thread side, the rendering is in the render time.
+	LastSlateMs = static_cast<float>((FPlatformTime::Seconds() - SlateTickStart) * 1000.0);
+}
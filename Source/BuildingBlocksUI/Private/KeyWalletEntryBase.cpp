@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "KeyWalletEntryBase.h"
+
+#include "Components/TextBlock.h"
+
+void UKeyWalletEntryBase::NativeOnListItemObjectSet(UObject* ListItemObject)
+{
+	IUserObjectListEntry::NativeOnListItemObjectSet(ListItemObject);
+
+	if (!KeyText) return;
+
+	const UKeyWalletItem* Item = Cast<UKeyWalletItem>(ListItemObject);
+	KeyText->SetText(Item ? FText::FromString(Item->Key) : FText::GetEmpty());
+}
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MappedFileBB.h"
+#include "CustomLogging.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+FMappedFileBB::~FMappedFileBB()
+{
+	Close();
+}
+
+#if PLATFORM_WINDOWS
+
+bool FMappedFileBB::Open(const FString& FileName, int64 InSize)
+{
+	Close();
+
+	HANDLE File = CreateFileW(*FileName, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+	                          CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (File == INVALID_HANDLE_VALUE)
+	{
+		BBLOG(Error, "Unable to create {0}", FileName);
+		return false;
+	}
+
+	// The mapping sets the file size for us.
+	LARGE_INTEGER MappingSize;
+	MappingSize.QuadPart = InSize;
+	HANDLE Mapping       = CreateFileMappingW(File, nullptr, PAGE_READWRITE,
+	                                          MappingSize.HighPart, MappingSize.LowPart, nullptr);
+	if (!Mapping)
+	{
+		BBLOG(Error, "Unable to size {0} to {1} bytes", FileName, InSize);
+		CloseHandle(File);
+		return false;
+	}
+
+	void* View = MapViewOfFile(Mapping, FILE_MAP_WRITE, 0, 0, 0);
+	if (!View)
+	{
+		BBLOG(Error, "Unable to map {0}", FileName);
+		CloseHandle(Mapping);
+		CloseHandle(File);
+		return false;
+	}
+
+	FileHandle    = File;
+	MappingHandle = Mapping;
+	Data          = static_cast<uint8*>(View);
+	Size          = InSize;
+	return true;
+}
+
+void FMappedFileBB::Flush()
+{
+	if (Data) FlushViewOfFile(Data, 0);
+}
+
+void FMappedFileBB::Close()
+{
+	if (Data)
+	{
+		FlushViewOfFile(Data, 0);
+		UnmapViewOfFile(Data);
+	}
+	if (MappingHandle) CloseHandle(MappingHandle);
+	if (FileHandle) CloseHandle(FileHandle);
+
+	Data          = nullptr;
+	Size          = 0;
+	MappingHandle = nullptr;
+	FileHandle    = nullptr;
+}
+
+#else
+
+bool FMappedFileBB::Open(const FString& FileName, int64 InSize)
+{
+	Close();
+
+	const int File = open(TCHAR_TO_UTF8(*FileName), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (File < 0)
+	{
+		BBLOG(Error, "Unable to create {0}", FileName);
+		return false;
+	}
+
+	if (ftruncate(File, InSize) != 0)
+	{
+		BBLOG(Error, "Unable to size {0} to {1} bytes", FileName, InSize);
+		close(File);
+		return false;
+	}
+
+	void* View = mmap(nullptr, InSize, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+	if (View == MAP_FAILED)
+	{
+		BBLOG(Error, "Unable to map {0}", FileName);
+		close(File);
+		return false;
+	}
+
+	FileDescriptor = File;
+	Data           = static_cast<uint8*>(View);
+	Size           = InSize;
+	return true;
+}
+
+void FMappedFileBB::Flush()
+{
+	if (Data) msync(Data, Size, MS_ASYNC);
+}
+
+void FMappedFileBB::Close()
+{
+	if (Data)
+	{
+		msync(Data, Size, MS_SYNC);
+		munmap(Data, Size);
+	}
+	if (FileDescriptor >= 0) close(FileDescriptor);
+
+	Data           = nullptr;
+	Size           = 0;
+	FileDescriptor = -1;
+}
+
+#endif
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/* A file of a fixed size, mapped into memory for writing.
+ * The engine's IPlatformFile only offers read-only mappings, so this wraps
+ * the platform calls directly. The whole file is created (and sized) up front,
+ * so writing to it later never has to grow anything. */
+class FMappedFileBB
+{
+public:
+	FMappedFileBB() = default;
+	~FMappedFileBB();
+
+	FMappedFileBB(const FMappedFileBB&)            = delete;
+	FMappedFileBB& operator=(const FMappedFileBB&) = delete;
+
+	// Create (or overwrite) a file of exactly Size bytes, and map all of it.
+	// Returns false (and leaves nothing open) if any step fails.
+	bool Open(const FString& FileName, int64 Size);
+
+	// Make sure everything written so far is on its way to disk.
+	void Flush();
+
+	// Unmap and close. Safe to call if nothing is open.
+	void Close();
+
+	bool   IsOpen() const { return Data != nullptr; }
+	uint8* GetData() const { return Data; }
+	int64  GetSize() const { return Size; }
+
+private:
+	uint8* Data = nullptr;
+	int64  Size = 0;
+
+#if PLATFORM_WINDOWS
+	void* FileHandle    = nullptr;
+	void* MappingHandle = nullptr;
+#else
+	int FileDescriptor = -1;
+#endif
+};
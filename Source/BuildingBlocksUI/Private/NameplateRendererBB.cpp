@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NameplateRendererBB.h"
+#include "CharacterBB.h"
+#include "CharacterRegistrySubsystemBB.h"
+#include "Engine/Canvas.h"
+#include "GameFramework/HUD.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/EngineVersionComparison.h"
+
+void FNameplateRendererBB::Draw(AHUD& Hud, UCanvas& Canvas, const FNameplateSettingsBB& Settings)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_NameplateRendererBB_Draw);
+
+	NumDrawnLastFrame = 0;
+	APlayerController* PlayerController = Hud.GetOwningPlayerController();
+	if (!Settings.bEnabled || !PlayerController || Settings.MaxPlatesPerFrame <= 0) return;
+
+	FVector  ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	const FVector ViewDirection = ViewRotation.Vector();
+
+	const double Now = FPlatformTime::Seconds();
+	if (LastGatherSeconds < 0.0 || Now - LastGatherSeconds >= Settings.GatherInterval)
+	{
+		Gather(Hud, ViewLocation, Settings);
+		LastGatherSeconds = Now;
+	}
+
+	// Work out where each candidate is on screen, skipping any behind us, too far away, or off the edges.
+	const float MaxDistanceSquared = FMath::Square(Settings.MaxDistance);
+	Plates.Reset();
+	for (const TWeakObjectPtr<ACharacterBB>& CandidatePtr : Candidates)
+	{
+		const ACharacterBB* Candidate = CandidatePtr.Get();
+		if (!Candidate) continue;
+
+		const FVector PlateLocation   = Candidate->GetActorLocation() + FVector(0.f, 0.f, Settings.HeightAboveCharacter);
+		const FVector ToPlate         = PlateLocation - ViewLocation;
+		const float   DistanceSquared = ToPlate.SizeSquared();
+		if (DistanceSquared > MaxDistanceSquared || FVector::DotProduct(ToPlate, ViewDirection) <= 0.f) continue;
+
+		const FVector ScreenLocation = Canvas.Project(PlateLocation);
+		if (ScreenLocation.X < 0.f || ScreenLocation.X > Canvas.ClipX ||
+			ScreenLocation.Y < 0.f || ScreenLocation.Y > Canvas.ClipY)
+			continue;
+
+		Plates.Add(FPlate{FVector2D(ScreenLocation.X, ScreenLocation.Y), DistanceSquared, Candidate});
+	}
+
+	// Only the closest ones if there are too many.
+	if (Plates.Num() > Settings.MaxPlatesPerFrame)
+	{
+		Plates.Sort([](const FPlate& A, const FPlate& B) { return A.DistanceSquared < B.DistanceSquared; });
+		// Keep the memory, it's needed again next frame. (5.3 only has the bool version of this)
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+		Plates.SetNum(Settings.MaxPlatesPerFrame, false);
+#else
+		Plates.SetNum(Settings.MaxPlatesPerFrame, EAllowShrinking::No);
+#endif
+	}
+
+	// Every rectangle uses the same texture and blend mode, so the canvas batches them all together.
+	static const FLinearColor BackgroundColor(0.f, 0.f, 0.f, 0.5f);
+	static const FLinearColor BarColors[] = {
+		FLinearColor(1.f, 0.f, 0.f, 0.75f), FLinearColor(0.f, 1.f, 0.f, 0.75f), FLinearColor(0.2f, 0.4f, 1.f, 0.75f)
+	};
+
+	const FVector2D BarSize     = Settings.BarSize;
+	const float     PlateHeight = 3.f * BarSize.Y + 2.f * Settings.BarSpacing;
+	for (const FPlate& Plate : Plates)
+	{
+		const FStatSummaryBB& Stats    = Plate.Character->GetStatSummary();
+		const uint8           Values[] = {Stats.Health, Stats.Stamina, Stats.PsiPower};
+		const float           Left     = Plate.ScreenPosition.X - 0.5f * BarSize.X;
+		float                 Top      = Plate.ScreenPosition.Y - PlateHeight;
+
+		Hud.DrawRect(BackgroundColor, Left - 1.f, Top - 1.f, BarSize.X + 2.f, PlateHeight + 2.f);
+		for (int32 BarIndex = 0; BarIndex < 3; ++BarIndex)
+		{
+			Hud.DrawRect(BarColors[BarIndex], Left, Top, BarSize.X * Values[BarIndex] / 255.f, BarSize.Y);
+			Top += BarSize.Y + Settings.BarSpacing;
+		}
+	}
+
+	NumDrawnLastFrame = Plates.Num();
+}
+
+void FNameplateRendererBB::Gather(const AHUD& Hud, const FVector& ViewLocation, const FNameplateSettingsBB& Settings)
+{
+	Candidates.Reset();
+
+	// A bit of slack on the distance, as things will move before the next gather.
+	const float  GatherDistanceSquared = FMath::Square(Settings.MaxDistance * 1.25f);
+	const APawn* OwnPawn               = Hud.GetOwningPawn();
+
+	const UWorld* World = Hud.GetWorld();
+	const UCharacterRegistrySubsystemBB* CharacterRegistry =
+		World ? World->GetSubsystem<UCharacterRegistrySubsystemBB>() : nullptr;
+	if (!CharacterRegistry) return;
+
+	for (ACharacterBB* Character : CharacterRegistry->GetCharacters())
+	{
+		if (!Character || Character == OwnPawn) continue;
+		if (FVector::DistSquared(Character->GetActorLocation(), ViewLocation) > GatherDistanceSquared) continue;
+		Candidates.Add(Character);
+	}
+}
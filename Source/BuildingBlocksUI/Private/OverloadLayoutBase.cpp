@@ -0,0 +1,67 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "OverloadLayoutBase.h"
+
+#include "KeyWalletEntryBase.h"
+#include "Components/ListView.h"
+
+void UOverloadLayoutBase::SyncKeyWallet(const TArray<FString>& Keys)
+{
+	if (!KeyList) return;
+
+	// Put all the existing items back in the spare pile, then rebuild.
+	for (const TPair<FString, TObjectPtr<UKeyWalletItem>>& Pair : KeyItems)
+	{
+		SpareKeyItems.Add(Pair.Value);
+	}
+	KeyItems.Reset();
+	KeyList->ClearListItems();
+
+	for (const FString& Key : Keys)
+	{
+		AddKeyItem(Key);
+	}
+}
+
+void UOverloadLayoutBase::OnKeyWalletAction(FString KeyString, EPlayerKeyAction KeyAction, bool IsSuccess)
+{
+	// We only care about things which actually changed the wallet.
+	// CountKeys carries the whole wallet as a single string, which is exactly what we DONT want to parse,
+	// the HUD calls SyncKeyWallet instead when the layout is shown.
+	if (!KeyList || !IsSuccess) return;
+
+	switch (KeyAction)
+	{
+	case EPlayerKeyAction::AddKey:
+		AddKeyItem(KeyString);
+		break;
+	case EPlayerKeyAction::RemoveKey:
+		{
+			TObjectPtr<UKeyWalletItem> Item = nullptr;
+			if (KeyItems.RemoveAndCopyValue(KeyString, Item))
+			{
+				// O(number of keys carried): UListView::RemoveItem searches its items and closes the gap.
+				// Swapping the last row in would be O(1), but reorders the wallet on screen, and needs a UListView
+				// subclass as its items are only handed out const. Wallets are a handful of keys, so order wins.
+				KeyList->RemoveItem(Item);
+				SpareKeyItems.Add(Item);
+			}
+		}
+		break;
+	default: ;
+	}
+}
+
+void UOverloadLayoutBase::AddKeyItem(const FString& Key)
+{
+	if (KeyItems.Contains(Key)) return;
+
+	UKeyWalletItem* Item = SpareKeyItems.Num() > 0
+		                       ? SpareKeyItems.Pop(false).Get()
+		                       : NewObject<UKeyWalletItem>(this);
+	Item->Key = Key;
+
+	KeyItems.Add(Key, Item);
+	KeyList->AddItem(Item);
+}
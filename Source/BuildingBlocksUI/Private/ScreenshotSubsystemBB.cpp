@@ -0,0 +1,159 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ScreenshotSubsystemBB.h"
+#include "CustomLogging.h"
+#include "MemoryTagsBB.h"
+#include "ImageUtils.h"
+#include "Engine/GameViewportClient.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+void UScreenshotSubsystemBB::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	LLM_SCOPE_BYTAG(BuildingBlocks_Screenshots);
+
+	// Allocate the slots up front. The pixel buffers themselves grow to the screen size
+	// on the first screenshot, and are then reused for every one after that.
+	Slots.SetNum(FMath::Clamp(MaxQueuedScreenshots, 1, 16));
+	FreeSlots.Reserve(Slots.Num());
+	for (int32 SlotIndex = Slots.Num() - 1; SlotIndex >= 0; --SlotIndex)
+	{
+		FreeSlots.Add(SlotIndex);
+	}
+
+	// OnScreenshotCaptured is static on the viewport client, so we only ever bind this once,
+	// however many times pawns are possessed.
+	ScreenshotCapturedHandle = UGameViewportClient::OnScreenshotCaptured().AddUObject(
+		this, &UScreenshotSubsystemBB::AcceptScreenshot);
+}
+
+void UScreenshotSubsystemBB::Deinitialize()
+{
+	UGameViewportClient::OnScreenshotCaptured().Remove(ScreenshotCapturedHandle);
+	ScreenshotCapturedHandle.Reset();
+
+	// Don't pull the buffers out from under any writes which are still going.
+	for (FScreenshotSlot& Slot : Slots)
+	{
+		Slot.Task.Wait();
+	}
+	Slots.Empty();
+	FreeSlots.Empty();
+
+	Super::Deinitialize();
+}
+
+int32 UScreenshotSubsystemBB::GetQueueDepth() const
+{
+	FScopeLock Lock(&SlotLock);
+	return Slots.Num() - FreeSlots.Num();
+}
+
+float UScreenshotSubsystemBB::GetLastLatencyMs() const
+{
+	FScopeLock Lock(&SlotLock);
+	return LastLatencyMs;
+}
+
+int32 UScreenshotSubsystemBB::GetDroppedCount() const
+{
+	FScopeLock Lock(&SlotLock);
+	return DroppedCount;
+}
+
+void UScreenshotSubsystemBB::AcceptScreenshot(int32 Width, int32 Height, const TArray<FColor>& Colors)
+{
+	if (Colors.Num() != Width * Height) return;
+
+	LLM_SCOPE_BYTAG(BuildingBlocks_Screenshots);
+
+	int32 SlotIndex = INDEX_NONE;
+	int32 QueueDepth;
+	{
+		FScopeLock Lock(&SlotLock);
+		if (FreeSlots.Num() > 0) SlotIndex = FreeSlots.Pop(false);
+		else ++DroppedCount;
+		QueueDepth = Slots.Num() - FreeSlots.Num();
+	}
+
+	// Every buffer is busy, so the disk isn't keeping up. Drop this one rather than queue without limit.
+	if (SlotIndex == INDEX_NONE)
+	{
+		BBLOG(Warning, "Screenshot dropped, {0} already queued", Slots.Num());
+		return;
+	}
+
+	FScreenshotSlot& Slot = Slots[SlotIndex];
+
+	// The only copy on the game thread. The buffer keeps its allocation between shots,
+	// so this doesn't allocate unless the resolution has grown.
+	Slot.Pixels.SetNumUninitialized(Colors.Num(), false);
+	FMemory::Memcpy(Slot.Pixels.GetData(), Colors.GetData(), Colors.Num() * sizeof(FColor));
+	Slot.Width       = Width;
+	Slot.Height      = Height;
+	Slot.Quality     = ScreenshotQuality;
+	Slot.Format      = ScreenshotFormat;
+	Slot.CaptureTime = FPlatformTime::Seconds();
+
+	const FString Directory = OutputDirectory.IsEmpty() ? FPaths::ScreenShotDir() : OutputDirectory;
+	Slot.FileName = FPaths::Combine(Directory, FString::Printf(TEXT("SS_%05d_%dx%d.%s"),
+	                                                          NextScreenshotIndex++, Width, Height,
+	                                                          GetFormatExtension(Slot.Format)));
+
+	BBLOG(Verbose, "Screenshot queued {0}, queue depth {1}", Slot.FileName, QueueDepth);
+
+	Slot.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, SlotIndex]() { WriteSlot(SlotIndex); },
+	                              UE::Tasks::ETaskPriority::BackgroundNormal);
+}
+
+void UScreenshotSubsystemBB::WriteSlot(int32 SlotIndex)
+{
+	// Runs on a task thread, which doesn't inherit the scope from AcceptScreenshot.
+	LLM_SCOPE_BYTAG(BuildingBlocks_Screenshots);
+
+	FScreenshotSlot& Slot = Slots[SlotIndex];
+	bool             bSaved;
+
+	if (Slot.Format == EScreenshotFormatBB::Raw)
+	{
+		// No encoding at all, just the pixels straight from the buffer.
+		bSaved = FFileHelper::SaveArrayToFile(
+			TArrayView<const uint8>(reinterpret_cast<const uint8*>(Slot.Pixels.GetData()),
+			                        Slot.Pixels.Num() * sizeof(FColor)), *Slot.FileName);
+	}
+	else
+	{
+		// The image view points at our buffer, so the encoder reads it in place without another copy.
+		const FImageView Image(Slot.Pixels.GetData(), Slot.Width, Slot.Height);
+		Slot.Encoded.Reset();
+		bSaved = FImageUtils::CompressImage(Slot.Encoded, GetFormatExtension(Slot.Format), Image, Slot.Quality) &&
+			FFileHelper::SaveArrayToFile(Slot.Encoded, *Slot.FileName);
+	}
+
+	const float LatencyMs = static_cast<float>((FPlatformTime::Seconds() - Slot.CaptureTime) * 1000.0);
+
+	if (bSaved)
+		BBLOG(Log, "Screenshot saved {0} in {1}ms", Slot.FileName, LatencyMs);
+	else
+		BBLOG(Error, "Failed to save screenshot {0}", Slot.FileName);
+
+	// Hand the slot back.
+	FScopeLock Lock(&SlotLock);
+	LastLatencyMs = LatencyMs;
+	FreeSlots.Add(SlotIndex);
+}
+
+const TCHAR* UScreenshotSubsystemBB::GetFormatExtension(EScreenshotFormatBB Format)
+{
+	switch (Format)
+	{
+	case EScreenshotFormatBB::JPEG: return TEXT("jpg");
+	case EScreenshotFormatBB::EXR: return TEXT("exr");
+	case EScreenshotFormatBB::Raw: return TEXT("bgra");
+	case EScreenshotFormatBB::PNG:
+	default: return TEXT("png");
+	}
+}
@@ -0,0 +1,239 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "StatBarBase.h"
+
+#include "CustomLogging.h"
+#include "MemoryTagsBB.h"
+#include "StatBarStyleBB.h"
+#include "StatBarTextBB.h"
+#include "StatLatencyBB.h"
+#include "Components/Border.h"
+#include "Components/Image.h"
+#include "Components/TextBlock.h"
+#include "Components/VerticalBox.h"
+#include "Components/VerticalBoxSlot.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectHash.h"
+#include "UObject/UObjectIterator.h"
+
+static FAutoConsoleCommand GStatBarMemoryCommand(
+	TEXT("bb.UI.StatBarMemory"),
+	TEXT("Log how much memory the live stat bars and their styles are holding, measured from the objects themselves."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		// An object's own size, plus everything its properties have allocated, the same way 'obj list' counts.
+		auto GetObjectBytes = [](UObject* Object) -> SIZE_T
+		{
+			const FArchiveCountMem CountMem(Object);
+			return Object->GetClass()->GetStructureSize() + CountMem.GetMax();
+		};
+
+		// Each bar with all its child widgets, and any style inside it which only it can use.
+		int32                  NumBars  = 0;
+		SIZE_T                 BarBytes = 0;
+		TSet<UStatBarStyleBB*> SharedStyles;
+		int32                  NumPrivateStyles = 0;
+		for (TObjectIterator<UStatBarBase> It; It; ++It)
+		{
+			if (It->IsTemplate()) continue;
+			++NumBars;
+			BarBytes += GetObjectBytes(*It);
+			ForEachObjectWithOuter(*It, [&](UObject* Inner)
+			{
+				BarBytes += GetObjectBytes(Inner);
+				if (Inner->IsA<UStatBarStyleBB>()) ++NumPrivateStyles;
+			});
+
+			UStatBarStyleBB* BarStyle = It->GetStyle();
+			if (BarStyle && !BarStyle->IsIn(*It)) SharedStyles.Add(BarStyle);
+		}
+
+		// Shared styles are only paid for once, however many bars use them.
+		SIZE_T SharedStyleBytes = 0;
+		for (UStatBarStyleBB* SharedStyle : SharedStyles) SharedStyleBytes += GetObjectBytes(SharedStyle);
+
+		BBLOG(Log, "{0} stat bars, {1} bytes, {2} bytes per bar (including their child widgets)", NumBars, BarBytes,
+		      NumBars > 0 ? BarBytes / NumBars : 0);
+		BBLOG(Log, "  {0} shared styles, {1} bytes, {2} private styles (counted in their bar)", SharedStyles.Num(),
+		      SharedStyleBytes, NumPrivateStyles);
+	}));
+
+void UStatBarBase::SetStyle(UStatBarStyleBB* NewStyle)
+{
+	Style         = NewStyle;
+	bStyleApplied = false;
+	UpdateWidget();
+}
+
+#if WITH_EDITORONLY_DATA
+
+void UStatBarBase::PostLoad()
+{
+	Super::PostLoad();
+	if (Style || IsTemplate(RF_ClassDefaultObject)) return;
+
+	// Bars from before styles had their own look set. Rather than lose it, move it into a style.
+	const UStatBarBase* Defaults = GetDefault<UStatBarBase>();
+	if (!IconBrush_DEPRECATED.GetResourceObject() &&
+		BarBackgroundColor_DEPRECATED == Defaults->BarBackgroundColor_DEPRECATED &&
+		BarForegroundColor_DEPRECATED == Defaults->BarForegroundColor_DEPRECATED &&
+		IsFullSize_DEPRECATED == Defaults->IsFullSize_DEPRECATED) return;
+
+	// The style goes in the widget's package rather than inside the bar, so every bar in the widget with the
+	// same look (all the health bars, say) shares it, and widget instances point at it rather than copying it.
+	UPackage*        Package     = GetOutermost();
+	UStatBarStyleBB* SharedStyle = nullptr;
+	ForEachObjectWithOuter(Package, [this, &SharedStyle](UObject* Object)
+	{
+		UStatBarStyleBB* Candidate = Cast<UStatBarStyleBB>(Object);
+		if (SharedStyle || !Candidate) return;
+
+		if (Candidate->IconBrush == IconBrush_DEPRECATED &&
+			Candidate->BackgroundColor == BarBackgroundColor_DEPRECATED &&
+			Candidate->ForegroundColor == BarForegroundColor_DEPRECATED &&
+			(Candidate->SizeMode == EStatBarSizeModeBB::FullSize) == IsFullSize_DEPRECATED)
+			SharedStyle = Candidate;
+	}, false);
+
+	if (!SharedStyle)
+	{
+		SharedStyle = NewObject<UStatBarStyleBB>(
+			Package, MakeUniqueObjectName(Package, UStatBarStyleBB::StaticClass(), TEXT("StatBarStyle")),
+			RF_Public | RF_Transactional);
+		SharedStyle->IconBrush       = IconBrush_DEPRECATED;
+		SharedStyle->BackgroundColor = BarBackgroundColor_DEPRECATED;
+		SharedStyle->ForegroundColor = BarForegroundColor_DEPRECATED;
+		SharedStyle->SizeMode        = IsFullSize_DEPRECATED
+			                               ? EStatBarSizeModeBB::FullSize
+			                               : EStatBarSizeModeBB::Minimized;
+	}
+	Style         = SharedStyle;
+	bStyleApplied = false;
+
+	BBLOG(Display, "{0} had its own look, which has been moved into {1}. Resave the widget to keep it.",
+	      GetPathName(), SharedStyle->GetPathName());
+}
+
+#endif
+
+void UStatBarBase::NativeOnInitialized()
+{
+	Super::NativeOnInitialized();
+	UE_LOG(BBLog, Warning, TEXT("NativeOnInitialized()"));
+	UpdateWidget();
+}
+
+void UStatBarBase::OnIntStatUpdated(int32 OldValue, int32 NewValue, int32 MaxValue)
+{
+	// Just use the float version of the function!
+	OnFloatStatUpdated(static_cast<float>(OldValue), static_cast<float>(NewValue), static_cast<float>(MaxValue));
+}
+
+void UStatBarBase::OnFloatStatUpdated(float OldValue, float NewValue, float MaxValue)
+{
+	// For now, we can ignore the OldValue, this will be used later for animating the bar.
+
+	// Calculate the new percentage, and clamp the value between 0 and 1,
+	// just in case someone passes invalid values
+
+	// Prevent divide by zero errors.
+	// The macro SMALL_NUMBER would be appropriate here..
+	// but KINDA_SMALL_NUMBER is the sort of Name which goes against all the 'stuffy' coding conventions,
+	// and it's official EPIC code, so I wanted to highlight that! ;-)
+	// I think its 'KINDA' amusing.
+	if (MaxValue == 0.f) MaxValue = KINDA_SMALL_NUMBER;
+
+	CurrentPercentage = FMath::Clamp(NewValue / MaxValue, 0.f, 1.f);
+	CurrentValue      = NewValue;
+	UpdateWidget();
+}
+
+void UStatBarBase::ProcessCurrentValueText()
+{
+	CurrentValueText = FText::FromString(FStatBarTextBB::FormatValue(CurrentValue));
+}
+
+void UStatBarBase::UpdateWidget()
+{
+	// Check that the controls we want actually exist
+	if (!PercentBar_Filled ||
+		!PercentBar_Empty ||
+		!MainBorder ||
+		!IconImage) return;
+
+	LLM_SCOPE_BYTAG(BuildingBlocks_StatBars);
+
+	FSlateChildSize EmptySize = FSlateChildSize(ESlateSizeRule::Fill);
+	EmptySize.Value           = 1.f - CurrentPercentage;
+
+	FSlateChildSize FilledSize = FSlateChildSize(ESlateSizeRule::Fill);
+	FilledSize.Value           = CurrentPercentage;
+
+	if (UVerticalBoxSlot* FilledSlot = Cast<UVerticalBoxSlot>(PercentBar_Filled->Slot))
+		FilledSlot->SetSize(FilledSize);
+
+	if (UVerticalBoxSlot* EmptySlot = Cast<UVerticalBoxSlot>(PercentBar_Empty->Slot))
+		EmptySlot->SetSize(EmptySize);
+
+	if (!bStyleApplied) ApplyStyle();
+
+	ProcessCurrentValueText();
+
+	ValueText->SetText(CurrentValueText);
+
+	// Close off any input latency measurement waiting on this bar.
+	FStatLatencyTrackerBB::Get().OnWidgetUpdated();
+}
+
+void UStatBarBase::ApplyStyle()
+{
+	const UStatBarStyleBB* ActiveStyle = Style ? Style.Get() : UStatBarStyleBB::GetDefaultStyle();
+
+	// The UImage keeps a brush of its own whatever is done here, so setting it doesn't cost any more memory.
+	MainBorder->SetBrushColor(ActiveStyle->BackgroundColor);
+	PercentBar_Filled->SetBrushColor(ActiveStyle->ForegroundColor);
+	IconImage->SetBrush(ActiveStyle->IconBrush);
+	PercentBars->SetVisibility(ActiveStyle->SizeMode == EStatBarSizeModeBB::FullSize
+		                           ? ESlateVisibility::Visible
+		                           : ESlateVisibility::Collapsed);
+
+	bStyleApplied = true;
+}
+
+#if WITH_EDITOR
+
+void UStatBarBase::OnDesignerChanged(const FDesignerChangedEventArgs& EventArgs)
+{
+	Super::OnDesignerChanged(EventArgs);
+	bStyleApplied = false;
+	// Update the widget, after editor changes due to layout,
+	// for example, resizing the widget, or a container that the widget is in.
+	UpdateWidget();
+}
+
+void UStatBarBase::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	bStyleApplied = false;
+
+	// Update the widget, after it's properties have been changed.
+
+	// In this case it IS sufficient to just call UpdateWidget()
+	// which means changing ANY property will trigger the update.
+	// The commented code demonstrates one way, you could run specific code
+	// when when individual properties are changed, perhaps because you want to
+	// do specific things only when specific properties are changed in the editor.
+
+	//const FString PropertyName = ((PropertyChangedEvent.Property != nullptr)
+	//	                              ? PropertyChangedEvent.Property->GetFName()
+	//	                              : NAME_None).ToString();
+
+	//if (PropertyName == TEXT("CurrentPercentage") || PropertyName == TEXT("CurrentValue"))
+	//{
+		UpdateWidget();
+	//}
+}
+
+#endif
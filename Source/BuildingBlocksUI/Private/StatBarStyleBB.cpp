@@ -0,0 +1,9 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "StatBarStyleBB.h"
+
+const UStatBarStyleBB* UStatBarStyleBB::GetDefaultStyle()
+{
+	// The class defaults make a perfectly good style, with no icon.
+	return GetDefault<UStatBarStyleBB>();
+}
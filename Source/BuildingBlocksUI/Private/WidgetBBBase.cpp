@@ -1,6 +1,6 @@
 ﻿// Fill out your copyright notice in the Description page of Project Settings.
 
-#include "BuildingBlocks/Public/WidgetBBBase.h"
+#include "WidgetBBBase.h"
 
 #if WITH_EDITOR
 const FText UWidgetBBBase::GetPaletteCategory()
@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CharacterBB.h"
+#include "Engine/DataAsset.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AudioFeedbackSubsystemBB.generated.h"
+
+class UAudioComponent;
+class USoundAttenuation;
+class USoundBase;
+
+// The things characters do which can have a sound.
+UENUM(BlueprintType)
+enum class EAudioFeedbackEventBB : uint8
+{
+	HealthLost,
+	HealthGained,
+	Died,
+	StaminaEmpty UMETA(Tooltip = "Stamina just ran out."),
+	PsiSpent UMETA(Tooltip = "Psi power dropped by at least PsiSpentFraction in one go, e.g. a psi blast."),
+	KeyAdded,
+	KeyRemoved,
+	KeyActionFailed UMETA(Tooltip = "Adding a key already held, removing or testing for one not held."),
+	Count UMETA(Hidden)
+};
+
+// The sound for one event, and how much of it there can be.
+USTRUCT(BlueprintType)
+struct FAudioFeedbackCueBB
+{
+	// Nothing plays if empty.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Audio Feedback")
+	TObjectPtr<USoundBase> Sound = nullptr;
+
+	// Optional, otherwise whatever the sound has.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Audio Feedback")
+	TObjectPtr<USoundAttenuation> Attenuation = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Audio Feedback", meta=(ClampMin=0))
+	float VolumeMultiplier = 1.f;
+
+	// The most of this cue playing at once, across every character. Any more are dropped.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Audio Feedback", meta=(ClampMin=1))
+	int32 MaxConcurrent = 4;
+
+	// The most times a second this cue can start, across every character. 0 for no limit.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Audio Feedback", meta=(ClampMin=0))
+	float MaxPerSecond = 8.f;
+
+	GENERATED_BODY()
+};
+
+// Which sound goes with which event, and how many can play at once.
+UCLASS(BlueprintType)
+class BUILDINGBLOCKSUI_API UAudioFeedbackCuesBB : public UDataAsset
+{
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Audio Feedback")
+	TMap<EAudioFeedbackEventBB, FAudioFeedbackCueBB> Cues;
+
+	// Audio components made up front, which is also the most sounds playing at once, of all cues together.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Audio Feedback", meta=(ClampMin=1, ClampMax=128))
+	int32 NumComponents = 16;
+
+	// How much of the max psi power has to go at once to count as PsiSpent, rather than just draining.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Audio Feedback", meta=(ClampMin=0, ClampMax=1))
+	float PsiSpentFraction = 0.1f;
+
+	GENERATED_BODY()
+};
+
+// Decides whether a cue can start, from how many are playing and when the last one started.
+// Only knows about times, not audio, so it works the same without an audio device (see bb.Audio.Test).
+struct BUILDINGBLOCKSUI_API FAudioCueLimiterBB
+{
+	enum class EResult : uint8
+	{
+		Play,
+		TooMany,
+		TooSoon
+	};
+
+	// If the result is Play, the cue counts as playing until Now + Duration.
+	EResult TryStart(int32 MaxConcurrent, float MaxPerSecond, double Now, double Duration);
+
+	void Reset();
+
+private:
+	// When each playing cue finishes.
+	TArray<double, TInlineAllocator<8>> EndTimes;
+	double                              NextAllowedTime = 0.0;
+};
+
+// Binds to one character's delegates, and passes them on with the character attached,
+// which dynamic delegates can't do on their own.
+UCLASS()
+class UAudioFeedbackListenerBB : public UObject
+{
+public:
+	TWeakObjectPtr<ACharacterBB> Character;
+
+	// AddUniqueDynamic, so binding again after a pool has cleared them is fine.
+	void Bind();
+
+	UFUNCTION()
+	void HandleHealthChanged(int32 OldValue, int32 NewValue, int32 MaxValue);
+
+	UFUNCTION()
+	void HandlePlayerDied();
+
+	UFUNCTION()
+	void HandleStaminaChanged(float OldValue, float NewValue, float MaxValue);
+
+	UFUNCTION()
+	void HandlePsiPowerChanged(float OldValue, float NewValue, float MaxValue);
+
+	UFUNCTION()
+	void HandleKeyWalletAction(FString KeyString, EPlayerKeyAction KeyAction, bool IsSuccess);
+
+private:
+	void Play(EAudioFeedbackEventBB Event) const;
+
+	GENERATED_BODY()
+};
+
+/* Plays sounds for every character's stat changes and key actions.
+ *
+ * Rather than an audio component per sound, there's a fixed set made up front, which get handed round.
+ * Each cue also has a cap on how many can play at once and how often it can start,
+ * so a crowd all losing health in the same frame makes a few sounds, not a few hundred.
+ * If every component is busy, the sound is dropped too.
+ *
+ * Does nothing until given some cues by SetCues, which AHudBB does with its AudioFeedbackCues.
+ * bb.Audio.Stats shows how many were played and dropped, and why. */
+UCLASS()
+class BUILDINGBLOCKSUI_API UAudioFeedbackSubsystemBB : public UWorldSubsystem
+{
+public:
+	// Start playing these cues, watching every character in the world from now on.
+	void SetCues(UAudioFeedbackCuesBB* InCues);
+
+	// Listen to a character. Safe to call again for one already being watched.
+	void Watch(ACharacterBB* Character);
+
+	// Play the cue for Event at Location, if its limits and the pool allow. Returns whether it played.
+	bool PlayEvent(EAudioFeedbackEventBB Event, const FVector& Location);
+
+	float GetPsiSpentFraction() const;
+
+	struct FEventStats
+	{
+		int32 NumPlayed          = 0;
+		int32 NumTooMany         = 0;
+		int32 NumTooSoon         = 0;
+		int32 NumNoFreeComponent = 0;
+	};
+
+	const FEventStats& GetEventStats(EAudioFeedbackEventBB Event) const;
+
+protected:
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void OnActorSpawned(AActor* Actor);
+
+	UFUNCTION()
+	void HandleCharacterDestroyed(AActor* DestroyedActor);
+
+	UPROPERTY()
+	TObjectPtr<UAudioFeedbackCuesBB> Cues = nullptr;
+
+	UPROPERTY()
+	TArray<TObjectPtr<UAudioComponent>> Components;
+
+	// When each component's sound finishes, indexed the same as Components.
+	// Kept alongside IsPlaying, so the pool works the same with the null audio device.
+	TArray<double> ComponentBusyUntil;
+
+	UPROPERTY()
+	TMap<TWeakObjectPtr<ACharacterBB>, TObjectPtr<UAudioFeedbackListenerBB>> Listeners;
+
+	FAudioCueLimiterBB Limiters[static_cast<int32>(EAudioFeedbackEventBB::Count)];
+	FEventStats        Stats[static_cast<int32>(EAudioFeedbackEventBB::Count)];
+
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle CharacterAcquiredHandle;
+
+	GENERATED_BODY()
+};
@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/* ++ and -- for an enum whose values run from First to Last with no gaps, wrapping round at either end.
+ * Only needs Core, so BuildingBlocksTests can check it without an engine or a project. */
+template <typename EnumType, EnumType First, EnumType Last>
+struct TEnumCycleBB
+{
+	static EnumType Next(EnumType Value)
+	{
+		return Value == Last ? First : static_cast<EnumType>(static_cast<int32>(Value) + 1);
+	}
+
+	static EnumType Previous(EnumType Value)
+	{
+		return Value == First ? Last : static_cast<EnumType>(static_cast<int32>(Value) - 1);
+	}
+};
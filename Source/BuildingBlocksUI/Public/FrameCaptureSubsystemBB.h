@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "FrameCaptureSubsystemBB.generated.h"
+
+struct FFrameCaptureStateBB;
+
+// The small header at the start of every frame capture file.
+// Followed by MaxFrames FFrameCaptureIndexEntryBB records, then the frames themselves.
+struct FFrameCaptureHeaderBB
+{
+	static constexpr uint32 ExpectedMagic   = 0x43464242; // 'BBFC'
+	static constexpr uint32 ExpectedVersion = 1;
+
+	uint32 Magic         = ExpectedMagic;
+	uint32 Version       = ExpectedVersion;
+	uint32 Width         = 0;
+	uint32 Height        = 0;
+	uint32 BytesPerPixel = 0;
+	uint32 PixelFormat   = 0; // EPixelFormat of the back buffer, usually PF_B8G8R8A8
+	uint32 MaxFrames     = 0;
+	uint32 FrameCount    = 0; // Updated as frames are written, so a partial capture is still readable
+	uint64 FirstFrameOffset = 0;
+	uint64 FrameStride      = 0;
+};
+
+// One entry per frame, so an offline pass can line frames up with the game timeline.
+struct FFrameCaptureIndexEntryBB
+{
+	double Seconds     = 0.0; // FPlatformTime::Seconds() when the frame was presented
+	uint64 FrameNumber = 0;   // GFrameNumberRenderThread of the frame
+};
+
+/* Records many consecutive frames of raw pixels, for perf regression captures.
+ * Rather than encode each frame (which can't keep up), the back buffer is copied
+ * on the GPU as it is presented, read back a couple of frames later on the render thread,
+ * and written straight into a pre-sized memory-mapped file.
+ * The game thread does nothing per frame at all.
+ * Converting the file into images or a video is left to an offline pass. */
+UCLASS()
+class BUILDINGBLOCKSUI_API UFrameCaptureSubsystemBB : public UGameInstanceSubsystem
+{
+public:
+	virtual void Deinitialize() override;
+
+	// Start capturing up to Seconds worth of frames (at the expected frame rate) into FileName.
+	// If FileName is empty, a new file in the screenshot directory is used.
+	UFUNCTION(BlueprintCallable, Category="Frame Capture")
+	bool StartCapture(float Seconds = 10.f, int32 ExpectedFrameRate = 60, FString FileName = TEXT(""));
+
+	// Stop capturing, and close the file. Happens by itself once the file is full.
+	UFUNCTION(BlueprintCallable, Category="Frame Capture")
+	void StopCapture();
+
+	UFUNCTION(BlueprintPure, Category="Frame Capture")
+	bool IsCapturing() const;
+
+	// Frames written to the file so far.
+	UFUNCTION(BlueprintPure, Category="Frame Capture")
+	int32 GetCapturedFrameCount() const;
+
+	// Frames which were presented but not written (readback not ready, size changed).
+	UFUNCTION(BlueprintPure, Category="Frame Capture")
+	int32 GetDroppedFrameCount() const;
+
+private:
+	friend struct FFrameCaptureStateBB;
+
+	// From the render thread once the last frame is in the file.
+	void OnCaptureFull(const FFrameCaptureStateBB* State);
+
+	// Everything the render thread touches lives in here, shared with the present callback.
+	TSharedPtr<FFrameCaptureStateBB, ESPMode::ThreadSafe> CaptureState;
+
+	GENERATED_BODY()
+};
@@ -10,7 +10,7 @@
 class UStatBarBase;
 /* */
 UCLASS(Abstract)
-class BUILDINGBLOCKS_API UHSPBarBase : public UWidgetBBBase
+class BUILDINGBLOCKSUI_API UHSPBarBase : public UWidgetBBBase
 {
 public:
 	UPROPERTY(BlueprintReadOnly, Category = "Constituent Controls", meta = (BindWidget))
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/HUD.h"
+#include "HudBenchmarkBB.h"
+#include "HudViewModeOrderBB.h"
+#include "NameplateRendererBB.h"
+#include "HudBB.generated.h"
+
+class ACharacterBB;
+class UAudioFeedbackCuesBB;
+class UMinimalLayoutBase;
+class UModerateLayoutBase;
+class UOverloadLayoutBase;
+class UUserWidget;
+
+UENUM(BlueprintType)
+enum class EHudViewMode: uint8
+{
+	CleanAndPristine UMETA(Tooltip="Get that mess outta my face!"),
+	CanvasOnly UMETA(Tooltip="The bare stats, drawn straight onto the canvas. No widgets at all."),
+	Minimal UMETA(Tooltip="Just the facts, maam."),
+	Moderate UMETA(Tooltip="Keep me well informed"),
+	SensoryOverload UMETA(Tooltip="My other UI is a derivatives trading screen")
+};
+
+// BuildingBlocksTests checks the cycling on EHudViewModeOrderBB, as EHudViewMode needs UHT. Keep the two the same.
+#define BB_CHECK_VIEW_MODE(Name) \
+	static_assert(static_cast<uint8>(EHudViewMode::Name) == static_cast<uint8>(EHudViewModeOrderBB::Name), \
+	              "EHudViewMode::" #Name " isn't where EHudViewModeOrderBB has it");
+BB_CHECK_VIEW_MODE(CleanAndPristine)
+BB_CHECK_VIEW_MODE(CanvasOnly)
+BB_CHECK_VIEW_MODE(Minimal)
+BB_CHECK_VIEW_MODE(Moderate)
+BB_CHECK_VIEW_MODE(SensoryOverload)
+#undef BB_CHECK_VIEW_MODE
+static_assert(static_cast<uint8>(EHudViewModeOrderBB::Num) == static_cast<uint8>(EHudViewMode::SensoryOverload) + 1,
+              "EHudViewModeOrderBB has a mode EHudViewMode doesn't");
+
+using FHudViewModeCycleBB = THudViewModeCycleBB<EHudViewMode>;
+
+inline EHudViewMode& operator++(EHudViewMode& ViewMode)
+{
+	ViewMode = FHudViewModeCycleBB::Next(ViewMode);
+	return ViewMode;
+}
+
+inline EHudViewMode& operator--(EHudViewMode& ViewMode)
+{
+	ViewMode = FHudViewModeCycleBB::Previous(ViewMode);
+	return ViewMode;
+}
+
+UCLASS(Abstract)
+class BUILDINGBLOCKSUI_API AHudBB : public AHUD
+{
+public:
+	AHudBB();
+
+	UPROPERTY(EditAnywhere)
+	TSubclassOf<UMinimalLayoutBase> MinimalLayoutClass = nullptr;
+	UPROPERTY(EditAnywhere)
+	TSubclassOf<UModerateLayoutBase> ModerateLayoutClass = nullptr;
+	UPROPERTY(EditAnywhere)
+	TSubclassOf<UOverloadLayoutBase> OverloadLayoutClass = nullptr;
+
+	// Allow code and blueprints to put the hud in a specific viewmode directly
+	// Possibly useful for cinematic cutscenes etc?
+	UFUNCTION(BlueprintCallable)
+	void SetCurrentViewMode(EHudViewMode NewViewMode);
+
+	// Change to the next viewmode 
+	UFUNCTION(BlueprintCallable) 
+	void CycleToNextViewMode();
+
+	// Bars above the other characters, drawn by the HUD itself rather than as widgets.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Nameplates")
+	FNameplateSettingsBB NameplateSettings;
+
+	// Sounds for every character's stat changes and key actions, see UAudioFeedbackSubsystemBB.
+	// Nothing plays without any.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Audio")
+	TObjectPtr<UAudioFeedbackCuesBB> AudioFeedbackCues = nullptr;
+
+	virtual void DrawHUD() override;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Time frames in the Minimal layout, then in CanvasOnly, and log how they compare.
+	UFUNCTION(Exec)
+	void CompareCanvasHud(float SecondsPerMode = 5.f);
+
+	// Go through every view mode while the player's stats keep changing, measuring what each one costs
+	// (see FHudBenchmarkBB), and write the results to a CSV file. Saved/HudBenchmark.csv if FileName is empty.
+	UFUNCTION(Exec)
+	void BenchmarkLayouts(float SecondsPerMode = 5.f, FString FileName = TEXT(""));
+
+	EHudViewMode GetCurrentViewMode() const { return CurrentViewMode; }
+
+	// The layout widget showing in the current view mode, if it has one.
+	UUserWidget* GetCurrentLayout() const;
+
+	ACharacterBB* GetPlayerCharacter() const { return PlayerCharacter; }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	// Determines what UI elements should be displayed.
+	UPROPERTY(EditAnywhere)
+	EHudViewMode CurrentViewMode = EHudViewMode::Minimal;
+
+	// The controller has a new character (or none), so move the stat handlers over to it.
+	UFUNCTION()
+	void OnPlayerCharacterChanged(ACharacterBB* NewCharacter);
+
+	// whenever we change the view mode, this private function is called to show the appropriate widgets.
+	void UpdateWidgets();
+
+	// Release the delegate bindings our own widgets made, leaving anything else listening alone.
+	void ClearAllHandlers();
+
+	// The layouts are only created when first shown, and released again in CanvasOnly,
+	// so that mode really has no widgets alive.
+	void CreateLayouts();
+	void ReleaseLayouts();
+
+	// Health, stamina and psi power bars, plus a crosshair, for CanvasOnly.
+	void DrawCanvasStats();
+
+	UPROPERTY()
+	TObjectPtr<UWorld> World = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UMinimalLayoutBase>  MinimalLayoutWidget  = nullptr;
+	
+	UPROPERTY()
+	TObjectPtr<UModerateLayoutBase> ModerateLayoutWidget = nullptr;
+	
+	UPROPERTY()
+	TObjectPtr<UOverloadLayoutBase> OverloadLayoutWidget = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<ACharacterBB> PlayerCharacter = nullptr;
+
+	FNameplateRendererBB NameplateRenderer;
+
+	FHudBenchmarkBB Benchmark;
+
+	GENERATED_BODY()
+};
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AHudBB;
+class UUserWidget;
+enum class EHudViewMode : uint8;
+
+/* Puts a HUD through a list of view modes, a few seconds each, and measures what each one costs.
+ *
+ * Every frame it records the frame, game thread, render thread and GPU times, plus the time Slate spent
+ * ticking, laying out and painting every window. At the end of each mode it counts the widgets in the layout,
+ * times a prepass and a paint of just that layout, counts the draw elements the paint made,
+ * and notes the memory in use. It also times switching into each mode (UpdateWidgets + BroadcastCurrentStats),
+ * both the first time, which may create the layouts, and again once they exist.
+ *
+ * The results are logged, and can be written to a CSV file so UI changes can be checked against a budget. */
+class BUILDINGBLOCKSUI_API FHudBenchmarkBB
+{
+public:
+	struct FOptions
+	{
+		float SecondsPerMode = 5.f;
+
+		// Keep changing the player's health, keys and psi power, so the bars have something to do.
+		// Only works where the stats can be changed, i.e. not on a client.
+		bool bChurnStats = false;
+
+		// Empty to only log the results.
+		FString CsvFileName;
+	};
+
+	~FHudBenchmarkBB();
+
+	// Start measuring the view modes, in order. Returns false if already running.
+	bool Start(AHudBB& Hud, const TArray<EHudViewMode>& ViewModes, const FOptions& InOptions);
+
+	// Call every frame while running.
+	// Returns false once finished, by which time the HUD is back in the mode it started in.
+	bool Tick(AHudBB& Hud);
+
+	// Give up without reporting anything.
+	void Stop();
+
+	bool IsRunning() const { return ModeIndex != INDEX_NONE; }
+
+private:
+	struct FModeSamples
+	{
+		EHudViewMode ViewMode;
+
+		// One per frame
+		TArray<float> FrameMs;
+		TArray<float> GameThreadMs;
+		TArray<float> RenderThreadMs;
+		TArray<float> GpuMs;
+		TArray<float> SlateMs;
+
+		// Smallest first, which FSampleStatsBB::GetPercentile needs.
+		void Sort();
+
+		// Measured once, at the end of the mode
+		float  SwitchMs        = 0.f;
+		float  WarmSwitchMs    = 0.f;
+		float  PrepassUs       = 0.f;
+		float  PaintUs         = 0.f;
+		int32  NumDrawElements = 0;
+		int32  NumWidgets      = 0;
+		int32  NumSlateWidgets = 0;
+		SIZE_T WidgetBytes     = 0;
+		uint64 UsedPhysicalMB  = 0;
+	};
+
+	void SwitchToCurrentMode(AHudBB& Hud);
+
+	// Everything that's only measured once per mode.
+	void MeasureLayout(AHudBB& Hud, FModeSamples& Samples);
+
+	void ChurnStats(AHudBB& Hud);
+
+	// Put the stats back the way they were, as near as we can.
+	void UndoChurn(AHudBB& Hud);
+
+	void Report();
+	bool WriteCsv(const FString& FileName);
+
+	void OnSlatePreTick(float DeltaTime);
+	void OnSlatePostTick(float DeltaTime);
+
+	FOptions             Options;
+	TArray<FModeSamples> Modes;
+	int32                ModeIndex      = INDEX_NONE;
+	float                ModeElapsed    = 0.f;
+	EHudViewMode         ViewModeBefore = {};
+
+	// Slate ticks after the world, so this is last frame's, which is what the thread times are as well.
+	double SlateTickStart = 0.0;
+	float  LastSlateMs    = -1.f;
+
+	FDelegateHandle PreTickHandle;
+	FDelegateHandle PostTickHandle;
+
+	int32 ChurnFrame     = 0;
+	bool  bHealthLowered = false;
+	bool  bAddedChurnKey = false;
+};
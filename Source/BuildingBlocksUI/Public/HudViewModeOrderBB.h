@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnumCycleBB.h"
+
+/* EHudViewMode's values, in order. EHudViewMode is a UENUM, which needs UHT, so BuildingBlocksTests
+ * cycles this instead. HudBB.h static_asserts that the two match, so a mode can't be added, removed or moved in one and not the other. */
+enum class EHudViewModeOrderBB : uint8
+{
+	CleanAndPristine,
+	CanvasOnly,
+	Minimal,
+	Moderate,
+	SensoryOverload,
+
+	Num
+};
+
+template <typename EnumType>
+using THudViewModeCycleBB = TEnumCycleBB<EnumType, static_cast<EnumType>(EHudViewModeOrderBB::CleanAndPristine),
+                                         static_cast<EnumType>(static_cast<uint8>(EHudViewModeOrderBB::Num) - 1)>;
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WidgetBBBase.h"
+#include "Blueprint/IUserObjectListEntry.h"
+#include "KeyWalletEntryBase.generated.h"
+
+class UTextBlock;
+
+/* The data item behind a single row in a key list.
+ * The list view only holds these (which are tiny), and creates
+ * widgets for the rows that are actually on screen. */
+UCLASS()
+class BUILDINGBLOCKSUI_API UKeyWalletItem : public UObject
+{
+public:
+	// The key this row represents
+	UPROPERTY(BlueprintReadOnly, Category = "Key Wallet")
+	FString Key;
+
+	GENERATED_BODY()
+};
+
+/* Class representing a single row in a key list view.
+ * Entry widgets are pooled and recycled by the list view as it scrolls,
+ * so everything displayed must come from the item object, never from
+ * state stored on the widget itself. */
+UCLASS(Abstract)
+class BUILDINGBLOCKSUI_API UKeyWalletEntryBase : public UWidgetBBBase, public IUserObjectListEntry
+{
+public:
+
+protected:
+	// Called by the list view whenever this (possibly recycled) widget is given a new item.
+	virtual void NativeOnListItemObjectSet(UObject* ListItemObject) override;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Constituent Controls", meta = (BindWidget))
+	TObjectPtr<UTextBlock> KeyText = nullptr;
+
+private:
+
+	GENERATED_BODY()
+};
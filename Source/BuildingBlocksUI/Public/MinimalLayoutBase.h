@@ -11,7 +11,7 @@ class UImage;
 
 /* */
 UCLASS(Abstract)
-class BUILDINGBLOCKS_API UMinimalLayoutBase : public UWidgetBBBase
+class BUILDINGBLOCKSUI_API UMinimalLayoutBase : public UWidgetBBBase
 {
 public:
 	
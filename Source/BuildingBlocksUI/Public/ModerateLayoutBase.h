@@ -11,7 +11,7 @@ class UImage;
 
 /* */
 UCLASS(Abstract)
-class BUILDINGBLOCKS_API UModerateLayoutBase : public UWidgetBBBase
+class BUILDINGBLOCKSUI_API UModerateLayoutBase : public UWidgetBBBase
 {
 public:
 	
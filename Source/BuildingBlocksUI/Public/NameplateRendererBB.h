@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NameplateRendererBB.generated.h"
+
+class ACharacterBB;
+class AHUD;
+class UCanvas;
+
+// How nameplates above other characters are drawn.
+USTRUCT(BlueprintType)
+struct FNameplateSettingsBB
+{
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Nameplates")
+	bool bEnabled = true;
+
+	// Characters further away than this don't get a plate.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Nameplates", meta=(ClampMin=0, Units="Centimeters"))
+	float MaxDistance = 3000.f;
+
+	// The most plates drawn in a frame, the closest ones win.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Nameplates", meta=(ClampMin=0))
+	int32 MaxPlatesPerFrame = 48;
+
+	// How often the list of characters which might need a plate is rebuilt.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Nameplates", meta=(ClampMin=0, Units="Seconds"))
+	float GatherInterval = 0.25f;
+
+	// Where the plate goes, relative to the character's location.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Nameplates", meta=(Units="Centimeters"))
+	float HeightAboveCharacter = 120.f;
+
+	// Size of each of the 3 bars, in pixels.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Nameplates")
+	FVector2D BarSize = FVector2D(60.f, 4.f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Nameplates")
+	float BarSpacing = 1.f;
+
+	GENERATED_BODY()
+};
+
+/* Draws health, stamina and psi bars above every other character in view, straight onto the HUD canvas.
+ *
+ * A widget component per character would mean a widget, and its own render and layout work, per character.
+ * Instead, every plate is a few rectangles drawn with the same white texture, which the canvas batches
+ * into a single draw. The characters in range are only looked for every GatherInterval,
+ * in between only those are projected, and at most MaxPlatesPerFrame get drawn,
+ * so the cost follows the number of plates on screen rather than the number of characters spawned. */
+class BUILDINGBLOCKSUI_API FNameplateRendererBB
+{
+public:
+	// Call from AHUD::DrawHUD.
+	void Draw(AHUD& Hud, UCanvas& Canvas, const FNameplateSettingsBB& Settings);
+
+	int32 GetNumDrawnLastFrame() const { return NumDrawnLastFrame; }
+
+private:
+	struct FPlate
+	{
+		FVector2D           ScreenPosition;
+		float               DistanceSquared;
+		const ACharacterBB* Character;
+	};
+
+	// Rebuild Candidates from every character in UCharacterRegistrySubsystemBB.
+	void Gather(const AHUD& Hud, const FVector& ViewLocation, const FNameplateSettingsBB& Settings);
+
+	TArray<TWeakObjectPtr<ACharacterBB>> Candidates;
+	TArray<FPlate>                       Plates;
+	double                               LastGatherSeconds = -1.0;
+	int32                                NumDrawnLastFrame = 0;
+};
@@ -0,0 +1,59 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WidgetBBBase.h"
+#include "CharacterBB.h"
+#include "OverloadLayoutBase.generated.h"
+
+class UHSPBarBase;
+class UImage;
+class UListView;
+class UKeyWalletItem;
+
+/* */
+UCLASS(Abstract)
+class BUILDINGBLOCKSUI_API UOverloadLayoutBase : public UWidgetBBBase
+{
+public:
+	
+	UPROPERTY(BlueprintReadOnly, Category = "Constituent Controls", meta = (BindWidget))
+	TObjectPtr<UHSPBarBase> HSPBar = nullptr;
+		
+	UPROPERTY(BlueprintReadOnly, Category = "Constituent Controls", meta = (BindWidget))
+	TObjectPtr<UImage> Crosshair = nullptr;
+
+	// Virtualized list of the keys the player is carrying.
+	// Only the rows which are visible have widgets, and those are pooled by the list view.
+	// Optional, so layouts without a key panel still work.
+	UPROPERTY(BlueprintReadOnly, Category = "Constituent Controls", meta = (BindWidgetOptional))
+	TObjectPtr<UListView> KeyList = nullptr;
+
+	// Rebuild the key list from scratch.
+	// Used when the layout is switched to, after that it is kept up to date by OnKeyWalletAction.
+	void SyncKeyWallet(const TArray<FString>& Keys);
+
+	// Function that can be bound to ACharacterBB::OnKeyWalletAction,
+	// adds or removes a single row when a key is added or removed.
+	// Adding is O(1), removing is O(keys carried) to keep the rows in the order the keys were picked up.
+	UFUNCTION()
+	void OnKeyWalletAction(FString KeyString, EPlayerKeyAction KeyAction, bool IsSuccess);
+	
+protected:
+
+
+private:
+	// Add a single key to the list, reusing a spare item if there is one.
+	void AddKeyItem(const FString& Key);
+
+	// Lookup from key to the item representing it in the list, so we never have to search the list.
+	UPROPERTY()
+	TMap<FString, TObjectPtr<UKeyWalletItem>> KeyItems;
+
+	// Items which have been removed from the list, kept around so adding a key doesn't allocate.
+	UPROPERTY()
+	TArray<TObjectPtr<UKeyWalletItem>> SpareKeyItems;
+	
+	GENERATED_BODY()
+};
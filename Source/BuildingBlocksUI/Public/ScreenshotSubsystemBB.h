@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tasks/Task.h"
+#include "ScreenshotSubsystemBB.generated.h"
+
+// The file formats screenshots can be saved in.
+UENUM(BlueprintType)
+enum class EScreenshotFormatBB : uint8
+{
+	PNG UMETA(Tooltip = "Lossless, slowest to encode."),
+	JPEG UMETA(Tooltip = "Lossy, uses ScreenshotQuality."),
+	EXR UMETA(Tooltip = "Linear colour, for when we need the numbers rather than the picture."),
+	Raw UMETA(Tooltip = "Straight BGRA8 pixels with no header. Fastest, needs converting later.")
+};
+
+/* Saves screenshots taken by the game viewport to disk, off the game thread.
+ * There is a fixed number of pixel buffers, allocated once and reused for every shot,
+ * so taking a screenshot costs one copy and no allocation on the game thread.
+ * If every buffer is busy (the disk can't keep up) the shot is dropped and logged,
+ * rather than piling up work and memory. */
+UCLASS(Config=Game)
+class BUILDINGBLOCKSUI_API UScreenshotSubsystemBB : public UGameInstanceSubsystem
+{
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// How many screenshots are currently waiting to be (or being) written.
+	UFUNCTION(BlueprintPure, Category="Screenshots")
+	int32 GetQueueDepth() const;
+
+	// How long the most recent screenshot took, from being captured to being on disk, in milliseconds.
+	UFUNCTION(BlueprintPure, Category="Screenshots")
+	float GetLastLatencyMs() const;
+
+	// How many screenshots have been dropped because the queue was full.
+	UFUNCTION(BlueprintPure, Category="Screenshots")
+	int32 GetDroppedCount() const;
+
+	// The format new screenshots will be saved in.
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, Category="Screenshots")
+	EScreenshotFormatBB ScreenshotFormat = EScreenshotFormatBB::PNG;
+
+	// Where screenshots are written. If empty, the engine's screenshot directory is used.
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, Category="Screenshots")
+	FString OutputDirectory;
+
+	// Compression quality, only used by formats which support it (JPEG).
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, Category="Screenshots", meta=(ClampMin=1, ClampMax=100))
+	int32 ScreenshotQuality = 90;
+
+	// How many screenshots can be in flight at once. Each one holds a full-screen pixel buffer.
+	UPROPERTY(Config, EditAnywhere, Category="Screenshots", meta=(ClampMin=1, ClampMax=16))
+	int32 MaxQueuedScreenshots = 4;
+
+private:
+	// One reusable buffer, and the details of the shot it currently holds.
+	struct FScreenshotSlot
+	{
+		TArray<FColor>      Pixels;
+		TArray64<uint8>     Encoded;
+		int32               Width       = 0;
+		int32               Height      = 0;
+		int32               Quality     = 0;
+		EScreenshotFormatBB Format      = EScreenshotFormatBB::PNG;
+		double              CaptureTime = 0.0;
+		FString             FileName;
+		UE::Tasks::FTask    Task;
+	};
+
+	// Bound (once) to the viewport's OnScreenshotCaptured.
+	void AcceptScreenshot(int32 Width, int32 Height, const TArray<FColor>& Colors);
+
+	// Runs on a worker thread, encodes and writes a single slot, then hands it back.
+	void WriteSlot(int32 SlotIndex);
+
+	// The file extension for a format.
+	static const TCHAR* GetFormatExtension(EScreenshotFormatBB Format);
+
+	FDelegateHandle ScreenshotCapturedHandle;
+
+	// Fixed once Initialize has run, never resized, so workers can safely hold an index into it.
+	TArray<FScreenshotSlot> Slots;
+
+	// Indices of slots not currently in use. Guarded by SlotLock.
+	TArray<int32> FreeSlots;
+
+	mutable FCriticalSection SlotLock;
+
+	// Next number used in a screenshot file name.
+	int32 NextScreenshotIndex = 0;
+
+	// Stats, guarded by SlotLock.
+	float LastLatencyMs = 0.f;
+	int32 DroppedCount  = 0;
+
+	GENERATED_BODY()
+};
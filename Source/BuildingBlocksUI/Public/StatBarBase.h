@@ -11,13 +11,14 @@ class UVerticalBox;
 class UBorder;
 class UImage;
 class UTextBlock;
+class UStatBarStyleBB;
 
 /* Class representing a single Stat Percentage bar,
  * like most C++ Widget base classes, it is marked as 'Abstract'
  * because we never want to actually make instances of it -
  * only use it to create (usually) blueprints. */
 UCLASS(Abstract)
-class BUILDINGBLOCKS_API UStatBarBase : public UWidgetBBBase
+class BUILDINGBLOCKSUI_API UStatBarBase : public UWidgetBBBase
 {
 public:
 	// Function that can be called to update the bar using int values
@@ -28,6 +29,12 @@ public:
 	UFUNCTION()
 	void OnFloatStatUpdated(float OldValue, float NewValue, float MaxValue);
 
+	// Switch the bar to a different look.
+	UFUNCTION(BlueprintCallable, Category="Stat Bar")
+	void SetStyle(UStatBarStyleBB* NewStyle);
+
+	UStatBarStyleBB* GetStyle() const { return Style; }
+
 #if WITH_EDITOR
 	virtual void OnDesignerChanged(const FDesignerChangedEventArgs& EventArgs) override;
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
@@ -36,6 +43,10 @@ public:
 protected:
 	virtual void NativeOnInitialized() override;
 
+#if WITH_EDITORONLY_DATA
+	virtual void PostLoad() override;
+#endif
+
 	UPROPERTY(BlueprintReadOnly, Category = "Constituent Controls", meta = (BindWidget))
 	TObjectPtr<UBorder> MainBorder = nullptr;
 
@@ -55,18 +66,30 @@ protected:
 	TObjectPtr<UTextBlock> ValueText = nullptr;
 
 private:
+	// The icon, colours and size of the bar, shared with every other bar using the same style.
+	// If not set, the bar uses the UStatBarStyleBB defaults.
 	UPROPERTY(EditAnywhere, Category="Stat Bar")
-	FSlateBrush IconBrush;
+	TObjectPtr<UStatBarStyleBB> Style = nullptr;
 
-	UPROPERTY(EditAnywhere, Category="Stat Bar")
-	FLinearColor BarBackgroundColor = FLinearColor(0.3f, 0.f, 0.f, 0.3f);
+#if WITH_EDITORONLY_DATA
+	// These used to be set on every bar. They are only kept so older layouts still load: PostLoad moves
+	// a bar's old look into a style shared by every bar in the widget with that look, which is what gets cooked.
+	// They don't exist in a cooked game.
+	UPROPERTY(meta=(DeprecatedProperty, DeprecationMessage="Use a Stat Bar Style instead."))
+	FSlateBrush IconBrush_DEPRECATED;
 
-	UPROPERTY(EditAnywhere, Category="Stat Bar")
-	FLinearColor BarForegroundColor = FLinearColor(1.f, 0.f, 0.f, 0.75f);
+	UPROPERTY(meta=(DeprecatedProperty, DeprecationMessage="Use a Stat Bar Style instead."))
+	FLinearColor BarBackgroundColor_DEPRECATED = FLinearColor(0.3f, 0.f, 0.f, 0.3f);
 
-	// Display the Bar as full size, or minimized
-	UPROPERTY(EditAnywhere, Category="Stat Bar")
-	bool IsFullSize = true;
+	UPROPERTY(meta=(DeprecatedProperty, DeprecationMessage="Use a Stat Bar Style instead."))
+	FLinearColor BarForegroundColor_DEPRECATED = FLinearColor(1.f, 0.f, 0.f, 0.75f);
+
+	UPROPERTY(meta=(DeprecatedProperty, DeprecationMessage="Use a Stat Bar Style instead."))
+	bool IsFullSize_DEPRECATED = true;
+#endif
+
+	// The style only needs pushing into the child widgets when it changes, not on every stat update.
+	bool bStyleApplied = false;
 
 	// Internal variable to store the current 'filled' amount
 	// 'Clamped' to stop the value going outside of what we consider a % to be
@@ -90,5 +113,8 @@ private:
 	// Called after any changes are made to redraw the bar
 	void UpdateWidget();
 
+	// Push the style into the child widgets.
+	void ApplyStyle();
+
 	GENERATED_BODY()
 };
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Styling/SlateBrush.h"
+#include "StatBarStyleBB.generated.h"
+
+// How much of a stat bar to show.
+UENUM(BlueprintType)
+enum class EStatBarSizeModeBB : uint8
+{
+	FullSize UMETA(Tooltip = "Icon, bar and value."),
+	Minimized UMETA(Tooltip = "Just the icon and value.")
+};
+
+/* The look of a stat bar, shared by every bar which uses it.
+ *
+ * Rather than every UStatBarBase carrying its own brush and colours
+ * (which is most of the size of a bar), bars just point at one of these.
+ * So a few hundred nameplate or party frame bars cost a few hundred pointers, plus one style. */
+UCLASS(BlueprintType)
+class BUILDINGBLOCKSUI_API UStatBarStyleBB : public UDataAsset
+{
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Stat Bar")
+	FSlateBrush IconBrush;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Stat Bar")
+	FLinearColor BackgroundColor = FLinearColor(0.3f, 0.f, 0.f, 0.3f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Stat Bar")
+	FLinearColor ForegroundColor = FLinearColor(1.f, 0.f, 0.f, 0.75f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Stat Bar")
+	EStatBarSizeModeBB SizeMode = EStatBarSizeModeBB::FullSize;
+
+	// Used by bars which haven't been given a style.
+	static const UStatBarStyleBB* GetDefaultStyle();
+
+	GENERATED_BODY()
+};
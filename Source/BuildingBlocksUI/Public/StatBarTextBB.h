@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/* The text a stat bar shows for a value, e.g. 5.50, 99.9, 986, 1.5k.
+ * Only needs Core, so BuildingBlocksTests can check it without an engine or a project. */
+struct FStatBarTextBB
+{
+	static FString FormatValue(float Value)
+	{
+		// Ultimately this should be handled in a culture appropriate matter,
+		// i.e suffixes like 'k' for thousands should be dependant on culture,
+		// and may be prefixes in some cultures.
+		// HOWEVER - for the purposes of this tutorial, we will keep it simple
+
+		// if the number is <10 then display it as a float to 2DP : 0.01
+		// if the number is <100, then display it as a float with 1DP : 99.9
+		// if the number is <1000 then display it as an integer with 0DP: 986
+		// if the number is >= 1000, then divide it by 1000 and apply the rules above, and add a 'k' on the end
+
+		// SanitizeFloat prints with 6 decimal places before trimming, and never shrinks, so there is always room
+		// to cut down and pad in place. That keeps it to the one allocation, and it runs on every stat change.
+		const bool  bThousands  = Value >= 1000.f;
+		const float ScaledValue = bThousands ? Value / 1000.f : Value;
+		FString     FloatString = FString::SanitizeFloat(ScaledValue);
+
+		if (bThousands)
+		{
+			FloatString.LeftInline(ScaledValue < 10.f ? 3 : 2, false);
+			FloatString.AppendChar(TEXT('k'));
+		}
+		else if (Value < 100.f)
+		{
+			const int32 StringLen = FloatString.Len();
+			if (StringLen > 4)
+				FloatString.LeftInline(4, false);
+			else if (StringLen < 4)
+				FloatString.AppendChars(TEXT("000"), 4 - StringLen);
+		}
+		else
+		{
+			FloatString.LeftInline(3, false);
+		}
+
+		return FloatString;
+	}
+};
@@ -8,7 +8,7 @@
 
 /* */
 UCLASS(Abstract)
-class BUILDINGBLOCKS_API UWidgetBBBase : public UUserWidget
+class BUILDINGBLOCKSUI_API UWidgetBBBase : public UUserWidget
 {
 public:
 #if WITH_EDITOR